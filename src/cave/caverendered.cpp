@@ -24,6 +24,7 @@
 #include "config.h"
 
 #include <cstdlib>
+#include <vector>
 
 #include "cave/caverendered.hpp"
 #include "cave/elementproperties.hpp"
@@ -294,6 +295,103 @@ void CaveRendered::draw_indexes(CaveMap<int> &gfx_buffer, CaveMap<bool> const &c
     }
 }
 
+/// Collect the indexes of the cells which are likely to be drawn while playing this cave.
+/// These are the cells of the elements found in the map, of the elements they can
+/// turn into by the effects set for the cave, and of the elements every cave uses
+/// (covered cells, the player, explosions and so on). Animated elements add all their
+/// frames, and also the flashing variants are added for the outbox opening.
+/// The indexes are the same as the ones written to the gfx buffer by draw_indexes().
+std::vector<unsigned> CaveRendered::collect_drawn_cells() const {
+    std::vector<bool> used_elements(O_MAX_INDEX, false);
+
+    for (int y = y1; y <= y2; y++)
+        for (int x = x1; x <= x2; x++)
+            used_elements[map(x, y)] = true;
+
+    /* elements which are drawn in every cave */
+    static GdElementEnum const always[] = {
+        O_SPACE, O_COVERED, O_FAKE_BONUS, O_INBOX, O_OUTBOX_CLOSED, O_OUTBOX_OPEN,
+        O_PRE_PL_1, O_PRE_PL_2, O_PRE_PL_3, O_PLAYER, O_PLAYER_LEFT, O_PLAYER_RIGHT,
+        O_PLAYER_UP, O_PLAYER_DOWN, O_PLAYER_TAP, O_PLAYER_BLINK, O_PLAYER_TAP_BLINK,
+        O_PLAYER_PUSH_LEFT, O_PLAYER_PUSH_RIGHT,
+    };
+    for (unsigned i = 0; i < G_N_ELEMENTS(always); ++i)
+        used_elements[always[i]] = true;
+    /* explosions, births and all the other short animations of the engine */
+    for (int e = O_PRE_CLOCK_0; e <= O_NUT_CRACK_4; ++e)
+        used_elements[e] = true;
+
+    /* elements created by the effects of this cave */
+    GdElementEnum const effects[] = {
+        amoeba_enclosed_effect, amoeba_too_big_effect, amoeba_2_enclosed_effect, amoeba_2_too_big_effect,
+        amoeba_2_explosion_effect, acid_turns_to, nut_turns_to_when_crushed,
+        slime_converts_1, slime_converts_2, slime_converts_3,
+        explosion_effect, explosion_3_effect, diamond_birth_effect, bomb_explosion_effect, nitro_explosion_effect,
+        firefly_explode_to, alt_firefly_explode_to, butterfly_explode_to, alt_butterfly_explode_to,
+        stonefly_explode_to, dragonfly_explode_to,
+        stone_falling_effect, diamond_falling_effect, stone_bouncing_effect, diamond_bouncing_effect,
+        magic_stone_to, magic_diamond_to, magic_mega_stone_to, magic_nitro_pack_to, magic_nut_to, magic_flying_stone_to,
+    };
+    for (unsigned i = 0; i < G_N_ELEMENTS(effects); ++i)
+        used_elements[effects[i]] = true;
+
+    /* elements which are drawn using the image of another one; see draw_indexes(). */
+    static GdElementEnum const looks_like[][2] = {
+        { O_MAGIC_WALL, O_BRICK },
+        { O_CREATURE_SWITCH, O_CREATURE_SWITCH_ON },
+        { O_EXPANDING_WALL_SWITCH, O_EXPANDING_WALL_SWITCH_HORIZ },
+        { O_EXPANDING_WALL_SWITCH, O_EXPANDING_WALL_SWITCH_VERT },
+        { O_GRAVITY_SWITCH, O_GRAVITY_SWITCH_ACTIVE },
+        { O_REPLICATOR_SWITCH, O_REPLICATOR_SWITCH_ON },
+        { O_REPLICATOR_SWITCH, O_REPLICATOR_SWITCH_OFF },
+        { O_CONVEYOR_SWITCH, O_CONVEYOR_SWITCH_ON },
+        { O_CONVEYOR_SWITCH, O_CONVEYOR_SWITCH_OFF },
+        { O_CONVEYOR_DIR_SWITCH, O_CONVEYOR_DIR_NORMAL },
+        { O_CONVEYOR_DIR_SWITCH, O_CONVEYOR_DIR_CHANGED },
+    };
+    for (unsigned i = 0; i < G_N_ELEMENTS(looks_like); ++i)
+        if (used_elements[looks_like[i][0]])
+            used_elements[looks_like[i][1]] = true;
+    if (used_elements[O_DIRT])
+        used_elements[dirt_looks_like] = true;
+    if (used_elements[O_EXPANDING_WALL] || used_elements[O_H_EXPANDING_WALL] || used_elements[O_V_EXPANDING_WALL])
+        used_elements[expanding_wall_looks_like] = true;
+    if (used_elements[O_AMOEBA_2])
+        used_elements[amoeba_2_looks_like] = true;
+
+    /* and now convert elements to cell indexes */
+    std::vector<bool> used_cells(NUM_OF_CELLS, false);
+    for (int e = 0; e < O_MAX_INDEX; ++e) {
+        if (!used_elements[e])
+            continue;
+        int draw = gd_element_properties[e].image_game;
+        if (draw < 0) {
+            /* animated, all the frames */
+            for (int i = 0; i < 8; ++i)
+                used_cells[-draw + i] = true;
+        } else
+            used_cells[draw] = true;
+    }
+    /* the hacks of draw_indexes() */
+    if (used_elements[O_BITER_SWITCH])
+        for (int i = 0; i < 4; ++i)
+            used_cells[gd_element_properties[O_BITER_SWITCH].image_game + i] = true;
+    GdElementEnum const pneumatic[] = { O_PNEUMATIC_ACTIVE_LEFT, O_PNEUMATIC_ACTIVE_RIGHT, O_PLAYER_PNEUMATIC_LEFT, O_PLAYER_PNEUMATIC_RIGHT };
+    for (unsigned i = 0; i < G_N_ELEMENTS(pneumatic); ++i)
+        if (used_elements[pneumatic[i]])
+            used_cells[abs(gd_element_properties[pneumatic[i]].image_game) + 2] = true;
+
+    std::vector<unsigned> cells;
+    for (unsigned i = 0; i < NUM_OF_CELLS; ++i)
+        if (used_cells[i])
+            cells.push_back(i);
+    /* flashing versions after the normal ones, as those are needed less urgently */
+    for (unsigned i = 0; i < NUM_OF_CELLS; ++i)
+        if (used_cells[i])
+            cells.push_back(i + NUM_OF_CELLS);
+    return cells;
+}
+
 /// Convert cave time stored in milliseconds to a visible time in seconds.
 /// Internal time may be in real milliseconds or "1200 milliseconds/second"
 /// for pal timing. This is taken into account by this function.
@@ -28,6 +28,7 @@
 
 #include <glib.h>
 #include <list>
+#include <vector>
 
 #include "cave/cavebase.hpp"
 #include "cave/helper/caverandom.hpp"
@@ -127,6 +128,7 @@ public:
 
     /* game playing helpers */
     void draw_indexes(CaveMap<int> &gfx_buffer, CaveMap<bool> const &covered, bool bonus_life_flash, int animcycle, bool hate_invisible_outbox);
+    std::vector<unsigned> collect_drawn_cells() const;
     int time_visible(int internal_time) const;
     void set_seconds_sound();
     void sound_play(GdSound sound, int x, int y);
@@ -213,7 +215,7 @@ public:
     GdBool voodoo_touched;
 
     SoundWithPos sound1, sound2, sound3;        ///< sound set for 3 channels after each iteration
-    std::list<ParticleSet> particles;
+    ParticlePool particles;
     GdColor dirt_particle_color, dirt_2_particle_color, diamond_particle_color,
             stone_particle_color, mega_stone_particle_color,
             explosion_particle_color, magic_wall_particle_color, expanding_wall_particle_color,
@@ -55,67 +55,67 @@ void CaveRendered::add_particle_set(int x, int y, GdElementEnum particletype) {
     double gx = gd_dx[gravity], gy = gd_dy[gravity], agx = fabs(gx), agy = fabs(gy);
     switch (particletype) {
         case O_DIRT:
-            particles.push_back(ParticleSet(75, 0.1, 0.15, x + 0.5, y + 0.5, 0.5, 0.5, 0, 0, 1, 1, dirt_particle_color));
+            particles.add(75, 0.1, 0.15, x + 0.5, y + 0.5, 0.5, 0.5, 0, 0, 1, 1, dirt_particle_color);
             break;
         case O_DIRT2:
-            particles.push_back(ParticleSet(75, 0.1, 0.15, x + 0.5, y + 0.5, 0.5, 0.5, 0, 0, 1, 1, dirt_2_particle_color));
+            particles.add(75, 0.1, 0.15, x + 0.5, y + 0.5, 0.5, 0.5, 0, 0, 1, 1, dirt_2_particle_color);
             break;
         case O_STONE_F:
-            particles.push_back(ParticleSet(75, 0.1, 0.15,
-                                            x + 0.5 + 0.5 * gx, y + 0.5 + 0.5 * gy, 0.25 + 0.25 * agy, 0.25 + 0.25 * agx,
-                                            0.5 * gx, 0.5 * gy, 1 + agy, 1 + agx, stone_particle_color));
+            particles.add(75, 0.1, 0.15,
+                          x + 0.5 + 0.5 * gx, y + 0.5 + 0.5 * gy, 0.25 + 0.25 * agy, 0.25 + 0.25 * agx,
+                          0.5 * gx, 0.5 * gy, 1 + agy, 1 + agx, stone_particle_color);
             break;
         case O_MEGA_STONE_F:
-            particles.push_back(ParticleSet(75, 0.1, 0.15,
-                                            x + 0.5 + 0.5 * gx, y + 0.5 + 0.5 * gy, 0.25 + 0.25 * agy, 0.25 + 0.25 * agx,
-                                            0.5 * gx, 0.5 * gy, 1 + agy, 1 + agx, mega_stone_particle_color));
+            particles.add(75, 0.1, 0.15,
+                          x + 0.5 + 0.5 * gx, y + 0.5 + 0.5 * gy, 0.25 + 0.25 * agy, 0.25 + 0.25 * agx,
+                          0.5 * gx, 0.5 * gy, 1 + agy, 1 + agx, mega_stone_particle_color);
             break;
         case O_DIAMOND_F:
             /* falling diamond */
-            particles.push_back(ParticleSet(15, 0.03, 0.5,
-                                            x + 0.5 + 0.5 * gx, y + 0.5 + 0.5 * gy, 0.25, 0.25,
-                                            0, 0, 2, 2, diamond_particle_color));
+            particles.add(15, 0.03, 0.5,
+                          x + 0.5 + 0.5 * gx, y + 0.5 + 0.5 * gy, 0.25, 0.25,
+                          0, 0, 2, 2, diamond_particle_color);
             break;
         case O_DIAMOND:
             /* collecting diamond */
-            particles.push_back(ParticleSet(8, 0.03, 0.5,
-                                            x + 0.5, y + 0.5, 0.25, 0.25,
-                                            0, 0, 2, 2, diamond_particle_color));
+            particles.add(8, 0.03, 0.5,
+                          x + 0.5, y + 0.5, 0.25, 0.25,
+                          0, 0, 2, 2, diamond_particle_color);
             break;
         case O_EXPLODE_1:
             /* for explosions, the original place of the particles is a 2x2 cave cell area, but they
              * expand rapidly. */
-            particles.push_back(ParticleSet(300, 0.05, 0.5, x + 0.5, y + 0.5, 1.0, 1.0, 0, 0, 4, 4, explosion_particle_color));
+            particles.add(300, 0.05, 0.5, x + 0.5, y + 0.5, 1.0, 1.0, 0, 0, 4, 4, explosion_particle_color);
             break;
         case O_PRE_DIA_1:
-            particles.push_back(ParticleSet(300, 0.05, 0.5, x + 0.5, y + 0.5, 1.0, 1.0, 0, 0, 4, 4, diamond_particle_color));
+            particles.add(300, 0.05, 0.5, x + 0.5, y + 0.5, 1.0, 1.0, 0, 0, 4, 4, diamond_particle_color);
             break;
         case O_MAGIC_WALL:
             // a magic wall creates particles in every frame. so add only very few particles!
             // rather they should be bright like stars
-            particles.push_back(ParticleSet(3, 0.01, 0.75, x + 0.5, y + 0.5, 0.5, 0.5, 0, 0, 1 + 2 * agx, 1 + 2 * agy, magic_wall_particle_color));
+            particles.add(3, 0.01, 0.75, x + 0.5, y + 0.5, 0.5, 0.5, 0, 0, 1 + 2 * agx, 1 + 2 * agy, magic_wall_particle_color);
             break;
         case O_EXPANDING_WALL:
-            particles.push_back(ParticleSet(75, 0.1, 0.15, x + 0.5, y + 0.5, 0.5, 0.5, 0, 0, 1, 1, expanding_wall_particle_color));
+            particles.add(75, 0.1, 0.15, x + 0.5, y + 0.5, 0.5, 0.5, 0, 0, 1, 1, expanding_wall_particle_color);
             break;
         case O_EXPANDING_STEEL_WALL:
-            particles.push_back(ParticleSet(75, 0.1, 0.15, x + 0.5, y + 0.5, 0.5, 0.5, 0, 0, 1, 1, expanding_steel_wall_particle_color));
+            particles.add(75, 0.1, 0.15, x + 0.5, y + 0.5, 0.5, 0.5, 0, 0, 1, 1, expanding_steel_wall_particle_color);
             break;
         case O_LAVA:
             // this should look like it's boiling
-            particles.push_back(ParticleSet(10, 0.01, 0.5, x + 0.5, y + 0.5, 0.5, 0.5, 0, 0, 2, 2, lava_particle_color));
+            particles.add(10, 0.01, 0.5, x + 0.5, y + 0.5, 0.5, 0.5, 0, 0, 2, 2, lava_particle_color);
             break;
         case O_ROCKET_1:
-            particles.push_back(ParticleSet(100, 0.03, 0.25, x + 0.9, y + 0.5, 0.5, 0.2, -4, 0.2, 3, 0.2, explosion_particle_color));
+            particles.add(100, 0.03, 0.25, x + 0.9, y + 0.5, 0.5, 0.2, -4, 0.2, 3, 0.2, explosion_particle_color);
             break;
         case O_ROCKET_2:
-            particles.push_back(ParticleSet(100, 0.03, 0.25, x + 0.5, y + 0.1, 0.2, 0.5, 0.2, 4, 0.2, 3, explosion_particle_color));
+            particles.add(100, 0.03, 0.25, x + 0.5, y + 0.1, 0.2, 0.5, 0.2, 4, 0.2, 3, explosion_particle_color);
             break;
         case O_ROCKET_3:
-            particles.push_back(ParticleSet(100, 0.03, 0.25, x + 0.1, y + 0.5, 0.5, 0.2, 4, 0.2, 3, 0.2, explosion_particle_color));
+            particles.add(100, 0.03, 0.25, x + 0.1, y + 0.5, 0.5, 0.2, 4, 0.2, 3, 0.2, explosion_particle_color);
             break;
         case O_ROCKET_4:
-            particles.push_back(ParticleSet(100, 0.03, 0.25, x + 0.5, y + 0.9, 0.2, 0.5, 0.2, -4, 0.2, 3, explosion_particle_color));
+            particles.add(100, 0.03, 0.25, x + 0.5, y + 0.9, 0.2, 0.5, 0.2, -4, 0.2, 3, explosion_particle_color);
             break;
         default:
             break;
@@ -80,6 +80,10 @@ GameControl::GameControl(Type type) :
     state_counter(GAME_INT_LOAD_CAVE) {
 }
 
+GameControl::~GameControl() {
+    cancel_iterate_ahead();
+}
+
 /// Create a full game from the caveset.
 /// @returns A newly allocated GameControl.
 std::unique_ptr<GameControl> GameControl::new_normal(CaveSet *caveset, std::string player_name, int cave, int level) {
@@ -173,6 +177,8 @@ void GameControl::increment_score(int increment) {
 void GameControl::load_cave() {
     guint32 seed;
 
+    cancel_iterate_ahead();
+
     /* delete gfx buffer */
     gfx_buffer.remove();
     covered.remove();
@@ -258,6 +264,7 @@ bool GameControl::load_snapshot() {
 
     /* overwrite this object with a snapshot game */
     //*this = GameControl(TYPE_SNAPSHOT); // triggers uncover mosaic and as side effect entering outbox will end the game instead of loading next cave!
+    cancel_iterate_ahead();
     played_cave = std::make_unique<CaveRendered>(*snapshot_cave);
     player_score = snapshot_cave->score;
 
@@ -270,6 +277,207 @@ bool GameControl::is_uncovering() const {
     return state_counter > GAME_INT_START_UNCOVER && state_counter < GAME_INT_UNCOVER_ALL;
 }
 
+/// The next cave iteration, done in advance by a thread, while the frame is drawn.
+///
+/// This is a one step lookahead, not a simulation thread running the whole game:
+/// the game flow in main_int() (uncovering, covering, bonus life, the status bar) and the
+/// drawing share gfx_buffer, covered and the particles step by step, so only
+/// CaveRendered::iterate(), the expensive part, is moved to the thread. The state is double
+/// buffered: the thread copies the played cave to its back buffer and iterates that one,
+/// while the played cave is only read by the drawing. If the guessed movement was right,
+/// the two buffers are swapped, so the back buffer is reused and not allocated every step.
+///
+/// The thread runs for the lifetime of the GameControl object. The copy does not have the
+/// particles; the particles created by the iteration are added to the ones of the played cave.
+struct GameControl::IterationAhead {
+    enum State {
+        Idle,           ///< nothing to do, the back buffer is free
+        Copying,        ///< the thread reads the played cave
+        Iterating,      ///< the thread iterates the back buffer
+        Done,           ///< the back buffer has the result
+    };
+
+    GThread *thread;
+    GMutex mutex;
+    GCond cond;
+    State state;
+    bool stale;                     ///< the result is not needed; the next job can start when the thread is done
+    bool quit;
+    std::unique_ptr<CaveRendered> back;
+    CaveRendered const *from;       ///< the played cave, which is copied
+    GdDirectionEnum player_move;    ///< the movement guessed for the iteration
+    bool fire, suicide;
+
+    IterationAhead() : state(Idle), stale(false), quit(false), from(NULL), player_move(MV_STILL), fire(false), suicide(false) {
+        g_mutex_init(&mutex);
+        g_cond_init(&cond);
+        thread = g_thread_new("iterate", run, this);
+    }
+
+    ~IterationAhead() {
+        g_mutex_lock(&mutex);
+        quit = true;
+        g_cond_broadcast(&cond);
+        g_mutex_unlock(&mutex);
+        g_thread_join(thread);
+        g_cond_clear(&cond);
+        g_mutex_clear(&mutex);
+    }
+
+    void set_state(State new_state) {
+        g_mutex_lock(&mutex);
+        state = new_state;
+        g_cond_broadcast(&cond);
+        g_mutex_unlock(&mutex);
+    }
+
+    /// Wait while the thread is in the given state. Call with the mutex locked.
+    void wait_while(State busy) {
+        while (state == busy)
+            g_cond_wait(&cond, &mutex);
+    }
+
+    static gpointer run(gpointer data) {
+        IterationAhead *job = static_cast<IterationAhead *>(data);
+        g_mutex_lock(&job->mutex);
+        for (;;) {
+            while (!job->quit && job->state != Copying)
+                g_cond_wait(&job->cond, &job->mutex);
+            if (job->quit)
+                break;
+            g_mutex_unlock(&job->mutex);
+
+            /* the particles are copied, too, but not needed */
+            if (job->back == nullptr)
+                job->back = std::make_unique<CaveRendered>(*job->from);
+            else
+                *job->back = *job->from;
+            job->back->particles.clear();
+            job->set_state(Iterating);
+            job->back->iterate(job->player_move, job->fire, job->suicide);
+
+            g_mutex_lock(&job->mutex);
+            job->state = Done;
+            g_cond_broadcast(&job->cond);
+        }
+        g_mutex_unlock(&job->mutex);
+        return NULL;
+    }
+};
+
+
+/// Start the next iteration of the cave in a thread, if the cave is running, and the
+/// next main_int() call is going to iterate it. The movement is taken from the
+/// controls now (or from the replay); main_int() only uses the result, if the movement
+/// is still the same, otherwise it iterates the cave itself. The sounds of the
+/// iteration are played by main_int(), in the calling thread.
+/// Call this after main_int(). The thread copies the played cave, so until
+/// wait_iterate_ahead_copied() returns, the played cave can only be read.
+void GameControl::iterate_ahead(GameInputHandler *inputhandler) {
+    if (state_counter != GAME_INT_CAVE_RUNNING || played_cave.get() == NULL)
+        return;
+    if (played_cave->player_state == GD_PL_TIMEOUT)
+        return;
+    /* the same decision as in iterate_cave(), for the next step. */
+    int irl_cavespeed;
+    if (inputhandler == NULL || !inputhandler->fast_forward)
+        irl_cavespeed = played_cave->speed;
+    else
+        irl_cavespeed = step_ms;
+    if (milliseconds_game + step_ms < irl_cavespeed)
+        return;
+
+    if (iteration_ahead == nullptr)
+        iteration_ahead = std::make_unique<IterationAhead>();
+    IterationAhead &job = *iteration_ahead;
+    g_mutex_lock(&job.mutex);
+    /* a result not used is dropped; if the thread is still iterating for a wrong guess, this step is not done in advance */
+    if (job.state == IterationAhead::Done && job.stale)
+        job.state = IterationAhead::Idle;
+    if (job.state != IterationAhead::Idle) {
+        g_mutex_unlock(&job.mutex);
+        return;
+    }
+    job.stale = false;
+    job.from = played_cave.get();
+    job.player_move = MV_STILL;
+    job.fire = false;
+    job.suicide = false;
+    if (inputhandler != NULL) {
+        job.fire = inputhandler->fire1() || inputhandler->fire2();
+        job.suicide = inputhandler->suicide;
+        job.player_move = gd_direction_from_keypress(inputhandler->up(), inputhandler->down(), inputhandler->left(), inputhandler->right());
+    }
+    if (type == TYPE_REPLAY && job.player_move == MV_STILL)
+        replay_from->peek_next_movement(job.player_move, job.fire, job.suicide);
+    job.state = IterationAhead::Copying;
+    g_cond_broadcast(&job.cond);
+    g_mutex_unlock(&job.mutex);
+}
+
+
+/// Wait for the thread started by iterate_ahead() to copy the played cave, so the
+/// played cave can be changed, for example by moving the particles.
+void GameControl::wait_iterate_ahead_copied() {
+    if (iteration_ahead == nullptr)
+        return;
+    IterationAhead &job = *iteration_ahead;
+    g_mutex_lock(&job.mutex);
+    job.wait_while(IterationAhead::Copying);
+    g_mutex_unlock(&job.mutex);
+}
+
+
+/// Wait for the thread started by iterate_ahead(), and throw away its result.
+/// Must be called before changing the played cave other than by main_int().
+void GameControl::cancel_iterate_ahead() {
+    if (iteration_ahead == nullptr)
+        return;
+    IterationAhead &job = *iteration_ahead;
+    g_mutex_lock(&job.mutex);
+    job.wait_while(IterationAhead::Copying);
+    job.wait_while(IterationAhead::Iterating);
+    job.state = IterationAhead::Idle;
+    job.stale = false;
+    g_mutex_unlock(&job.mutex);
+}
+
+
+/// If the cave was iterated in advance with the same movement, replace the played
+/// cave with the result. If not, the thread is only waited for until it has copied
+/// the played cave, so the caller can iterate it; the result is dropped later.
+/// @return true, if the result could be used.
+bool GameControl::take_iteration_ahead(GdDirectionEnum player_move, bool fire, bool suicide) {
+    if (iteration_ahead == nullptr)
+        return false;
+    IterationAhead &job = *iteration_ahead;
+    g_mutex_lock(&job.mutex);
+    if (job.state == IterationAhead::Idle || job.stale) {
+        g_mutex_unlock(&job.mutex);
+        return false;
+    }
+    /* the movement is compared first; the thread does not change these */
+    if (job.from != played_cave.get() || job.player_move != player_move || job.fire != fire || job.suicide != suicide) {
+        job.wait_while(IterationAhead::Copying);
+        job.stale = true;
+        g_mutex_unlock(&job.mutex);
+        return false;
+    }
+    job.wait_while(IterationAhead::Copying);
+    job.wait_while(IterationAhead::Iterating);
+    job.state = IterationAhead::Idle;
+    g_mutex_unlock(&job.mutex);
+
+    /* the particles and the animation of the player are changed by the drawing; take them from the played cave. */
+    played_cave->particles.append(job.back->particles);
+    job.back->particles = std::move(played_cave->particles);
+    job.back->player_blinking = played_cave->player_blinking;
+    job.back->player_tapping = played_cave->player_tapping;
+    /* the old played cave is the back buffer of the next iteration */
+    std::swap(played_cave, job.back);
+    return true;
+}
+
 /// For games, calculate the next cave number and level number.
 /// Called from main_int(), in a normal game, when the cave
 /// is successfully finished (or not successfully, but it is an
@@ -393,7 +601,7 @@ GameControl::State GameControl::iterate_cave(GameInputHandler *inputhandler) {
     if (!fast_forward)
         irl_cavespeed = played_cave->speed;   /* cave speed in ms, like 175ms/frame */
     else
-        irl_cavespeed = 40;                   /* if fast forward, ignore cave speed, and go as 25 iterations/sec */
+        irl_cavespeed = step_ms;              /* if fast forward, ignore cave speed, and go as 25 iterations/sec */
 
     /* if we are playing a replay, but the user intervents, continue as a snapshot. */
     /* do not trigger this for fire, as it would not be too intuitive. */
@@ -406,7 +614,7 @@ GameControl::State GameControl::iterate_cave(GameInputHandler *inputhandler) {
     /* ANYTHING EXCEPT A TIMEOUT, WE ITERATE THE CAVE */
     /* iterate cave */
     return_state = STATE_NOTHING; /* normally nothing happes. but if we iterate, this might change. */
-    milliseconds_game += 40;
+    milliseconds_game += step_ms;
 
     /* decide if cave will be iterated. */
     if (played_cave->player_state != GD_PL_TIMEOUT && milliseconds_game >= irl_cavespeed) {
@@ -430,7 +638,8 @@ GameControl::State GameControl::iterate_cave(GameInputHandler *inputhandler) {
             replay_record->store_movement(player_move, fire, suicide);
 
         /* cave iterate gives us a new player move, which might have diagonal movements removed */
-        played_cave->iterate(player_move, fire, suicide);
+        if (!take_iteration_ahead(player_move, fire, suicide))
+            played_cave->iterate(player_move, fire, suicide);
         if (played_cave->score)
             increment_score(played_cave->score);
         return_state = STATE_NOTHING;
@@ -532,6 +741,7 @@ void GameControl::check_bonus_score_fast() {
 /// Forget all stuff for the current cave.
 /// Maybe push the recording into the replays etc.
 void GameControl::unload_cave() {
+    cancel_iterate_ahead();
     gfx_buffer.remove();
     covered.remove();
 
@@ -614,11 +824,11 @@ GameControl::State GameControl::main_int(GameInputHandler *inputhandler, bool al
     State return_state;
 
     if (bonus_life_flash > 0) {  /* bonus life flash - milliseconds */
-        bonus_life_flash -= 40;
+        bonus_life_flash -= step_ms;
         if (bonus_life_flash < 0)
             bonus_life_flash = 0;
     }
-    statusbarsince += 40;   /* milliseconds */
+    statusbarsince += step_ms;   /* milliseconds */
 
     if (state_counter < GAME_INT_LOAD_CAVE) {
         /* cannot be less than uncover start. */
@@ -131,12 +131,20 @@ public:
     
     /// Default constructor - only used internally by the named constructors.
     GameControl(Type type);
+    ~GameControl();
+
+    /// The length of a game step in milliseconds. main_int() is to be called once for
+    /// every step; the animations, the cave speed and the replays are measured in steps.
+    static const int step_ms = 40;
 
     /* functions to work on */
     bool save_snapshot() const;
     bool load_snapshot();
     State main_int(GameInputHandler *inputhandler, bool allow_iterate);
     bool is_uncovering() const;
+    void iterate_ahead(GameInputHandler *inputhandler);
+    void wait_iterate_ahead_copied();
+    void cancel_iterate_ahead();
 
     /* public variables */
     Type type;
@@ -171,6 +179,11 @@ private:
     
     static std::unique_ptr<CaveRendered> snapshot_cave;   ///< Saved snapshot
 
+    /// The thread which does the next cave iteration in advance, see iterate_ahead().
+    struct IterationAhead;
+    std::unique_ptr<IterationAhead> iteration_ahead;
+    bool take_iteration_ahead(GdDirectionEnum player_move, bool fire, bool suicide);
+
     void add_bonus_life(bool inform_user);
     void increment_score(int increment);
     void select_next_level_indexes();
@@ -24,6 +24,7 @@
 #include "config.h"
 
 #include <glib/gi18n.h>
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <numeric>
@@ -65,18 +66,24 @@ GameRenderer::GameRenderer(Screen &screen, CellRenderer &cells, FontManager &fon
         statusbar_height(0), statusbar_y1(0), statusbar_y2(0), statusbar_mid(0),
         out_of_window(false), show_replay_sign(true),
         scroll_x(0), scroll_y(0),
+        scroll_previous_x(0), scroll_previous_y(0),
+        scroll_frame_x(0), scroll_frame_y(0),
         scroll_desired_x(0), scroll_desired_y(0),
         millisecs_game(0),
         animcycle(0),
         must_draw_cave(false), must_clear_screen(false), must_draw_status(false), must_draw_story(false),
+        particles_drawn(false),
         status_bar_fast(false),
         status_bar_alternate(false),
-        status_bar_paused(false) {
+        status_bar_paused(false),
+        status_bar() {
 }
 
 
 void GameRenderer::release_pixmaps() {
     story.background.release();
+    cave_layer.reset();
+    status_bar.fields.clear();
 }
 
 
@@ -89,6 +96,10 @@ void GameRenderer::set_show_replay_sign(bool srs) {
 void GameRenderer::scroll_to_origin() {
     scroll_x = 0;
     scroll_y = 0;
+    scroll_previous_x = 0;
+    scroll_previous_y = 0;
+    scroll_frame_x = 0;
+    scroll_frame_y = 0;
     scroll_speed_x = 0;
     scroll_speed_y = 0;
     scroll_speed_normal = -1.0;
@@ -181,15 +192,17 @@ bool GameRenderer::cave_scroll(int logical_size, int physical_size, int center,
 
 * scrolling is a bit complicated. different caves have different speeds, and
 * also the game rendering can be run at different speeds (depending on the
-* refresh rate of the user's display). so
-* first a pixel/frame scrolling speed is calculated using the measured delay
+* refresh rate of the user's display). so the scrolling is done in the fixed
+* game steps, like the cave itself, and it does not depend on the refresh rate.
+* the frames drawn between two steps show a position interpolated between the
+* positions of the last two steps, see main_int().
+* first a pixel/step scrolling speed is calculated using the length of the step
 * and the cave speed.
 * 
-* then this pixel speed is rounded to an integer or a half value. this is needed
-* because values like 1.57 pixel/frame cause jerky scrolling (the pixel value
-* of the pixmaps blitted must be rounded to an integer, of course). so when
-* not using fine scrolling (slow refresh rate), it is rounded to an integer.
-* for high refresh rates (fine scrolling), rounding to 0.5 is also acceptable.
+* then this pixel speed is rounded to an integer or a half value, so the
+* scrolling keeps a steady speed even if the calculated value changes a bit.
+* when not using fine scrolling, it is rounded to an integer.
+* with fine scrolling, rounding to 0.5 is also acceptable.
 * 
 * this rounding goes downwards, with the floor() function. scrolling must be slower
 * than the calculated ideal value, or it would be faster than the speed of
@@ -206,7 +219,7 @@ bool GameRenderer::cave_scroll(int logical_size, int physical_size, int center,
 * up, when the player eats many diamonds). when this happens, the scrolling speed
 * is not immediately changed, but also through a hystheresis function.
 
- * @param ms The number of milliseconds elapsed
+ * @param ms The length of the game step in milliseconds
  * @param exact_scroll Whether to scroll to the exact position, or allow hystheresis.
  * @return true, if player is not visible, ie. it is out of the visible size in the drawing area.
  */
@@ -253,13 +266,6 @@ bool GameRenderer::scroll(int ms, bool exact_scroll) {
         exact_scroll, scroll_y, scroll_desired_y, scroll_speed_y))
         scrolled = true;
 
-    /* if scrolling, we should update entire screen. */
-    if (scrolled && !game.gfx_buffer.empty()) {
-        for (int y = 0; y < game.played_cave->h; y++)
-            for (int x = 0; x < game.played_cave->w; x++)
-                game.gfx_buffer(x, y) |= GD_REDRAW;
-    }
-
     /* check if active player is visible at the moment. */
     bool out_of_window = false;
     /* check if active player is outside drawing area. if yes, we should wait for scrolling.
@@ -274,8 +280,6 @@ bool GameRenderer::scroll(int ms, bool exact_scroll) {
             if (game.played_cave->player_y >= game.played_cave->y1 && game.played_cave->player_y <= game.played_cave->y2)
                 out_of_window = true;
     }
-    
-    scroll_ms = ms;
 
     /* if not yet born, we treat as visible. so cave will run. the user is unable to control an unborn player, so this is the right behaviour. */
     if (game.played_cave->player_state == GD_PL_NOT_YET)
@@ -292,9 +296,9 @@ void GameRenderer::drawcave() const {
 
     int scroll_y_aligned;
     if (screen.get_pal_emulation())
-        scroll_y_aligned = int(scroll_y) / 2 * 2;      /* make it even (dividable by two) */
+        scroll_y_aligned = scroll_frame_y / 2 * 2;      /* make it even (dividable by two) */
     else
-        scroll_y_aligned = int(scroll_y);
+        scroll_y_aligned = scroll_frame_y;
 
     /* if the cave is smaller than the play area, add some pixels to make it centered */
     int xplus, yplus;
@@ -315,52 +319,63 @@ void GameRenderer::drawcave() const {
     if (cave_smaller_than_view)
         yplus = 0; // align top
 
+    /* draw the changed cells to the cave layer, if there is one. */
+    bool layer = update_cave_layer();
+
     /* if using particle effects, draw the background, as particles might have moved "out" of it.
      * we should only do this if the cave is smaller than the screen! that we well know from the xplus
-     * and yplus variables set above. */
-    if (must_clear_screen || (gd_particle_effects && (xplus != 0 || yplus != 0))) {
+     * and yplus variables set above. and only if there are particles now, or there were in the
+     * previous frame. */
+    bool particles_outside = gd_particle_effects && (xplus != 0 || yplus != 0)
+                             && (particles_drawn || !game.played_cave->particles.empty());
+    if (must_clear_screen || particles_outside) {
         /* fill screen with status bar background color - particle effects might have gone "out" of the cave */
         screen.fill(cols.background);
+        /* all cells are gone */
+        if (!layer)
+            for (int y = game.played_cave->y1; y <= game.played_cave->y2; y++)
+                for (int x = game.played_cave->x1; x <= game.played_cave->x2; x++)
+                    game.gfx_buffer(x, y) |= GD_REDRAW;
     }
 
-    /* here we draw all cells to be redrawn. the in-cell clipping will be done by the graphics
-     * engine, we only clip full cells. */
-    /* the x and y coordinates are cave physical coordinates.
-     * xd and yd are relative to the visible area. */
-    int x, y, xd, yd;
-    for (y = game.played_cave->y1, yd = 0; y <= game.played_cave->y2; y++, yd++) {
-        int ys = yplus - scroll_y_aligned + statusbar_height + yd * cell_size;
-        for (x = game.played_cave->x1, xd = 0; x <= game.played_cave->x2; x++, xd++) {
-            if (game.gfx_buffer(x, y) & GD_REDRAW) {    /* if it needs to be redrawn */
-                // calculate on-screen coordinates
-                int xs = xplus - scroll_x + xd * cell_size;
-                int dr = game.gfx_buffer(x, y) & ~GD_REDRAW;
-                screen.blit(cells.cell(dr), xs, ys);
-                game.gfx_buffer(x, y) = dr;   /* now that we drew it */
+    if (layer) {
+        /* the visible part of the cave in one step; the clipping is done by the graphics engine. */
+        screen.blit(*cave_layer, xplus - scroll_frame_x, yplus - scroll_y_aligned + statusbar_height);
+    } else {
+        /* here we draw all cells to be redrawn. the in-cell clipping will be done by the graphics
+         * engine, we only clip full cells. */
+        /* the x and y coordinates are cave physical coordinates.
+         * xd and yd are relative to the visible area. */
+        int x, y, xd, yd;
+        for (y = game.played_cave->y1, yd = 0; y <= game.played_cave->y2; y++, yd++) {
+            int ys = yplus - scroll_y_aligned + statusbar_height + yd * cell_size;
+            for (x = game.played_cave->x1, xd = 0; x <= game.played_cave->x2; x++, xd++) {
+                if (game.gfx_buffer(x, y) & GD_REDRAW) {    /* if it needs to be redrawn */
+                    // calculate on-screen coordinates
+                    int xs = xplus - scroll_frame_x + xd * cell_size;
+                    int dr = game.gfx_buffer(x, y) & ~GD_REDRAW;
+                    screen.blit(cells.cell(dr), xs, ys);
+                    game.gfx_buffer(x, y) = dr;   /* now that we drew it */
+                }
             }
         }
     }
 
     /* now draw the particles */
-    if (gd_particle_effects) {
-        int xs = xplus - scroll_x - game.played_cave->x1 * cell_size;
+    particles_drawn = false;
+    if (gd_particle_effects && !game.played_cave->particles.empty()) {
+        int xs = xplus - scroll_frame_x - game.played_cave->x1 * cell_size;
         int ys = yplus + statusbar_height - scroll_y_aligned - game.played_cave->y1 * cell_size;
-        std::list<ParticleSet>::const_iterator it;
-        for (it = game.played_cave->particles.begin(); it != game.played_cave->particles.end(); ++it)
-            screen.draw_particle_set(xs, ys, *it);
-    }
-
-    /* if using particle effects, the whole cave needs to be redrawn later. */
-    if (gd_particle_effects) {
-        /* remember to redraw the whole cave */
-        for (int y = game.played_cave->y1; y <= game.played_cave->y2; y++)
-            for (int x = game.played_cave->x1; x <= game.played_cave->x2; x++)
-                game.gfx_buffer(x, y) |= GD_REDRAW;
+        screen.draw_particles(xs, ys, cell_size, game.played_cave->particles);
+        /* with a cave layer, they are covered anyway in the next frame. */
+        if (!layer)
+            invalidate_particle_cells();
+        particles_drawn = true;
     }
 
     /* writing the scrolling parameters to the screen */
     if (gd_show_fps) {
-        std::string s = Printf("ms=%2d fps=%2d sm=%4.2f sx=%4.2f sy=%4.2f", scroll_ms, 1000/scroll_ms, scroll_speed_normal, scroll_speed_x, scroll_speed_y);
+        std::string s = Printf("ms=%2d fps=%2d sm=%4.2f sx=%4.2f sy=%4.2f", scroll_ms, scroll_ms > 0 ? 1000 / scroll_ms : 0, scroll_speed_normal, scroll_speed_x, scroll_speed_y);
         font_manager.blittext_n(1, screen.get_height()-font_manager.get_line_height()+1, GD_GDASH_BLACK, s.c_str());
         font_manager.blittext_n(0, screen.get_height()-font_manager.get_line_height(), GD_GDASH_WHITE, s.c_str());
     }
@@ -373,6 +388,8 @@ void GameRenderer::drawcave() const {
 void GameRenderer::set_random_colors() {
     if (game.played_cave.get() == NULL)
         return;
+    /* the cave iterated in advance would have the old colors */
+    game.cancel_iterate_ahead();
     gd_cave_set_random_colors(*game.played_cave, GdColor::Type(gd_preferred_palette));
     set_colors_from_cave();
     draw(true);
@@ -387,36 +404,36 @@ bool GameRenderer::drawstatus_firstline(bool in_game) const {
         case GameControl::TYPE_REPLAY:
             if (show_replay_sign) {
                 // TRANSLATORS: the translated string must be at most 20 characters long
-                font_manager.blittext(-1, statusbar_y1, GD_GDASH_YELLOW, _("PLAYING REPLAY"));
+                status_text(-1, statusbar_y1, GD_GDASH_YELLOW, true, _("PLAYING REPLAY"));
                 first_line = true;
             } else if (gd_show_name_of_game && !in_game) {
                 /* if showing the name of the cave... */
                 int len = g_utf8_strlen(game.caveset->name.c_str(), -1);
                 if (screen.get_width() / font_manager.get_font_width_wide() >= len) /* if have place for double-width font */
-                    font_manager.blittext(-1, statusbar_y1, cols.default_color, game.caveset->name.c_str());
+                    status_text(-1, statusbar_y1, cols.default_color, true, game.caveset->name.c_str());
                 else
-                    font_manager.blittext_n(-1, statusbar_y1, cols.default_color, game.caveset->name.c_str());
+                    status_text(-1, statusbar_y1, cols.default_color, false, game.caveset->name.c_str());
                 first_line = true;
             }
             break;
         case GameControl::TYPE_CONTINUE_REPLAY:
             if (show_replay_sign) {
                 // TRANSLATORS: the translated string must be at most 20 characters long
-                font_manager.blittext(-1, statusbar_y1, GD_GDASH_YELLOW, _("CONTINUING REPLAY"));
+                status_text(-1, statusbar_y1, GD_GDASH_YELLOW, true, _("CONTINUING REPLAY"));
                 first_line = true;
             }
             break;
         case GameControl::TYPE_SNAPSHOT:
             if (show_replay_sign) {
                 // TRANSLATORS: the translated string must be at most 20 characters long
-                font_manager.blittext(-1, statusbar_y1, GD_GDASH_YELLOW, _("PLAYING SNAPSHOT"));
+                status_text(-1, statusbar_y1, GD_GDASH_YELLOW, true, _("PLAYING SNAPSHOT"));
                 first_line = true;
             }
             break;
         case GameControl::TYPE_TEST:
             if (show_replay_sign) {
                 // TRANSLATORS: the translated string must be at most 20 characters long
-                font_manager.blittext(-1, statusbar_y1, GD_GDASH_YELLOW, _("TESTING CAVE"));
+                status_text(-1, statusbar_y1, GD_GDASH_YELLOW, true, _("TESTING CAVE"));
                 first_line = true;
             }
             break;
@@ -426,16 +443,16 @@ bool GameRenderer::drawstatus_firstline(bool in_game) const {
                 /* also inform about intermission, but not if playing a replay. also the replay saver should not show it! f */
                 if (game.played_cave->intermission) {
                     // TRANSLATORS: the translated string must be at most 20 characters long
-                    font_manager.blittext(-1, statusbar_y1, cols.default_color, _("ONE LIFE EXTRA"));
+                    status_text(-1, statusbar_y1, cols.default_color, true, _("ONE LIFE EXTRA"));
                     first_line = true;
                 } else if (gd_show_name_of_game) {
                     /* if not an intermission, we may show the name of the game (caveset) */
                     /* if showing the name of the cave... */
                     int len = g_utf8_strlen(game.caveset->name.c_str(), -1);
                     if (screen.get_width() / font_manager.get_font_width_wide() >= len) /* if have place for double-width font */
-                        font_manager.blittext(-1, statusbar_y1, cols.default_color, game.caveset->name.c_str());
+                        status_text(-1, statusbar_y1, cols.default_color, true, game.caveset->name.c_str());
                     else
-                        font_manager.blittext_n(-1, statusbar_y1, cols.default_color, game.caveset->name.c_str());
+                        status_text(-1, statusbar_y1, cols.default_color, false, game.caveset->name.c_str());
                     first_line = true;
                 }
             }
@@ -462,9 +479,9 @@ void GameRenderer::drawstatus_uncover() const {
         str = Printf("%s/%d", game.played_cave->name, int(game.played_cave->rendered_on + 1));
     int len = g_utf8_strlen(str.c_str(), -1);
     if (screen.get_width() / font_manager.get_font_width_wide() >= len) /* if have place for double-width font */
-        font_manager.blittext(-1, cavename_y, cols.default_color, str.c_str());
+        status_text(-1, cavename_y, cols.default_color, true, str.c_str());
     else
-        font_manager.blittext_n(-1, cavename_y, cols.default_color, str.c_str());
+        status_text(-1, cavename_y, cols.default_color, false, str.c_str());
 }
 
 
@@ -488,7 +505,7 @@ void GameRenderer::drawstatus_game() const {
     if (game.played_cave->player_state == GD_PL_TIMEOUT
             && game.statusbarsince / 1000 % 4 == 0) {
         // TRANSLATORS: the translated string must be at most 20 characters long
-        font_manager.blittext(-1, statusbar_mid, GD_GDASH_WHITE, _("OUT OF TIME"));
+        status_text(-1, statusbar_mid, GD_GDASH_WHITE, true, _("OUT OF TIME"));
         return;
     }
 
@@ -502,18 +519,18 @@ void GameRenderer::drawstatus_game() const {
         /* this will output a total of 20 chars */
         int x = (screen.get_width() - 20 * font_manager.get_font_width_wide()) / 2;
 
-        x = font_manager.blittext(x, y, cols.default_color, "%c%02d ", GD_PLAYER_CHAR, gd_clamp(game.player_lives, 0, 99)); /* max 99 in %2d */
+        x = status_text(x, y, cols.default_color, true, Printf("%c%02d ", GD_PLAYER_CHAR, gd_clamp(game.player_lives, 0, 99))); /* max 99 in %2d */
         /* color numbers are not the same as key numbers! c3->k1, c2->k2, c1->k3 */
         /* this is how it was implemented in crdr7. */
-        x = font_manager.blittext(x, y, game.played_cave->color3, "%c%1d ", GD_KEY_CHAR, gd_clamp(int(game.played_cave->key1), 0, 9)); /* max 9 in %1d */
-        x = font_manager.blittext(x, y, game.played_cave->color2, "%c%1d ", GD_KEY_CHAR, gd_clamp(int(game.played_cave->key2), 0, 9));
-        x = font_manager.blittext(x, y, game.played_cave->color1, "%c%1d ", GD_KEY_CHAR, gd_clamp(int(game.played_cave->key3), 0, 9));
+        x = status_text(x, y, game.played_cave->color3, true, Printf("%c%1d ", GD_KEY_CHAR, gd_clamp(int(game.played_cave->key1), 0, 9))); /* max 9 in %1d */
+        x = status_text(x, y, game.played_cave->color2, true, Printf("%c%1d ", GD_KEY_CHAR, gd_clamp(int(game.played_cave->key2), 0, 9)));
+        x = status_text(x, y, game.played_cave->color1, true, Printf("%c%1d ", GD_KEY_CHAR, gd_clamp(int(game.played_cave->key3), 0, 9)));
         if (game.played_cave->gravity_will_change > 0) {
-            x = font_manager.blittext(x, y, cols.default_color, "%c%02d ", gravity_char(game.played_cave->gravity_next_direction), gd_clamp(game.played_cave->time_visible(game.played_cave->gravity_will_change), 0, 99));
+            x = status_text(x, y, cols.default_color, true, Printf("%c%02d ", gravity_char(game.played_cave->gravity_next_direction), gd_clamp(game.played_cave->time_visible(game.played_cave->gravity_will_change), 0, 99)));
         } else {
-            x = font_manager.blittext(x, y, cols.default_color, "%c%02d ", gravity_char(game.played_cave->gravity), 0);
+            x = status_text(x, y, cols.default_color, true, Printf("%c%02d ", gravity_char(game.played_cave->gravity), 0));
         }
-        x = font_manager.blittext(x, y, cols.diamond_collected, "%c%02d", GD_SKELETON_CHAR, gd_clamp(int(game.played_cave->skeletons_collected), 0, 99));
+        x = status_text(x, y, cols.diamond_collected, true, Printf("%c%02d", GD_SKELETON_CHAR, gd_clamp(int(game.played_cave->skeletons_collected), 0, 99)));
     } else {
         int scale = screen.get_pixmap_scale();
         /* NORMAL STATUS BAR */
@@ -531,43 +548,102 @@ void GameRenderer::drawstatus_game() const {
         x += 1 * scale;
         if (status_bar_fast) {
             /* fast forward mode - show "FAST" */
-            x = font_manager.blittext(x, y, cols.default_color, "%cFAST%c", GD_DIAMOND_CHAR, GD_DIAMOND_CHAR);
+            x = status_text(x, y, cols.default_color, true, Printf("%cFAST%c", GD_DIAMOND_CHAR, GD_DIAMOND_CHAR));
         } else {
             /* normal speed mode - show diamonds NEEDED <> VALUE */
             /* or if collected enough diamonds,   <><><> VALUE */
             if (game.played_cave->diamonds_needed > game.played_cave->diamonds_collected) {
                 if (game.played_cave->diamonds_needed > 0)
-                    x = font_manager.blittext(x, y, cols.diamond_needed, "%03d", game.played_cave->diamonds_needed);
+                    x = status_text(x, y, cols.diamond_needed, true, Printf("%03d", game.played_cave->diamonds_needed));
                 else
                     /* did not already count diamonds needed */
-                    x = font_manager.blittext(x, y, cols.diamond_needed, "%c%c%c", GD_DIAMOND_CHAR, GD_DIAMOND_CHAR, GD_DIAMOND_CHAR);
+                    x = status_text(x, y, cols.diamond_needed, true, Printf("%c%c%c", GD_DIAMOND_CHAR, GD_DIAMOND_CHAR, GD_DIAMOND_CHAR));
             } else
-                x = font_manager.blittext(x, y, cols.default_color, " %c%c", GD_DIAMOND_CHAR, GD_DIAMOND_CHAR);
-            x = font_manager.blittext(x, y, cols.default_color, "%c", GD_DIAMOND_CHAR);
-            x = font_manager.blittext(x, y, cols.diamond_value, "%02d", game.played_cave->diamond_value);
+                x = status_text(x, y, cols.default_color, true, Printf(" %c%c", GD_DIAMOND_CHAR, GD_DIAMOND_CHAR));
+            x = status_text(x, y, cols.default_color, true, Printf("%c", GD_DIAMOND_CHAR));
+            x = status_text(x, y, cols.diamond_value, true, Printf("%02d", game.played_cave->diamond_value));
         }
         x += 10 * scale;
-        x = font_manager.blittext(x, y, cols.diamond_collected, "%03d", game.played_cave->diamonds_collected);
+        x = status_text(x, y, cols.diamond_collected, true, Printf("%03d", game.played_cave->diamonds_collected));
         x += 11 * scale;
-        x = font_manager.blittext(x, y, cols.default_color, "%03d", time_secs);
+        x = status_text(x, y, cols.default_color, true, Printf("%03d", time_secs));
         x += 10 * scale;
-        x = font_manager.blittext(x, y, cols.score, "%06d", game.player_score);
+        x = status_text(x, y, cols.score, true, Printf("%06d", game.player_score));
+    }
+}
+
+
+int GameRenderer::status_text(int x, int y, GdColor const &color, bool widefont, std::string const &text) const {
+    /* status bar is drawn from scratch: draw and remember this field */
+    if (status_bar.redraw_all) {
+        StatusBarField field = { x, y, widefont, color, text, 0 };
+        if (widefont)
+            field.x_end = font_manager.blittext(x, y, color, text.c_str());
+        else
+            field.x_end = font_manager.blittext_n(x, y, color, text.c_str());
+        status_bar.fields.push_back(field);
+        return field.x_end;
     }
+
+    /* if the fields are not at the same place as the last time, the whole bar will be redrawn. */
+    if (status_bar.layout_changed || status_bar.next_field >= status_bar.fields.size()) {
+        status_bar.layout_changed = true;
+        return x;
+    }
+    StatusBarField &field = status_bar.fields[status_bar.next_field++];
+    if (field.x != x || field.y != y || field.widefont != widefont) {
+        status_bar.layout_changed = true;
+        return x;
+    }
+
+    /* at the same place; redraw only if changed */
+    if (field.text != text || field.color != color) {
+        /* clear the text drawn last time. centered texts may start anywhere. */
+        int x1 = x == -1 ? 0 : x;
+        int x2 = x == -1 ? screen.get_width() : field.x_end;
+        screen.fill_rect(x1, y, x2 - x1, font_manager.get_font_height(), cols.background);
+        if (widefont)
+            field.x_end = font_manager.blittext(x, y, color, text.c_str());
+        else
+            field.x_end = font_manager.blittext_n(x, y, color, text.c_str());
+        field.text = text;
+        field.color = color;
+    }
+    return field.x_end;
 }
 
 
-void GameRenderer::drawstatus() const {
+void GameRenderer::drawstatus(bool full) const {
     /* check if no status bar at all */
     if (game.statusbartype == GameControl::status_bar_none)
         return;
 
-    /* clear the header bar */
-    screen.fill_rect(0, 0, screen.get_width(), statusbar_height, cols.background);
+    /* first try to redraw only the changed fields. if the fields moved, clear the bar and draw everything. */
+    bool redraw_all = full || status_bar.fields.empty();
+    for (;;) {
+        status_bar.redraw_all = redraw_all;
+        status_bar.layout_changed = false;
+        status_bar.next_field = 0;
+        if (redraw_all) {
+            /* clear the header bar */
+            screen.fill_rect(0, 0, screen.get_width(), statusbar_height, cols.background);
+            status_bar.fields.clear();
+        }
+        drawstatus_fields();
+        if (status_bar.next_field != status_bar.fields.size() && !redraw_all)
+            status_bar.layout_changed = true;
+        if (!status_bar.layout_changed)
+            break;
+        redraw_all = true;
+    }
+}
+
 
+void GameRenderer::drawstatus_fields() const {
     /* when paused, switch between "paused" status bar and normal */
     if (status_bar_paused && game.statusbarsince / 1000 % 4 == 0) {
         // TRANSLATORS: the translated string must be at most 20 characters long
-        font_manager.blittext(-1, statusbar_mid, cols.default_color, _("SPACEBAR TO RESUME"));
+        status_text(-1, statusbar_mid, cols.default_color, true, _("SPACEBAR TO RESUME"));
         return;
     }
 
@@ -584,13 +660,16 @@ void GameRenderer::drawstatus() const {
         case GameControl::status_bar_game_over:
             // TRANSLATORS: the translated string must be at most 20 characters long.
             // the c64 original had these spaces - you are allowed to do so.
-            font_manager.blittext(-1, statusbar_mid, cols.default_color, _("G A M E   O V E R"));
+            status_text(-1, statusbar_mid, cols.default_color, true, _("G A M E   O V E R"));
             break;
     }
 }
 
 
 void GameRenderer::select_status_bar_colors() {
+    /* the background changes, so the status bar must be drawn from scratch */
+    status_bar.fields.clear();
+
     GdColor(*color_indexer)(unsigned i);
     /* first, count the number of c64 colors the cave uses. */
     /* if it uses mostly c64 colors, we will use c64 colors for the status bar. */
@@ -671,10 +750,17 @@ void GameRenderer::set_colors_from_cave() {
     game.played_cave->expanding_wall_particle_color = average_nonblack_colors_in_pixbuf(cells.cell_pixbuf(abs(gd_element_properties[game.played_cave->expanding_wall_looks_like].image_game)));
     game.played_cave->expanding_steel_wall_particle_color = average_nonblack_colors_in_pixbuf(cells.cell_pixbuf(abs(gd_element_properties[O_EXPANDING_STEEL_WALL].image_game)));
     game.played_cave->lava_particle_color = average_nonblack_colors_in_pixbuf(cells.cell_pixbuf(abs(gd_element_properties[O_LAVA].image_game)));
+
+    /* render the cells of this cave in the background, while the cave is uncovered,
+     * so drawing them for the first time will not cause a hitch */
+    cells.prewarm(game.played_cave->collect_drawn_cells());
 }
 
 
 void GameRenderer::drawstory() const {
+    // the story covers the status bar
+    status_bar.fields.clear();
+
     // create dark background
     if (story.background.get() == NULL) {
         // create the pixbuf for it
@@ -726,7 +812,7 @@ void GameRenderer::draw(bool full) const {
         if (full || must_draw_cave)
             drawcave();
         if (full || must_draw_status) {
-            drawstatus();
+            drawstatus(full);
         }
 
         must_clear_screen = false;
@@ -751,13 +837,78 @@ void GameRenderer::screen_initialized() {
     statusbar_y1 = 0;
     statusbar_y2 = font_manager.get_font_height();
     statusbar_mid = (statusbar_height - font_manager.get_font_height()) / 2;
+    status_bar.fields.clear();
     /* for story */
     story.linesavailable = screen.get_height() / font_manager.get_line_height() - 6;
 }
 
-/** For removing old particles (a predicate) */
-static bool old_particle(ParticleSet const &ps) {
-    return ps.life < 0;
+/**
+ * Draw the changed cells of the visible part of the cave to the cave layer,
+ * which is then blitted to the screen at once. This way scrolling does not
+ * require drawing all cells again.
+ * The layer is created here, if needed. If the screen does not support layers,
+ * or the layer would be too big, there is no layer, and the cells must be drawn
+ * one by one to the screen.
+ * @return true, if there is a cave layer.
+ */
+bool GameRenderer::update_cave_layer() const {
+    int cell_size = cells.get_cell_size();
+    int x1 = game.played_cave->x1, y1 = game.played_cave->y1;
+    int x2 = game.played_cave->x2, y2 = game.played_cave->y2;
+    int layer_w = (x2 - x1 + 1) * cell_size, layer_h = (y2 - y1 + 1) * cell_size;
+
+    /* the layer and the screen do not have the cells which are already drawn to the other one */
+    if (cave_layer != nullptr && (cave_layer->get_width() != layer_w || cave_layer->get_height() != layer_h)) {
+        cave_layer.reset();
+        for (int y = y1; y <= y2; y++)
+            for (int x = x1; x <= x2; x++)
+                game.gfx_buffer(x, y) |= GD_REDRAW;
+    }
+    if (cave_layer == nullptr) {
+        if (double(layer_w) * layer_h > max_cave_layer_pixels)
+            return false;
+        cave_layer = screen.create_layer(layer_w, layer_h);
+        if (cave_layer == nullptr)
+            return false;
+        for (int y = y1; y <= y2; y++)
+            for (int x = x1; x <= x2; x++)
+                game.gfx_buffer(x, y) |= GD_REDRAW;
+    }
+
+    for (int y = y1; y <= y2; y++) {
+        for (int x = x1; x <= x2; x++) {
+            if (game.gfx_buffer(x, y) & GD_REDRAW) {
+                int dr = game.gfx_buffer(x, y) & ~GD_REDRAW;
+                screen.blit_to_layer(cells.cell(dr), *cave_layer, (x - x1) * cell_size, (y - y1) * cell_size);
+                game.gfx_buffer(x, y) = dr;
+            }
+        }
+    }
+    return true;
+}
+
+
+/**
+ * Remember to redraw the cells on which particles were drawn.
+ * Only those cells are touched, which are covered by the bounding box
+ * of a particle, so the rest of the cave is not redrawn in the next frame.
+ */
+void GameRenderer::invalidate_particle_cells() const {
+    ParticlePool const &particles = game.played_cave->particles;
+    int cell_size = cells.get_cell_size();
+    int x1 = game.played_cave->x1, y1 = game.played_cave->y1;
+    int x2 = game.played_cave->x2, y2 = game.played_cave->y2;
+    for (size_t i = 0; i < particles.num_particles(); ++i) {
+        /* the radius of the diamond in cells; plus one pixel for rounding errors. */
+        double r = (ceil(particles.size[i] * cell_size) + 1) / cell_size;
+        int cx1 = std::max<int>(floor(particles.px[i] - r), x1);
+        int cx2 = std::min<int>(floor(particles.px[i] + r), x2);
+        int cy1 = std::max<int>(floor(particles.py[i] - r), y1);
+        int cy2 = std::min<int>(floor(particles.py[i] + r), y2);
+        for (int y = cy1; y <= cy2; y++)
+            for (int x = cx1; x <= cx2; x++)
+                game.gfx_buffer(x, y) |= GD_REDRAW;
+    }
 }
 
 
@@ -773,9 +924,14 @@ GameRenderer::State GameRenderer::main_int(int millisecs_elapsed, bool paused, G
     }
     status_bar_paused = paused;
 
+    /* the particles and the player animation of the played cave are changed below;
+     * the thread iterating in advance must not be copying it meanwhile. */
+    game.wait_iterate_ahead_copied();
+
+    /* the game is run in fixed steps; the time remaining is kept for the next call. */
     millisecs_game += millisecs_elapsed;
-    while (millisecs_game >= 40) {
-        millisecs_game -= 40;
+    while (millisecs_game >= GameControl::step_ms) {
+        millisecs_game -= GameControl::step_ms;
 
         /* tell the interrupt "40 ms has passed" - the cave will move. */
         state = game.main_int(inputhandler, !paused && !out_of_window);
@@ -822,23 +978,36 @@ GameRenderer::State GameRenderer::main_int(int millisecs_elapsed, bool paused, G
             case GameControl::STATE_GAME_OVER:
                 break;
         }
+
+        if (!game.gfx_buffer.empty()) {
+            /* do the scrolling; it is also done in steps. */
+            /* scroll exactly, if player is not yet alive. */
+            /* remember the "player out of window" for next iteration. */
+            scroll_previous_x = scroll_x;
+            scroll_previous_y = scroll_y;
+            out_of_window = scroll(GameControl::step_ms, game.played_cave->player_state == GD_PL_NOT_YET);
+        }
     }
 
     if (!game.gfx_buffer.empty()) {
-        /* do the scrolling. */
-        /* scroll exactly, if player is not yet alive. */
-        /* remember the "player out of window" for next iteration. */
-        /* the scrolling routine invalidates the game gfx cells if needed. */
-        out_of_window = scroll(millisecs_elapsed, game.played_cave->player_state == GD_PL_NOT_YET);
+        /* the scroll position of this frame is between the positions of the last two steps,
+         * by the time elapsed since the last step. */
+        double fraction = double(millisecs_game) / GameControl::step_ms;
+        int frame_x = int(scroll_previous_x + (scroll_x - scroll_previous_x) * fraction);
+        int frame_y = int(scroll_previous_y + (scroll_y - scroll_previous_y) * fraction);
+        /* if scrolled, we should update entire screen. if there is a cave layer, that is
+         * done by blitting it at the new place, no need to draw the cells again. */
+        if ((frame_x != scroll_frame_x || frame_y != scroll_frame_y) && cave_layer == nullptr) {
+            for (int y = 0; y < game.played_cave->h; y++)
+                for (int x = 0; x < game.played_cave->w; x++)
+                    game.gfx_buffer(x, y) |= GD_REDRAW;
+        }
+        scroll_frame_x = frame_x;
+        scroll_frame_y = frame_y;
+        scroll_ms = millisecs_elapsed;
 
         /* move the particles */
-        std::list<ParticleSet>::iterator it;
-        for (it = game.played_cave->particles.begin(); it != game.played_cave->particles.end(); ++it) {
-            if (it->is_new)
-                it->normalize(cells.get_cell_size());
-            it->move(millisecs_elapsed);
-        }
-        game.played_cave->particles.remove_if(old_particle);
+        game.played_cave->particles.move(millisecs_elapsed);
 
         /* always render the cave to the gfx buffer; however it may do nothing if animcycle was not changed. */
         game.played_cave->draw_indexes(game.gfx_buffer, game.covered, game.bonus_life_flash > 0, animcycle, gd_no_invisible_outbox);
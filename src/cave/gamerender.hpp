@@ -90,20 +90,45 @@ class GameRenderer : public PixmapStorage {
     bool show_replay_sign;
 
     double scroll_x, scroll_y;
+    double scroll_previous_x, scroll_previous_y;    ///< scroll position before the last game step
+    int scroll_frame_x, scroll_frame_y;             ///< scroll position of the frame drawn, interpolated between the steps
     double scroll_speed_x, scroll_speed_y;
     std::vector<double> scroll_speeds_during_uncover;
     double scroll_speed_normal;
     int scroll_ms;
     int scroll_desired_x, scroll_desired_y;
 
-    int millisecs_game;
+    int millisecs_game;         ///< milliseconds elapsed since the last game step
     int animcycle;              ///< animation frames, from 0 to 7, and then again 0
 
     mutable bool must_draw_cave, must_clear_screen, must_draw_status, must_draw_story;
+    mutable bool particles_drawn;   ///< particles were drawn in the last frame, so they are still on the screen
+
+    /// The visible part of the cave, drawn off-screen. Only the changed cells are drawn to it,
+    /// and it is blitted to the screen at once. nullptr, if not supported by the screen.
+    mutable std::unique_ptr<Pixmap> cave_layer;
+    /// Maximum size of the cave layer; bigger caves are drawn cell by cell.
+    static const int max_cave_layer_pixels = 16 * 1024 * 1024;
 
     // the last set status bar in the game
     bool status_bar_fast, status_bar_alternate, status_bar_paused;
 
+    /// A piece of text on the status bar. They are remembered, so the next time
+    /// only the ones which changed have to be redrawn.
+    struct StatusBarField {
+        int x, y;
+        bool widefont;
+        GdColor color;
+        std::string text;
+        int x_end;          ///< where the drawing of the text ended
+    };
+    struct StatusBarStuff {
+        std::vector<StatusBarField> fields;     ///< fields currently on the screen
+        unsigned next_field;                    ///< the field to compare to while drawing
+        bool redraw_all;                        ///< the bar is drawn from scratch
+        bool layout_changed;                    ///< a field is not at the same place as the last time
+    } mutable status_bar;
+
 
     // for showing the story
     struct StoryStuff {
@@ -119,10 +144,14 @@ class GameRenderer : public PixmapStorage {
 
     void drawstory() const;
     void drawcave() const;
+    bool update_cave_layer() const;
+    void invalidate_particle_cells() const;
     bool drawstatus_firstline(bool in_game) const;
     void drawstatus_uncover() const;
     void drawstatus_game() const;
-    void drawstatus() const;
+    void drawstatus_fields() const;
+    void drawstatus(bool full) const;
+    int status_text(int x, int y, GdColor const &color, bool widefont, std::string const &text) const;
 
     void set_colors_from_cave();
     void select_status_bar_colors();
@@ -73,11 +73,19 @@ void CaveReplay::store_movement(GdDirectionEnum player_move, bool player_fire, b
 /* get next available movement from a replay; store variables to player_move, player_fire, suicide */
 /* return true if successful */
 bool CaveReplay::get_next_movement(GdDirectionEnum &player_move, bool &player_fire, bool &suicide) {
+    if (!peek_next_movement(player_move, player_fire, suicide))
+        return false;
+    current_playing_pos++;
+    return true;
+}
+
+/* like get_next_movement, but the replay is not advanced */
+bool CaveReplay::peek_next_movement(GdDirectionEnum &player_move, bool &player_fire, bool &suicide) const {
     /* if no more available movements */
     if (current_playing_pos >= movements.size())
         return false;
 
-    movement data = movements[current_playing_pos++];
+    movement data = movements[current_playing_pos];
 
     suicide = (data & REPLAY_SUICIDE_MASK) != 0;
     player_fire = (data & REPLAY_FIRE_MASK) != 0;
@@ -57,6 +57,7 @@ public:
     bool load_from_bdcff(const std::string &str);
     void store_movement(GdDirectionEnum player_move, bool player_fire, bool suicide);
     bool get_next_movement(GdDirectionEnum &player_move, bool &player_fire, bool &suicide);
+    bool peek_next_movement(GdDirectionEnum &player_move, bool &player_fire, bool &suicide) const;
     void rewind();
     unsigned int length() const {
         return movements.size();
@@ -22,50 +22,117 @@
  */
 
 #include <glib.h>
+#include <algorithm>
 
 #include "cave/particle.hpp"
+#include "misc/logger.hpp"
 
-ParticleSet::ParticleSet(int count, float size, float opacity, float p0x, float p0y, float dp0x, float dp0y, float v0x, float v0y, float dvx, float dvy, const GdColor &color)
-    : color(color)
-    , life(1000)
-    , is_new(true)
-    , size(size)
-    , opacity(opacity)
-    , particles(count) {
-    for (size_t i = 0; i < particles.size(); ++i) {
-        Particle &p = particles[i];
-        p.px = p0x + g_random_double_range(-dp0x, dp0x);
-        p.py = p0y + g_random_double_range(-dp0y, dp0y);
-        p.vx = v0x + g_random_double_range(-dvx, dvx);
-        p.vy = v0y + g_random_double_range(-dvy, dvy);
+/* allocate the whole pool at the first time */
+void ParticlePool::allocate() {
+    if (px.capacity() < capacity) {
+        px.reserve(capacity);
+        py.reserve(capacity);
+        vx.reserve(capacity);
+        vy.reserve(capacity);
+        life.reserve(capacity);
+        size.reserve(capacity);
+        opacity.reserve(capacity);
+        color.reserve(capacity);
     }
 }
 
 
-void ParticleSet::move(int dt_ms) {
-    float dt = dt_ms / 1000.0;
+void ParticlePool::add(int count, float size, float opacity, float p0x, float p0y, float dp0x, float dp0y, float v0x, float v0y, float dvx, float dvy, const GdColor &color) {
+    allocate();
 
-    for (size_t i = 0; i < particles.size(); ++i) {
-        Particle &p = particles[i];
-        p.px += p.vx * dt;
-        p.py += p.vy * dt;
+    if (px.size() + count > capacity)
+        num_dropped += px.size() + count - std::max(capacity, px.size());
+    for (int i = 0; i < count && px.size() < capacity; ++i) {
+        px.push_back(p0x + g_random_double_range(-dp0x, dp0x));
+        py.push_back(p0y + g_random_double_range(-dp0y, dp0y));
+        vx.push_back(v0x + g_random_double_range(-dvx, dvx));
+        vy.push_back(v0y + g_random_double_range(-dvy, dvy));
+        life.push_back(1000);
+        this->size.push_back(size);
+        this->opacity.push_back(opacity);
+        this->color.push_back(color);
     }
+}
+
+
+void ParticlePool::append(ParticlePool const &other) {
+    allocate();
 
-    life -= dt_ms;
+    num_dropped += other.num_dropped;
+    if (px.size() + other.num_particles() > capacity)
+        num_dropped += px.size() + other.num_particles() - std::max(capacity, px.size());
+    for (size_t i = 0; i < other.num_particles() && px.size() < capacity; ++i) {
+        px.push_back(other.px[i]);
+        py.push_back(other.py[i]);
+        vx.push_back(other.vx[i]);
+        vy.push_back(other.vy[i]);
+        life.push_back(other.life[i]);
+        size.push_back(other.size[i]);
+        opacity.push_back(other.opacity[i]);
+        color.push_back(other.color[i]);
+    }
 }
 
 
-void ParticleSet::normalize(double factor) {
-    if (!is_new)
-        return;
-    is_new = false;
+void ParticlePool::move(int dt_ms) {
+    float dt = dt_ms / 1000.0;
+    size_t n = px.size();
 
-    size *= factor;
-    for (size_t i = 0; i < particles.size(); ++i) {
-        Particle &p = particles[i];
-        p.px *= factor;
-        p.py *= factor;
-        p.vx *= factor;
-        p.vy *= factor;
+    float *pxs = px.data(), *pys = py.data();
+    float const *vxs = vx.data(), *vys = vy.data();
+    int *lifes = life.data();
+    for (size_t i = 0; i < n; ++i) {
+        pxs[i] += vxs[i] * dt;
+        pys[i] += vys[i] * dt;
+        lifes[i] -= dt_ms;
     }
+
+    /* remove the expired ones, moving the others forward */
+    size_t kept = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (life[i] < 0)
+            continue;
+        if (kept != i) {
+            px[kept] = px[i];
+            py[kept] = py[i];
+            vx[kept] = vx[i];
+            vy[kept] = vy[i];
+            life[kept] = life[i];
+            size[kept] = size[i];
+            opacity[kept] = opacity[i];
+            color[kept] = color[i];
+        }
+        ++kept;
+    }
+    px.resize(kept);
+    py.resize(kept);
+    vx.resize(kept);
+    vy.resize(kept);
+    life.resize(kept);
+    size.resize(kept);
+    opacity.resize(kept);
+    color.resize(kept);
+
+    if (num_dropped != 0) {
+        gd_debug("particle pool full, %d particles not added", int(num_dropped));
+        num_dropped = 0;
+    }
+}
+
+
+void ParticlePool::clear() {
+    num_dropped = 0;
+    px.clear();
+    py.clear();
+    vx.clear();
+    vy.clear();
+    life.clear();
+    size.clear();
+    opacity.clear();
+    color.clear();
 }
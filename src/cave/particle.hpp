@@ -29,60 +29,73 @@
 #include <vector>
 #include "cave/colors.hpp"
 
-class ParticleSet {
+/// The particles of a cave.
+///
+/// The particles are stored in a pool, which is allocated once, when the first
+/// particles are added; after that, adding and removing particles does not
+/// allocate memory. Every attribute of the particles is stored in its own array
+/// (structure of arrays), so moving them is a simple loop, which the compiler
+/// can vectorize. Expired particles are removed in one pass, which keeps the
+/// order of the remaining ones, so overlapping particles are drawn in the same
+/// order in every frame.
+///
+/// The pool has a fixed capacity. If it is full, new particles are not added;
+/// particles are only decoration, so the game is not affected. The number of
+/// particles dropped is reported by move() as a debug message.
+///
+/// Coordinates, speeds and sizes are in cave cells: 0,0 is the top left corner
+/// of the cave; 1,1 is the bottom right corner of the top left cave cell. (So the
+/// max coordinates are the width and height of the cave.) The drawing functions
+/// multiply them with the number of pixels per cell.
+class ParticlePool {
 public:
-    /// One single particle.
-    struct Particle {
-        float px, py;         ///< Coordinate
-        float vx, vy;         ///< Speed
-    };
+    /// Maximum number of particles; if the pool is full, no new particles are added.
+    /// This is about ten big explosions at the same time.
+    static const size_t capacity = 16384;
 
-    /// This constructor creates a particle set, for the given cave coordinates.
-    /// 0,0 is the top left corner of the cave; 1,1 is the bottom right corner of
-    /// the top left cave cell. (So the max coordinates are the width and height
-    /// of the cave.)
-    /// @param cave_x Particle set starting x coordinate in cave coordinates.
-    /// @param cave_y Particle set starting y coordinate in cave coordinates.
-    /// @param dx Half the width of the region, in which originally particles are randomly generated.
-    /// @param dy Half the height of the region, in which originally particles are randomly generated.
-    /// @param vx Maximum original speed.
-    /// @param vy Maximum original speed.
-    ParticleSet(int count, float size, float opacity, float p0x, float p0y, float dp0x, float dp0y, float v0x, float v0y, float dvx, float dvy, const GdColor &color);
-    /// Move the particles.
+    ParticlePool() : num_dropped(0) {}
+
+    /// Create a set of particles, for the given cave coordinates.
+    /// @param count Number of particles.
+    /// @param size Size of the particles.
+    /// @param opacity Opacity between 0 and 1. Values close to 1 not recommended.
+    /// @param p0x Particle set starting x coordinate in cave coordinates.
+    /// @param p0y Particle set starting y coordinate in cave coordinates.
+    /// @param dp0x Half the width of the region, in which originally particles are randomly generated.
+    /// @param dp0y Half the height of the region, in which originally particles are randomly generated.
+    /// @param v0x Original speed.
+    /// @param v0y Original speed.
+    /// @param dvx Maximum random difference from the original speed.
+    /// @param dvy Maximum random difference from the original speed.
+    /// @param color Color of the particles.
+    void add(int count, float size, float opacity, float p0x, float p0y, float dp0x, float dp0y, float v0x, float v0y, float dvx, float dvy, const GdColor &color);
+    /// Add the particles of another pool to this one.
+    void append(ParticlePool const &other);
+    /// Move the particles, and remove the expired ones. Not to be called from
+    /// a thread, as it reports the particles dropped to the logger.
     /// @param dt_ms Time elapsed.
     void move(int dt_ms);
-    /// Scale coordinates to screen cordinates, if is_new is true.
-    /// @param factor The number of pixels per cell on the screen.
-    void normalize(double factor);
-
-    typedef std::vector<Particle> container;
-    typedef container::iterator iterator;
-    typedef container::const_iterator const_iterator;
+    /// Remove all particles.
+    void clear();
 
-    iterator begin() {
-        return particles.begin();
-    }
-    iterator end() {
-        return particles.end();
-    }
-    const_iterator begin() const {
-        return particles.begin();
-    }
-    const_iterator end() const {
-        return particles.end();
-    }
     size_t num_particles() const {
-        return particles.size();
+        return px.size();
+    }
+    bool empty() const {
+        return px.empty();
     }
 
-    GdColor color;
-    int life;           ///< lifetime. starts from 1000, goes to 0.
-    bool is_new;        ///< New particle set, the coordinates of which must be "normalized" to the cave screen coordinates
-    float size;         ///< Size of the particles.
-    float opacity;      ///< Opacity between 0 and 1. Values close to 1 not recommended.
+    std::vector<float> px, py;          ///< Coordinates
+    std::vector<float> vx, vy;          ///< Speeds
+    std::vector<int> life;              ///< Lifetime. Starts from 1000, goes to 0.
+    std::vector<float> size;            ///< Size of the particles.
+    std::vector<float> opacity;         ///< Opacity between 0 and 1.
+    std::vector<GdColor> color;
 
 private:
-    container particles;
+    size_t num_dropped;                 ///< Number of particles not added because the pool was full.
+
+    void allocate();
 };
 
 #endif
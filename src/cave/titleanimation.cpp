@@ -35,10 +35,12 @@
 #include "cave/cavetypes.hpp"
 #include "cave/titleanimation.hpp"
 
-std::vector<std::unique_ptr<Pixbuf>> get_title_animation_pixbuf(const GdString &title_screen, const GdString &title_screen_scroll, bool one_frame_only, PixbufFactory &pixbuf_factory) {
-    std::vector<std::unique_ptr<Pixbuf>> animation;
-
-    std::unique_ptr<Pixbuf> screen, tile;
+TitleAnimation::TitleAnimation(std::string const &title_screen, std::string const &title_screen_scroll, PixbufFactory &pixbuf_factory)
+    : title_screen(title_screen)
+    , title_screen_scroll(title_screen_scroll)
+    , valid(true)
+    , pixbuf_factory(pixbuf_factory) {
+    std::unique_ptr<Pixbuf> tile;
     try {
         if (title_screen != "")
             screen = pixbuf_factory.create_from_base64(title_screen.c_str());
@@ -46,12 +48,14 @@ std::vector<std::unique_ptr<Pixbuf>> get_title_animation_pixbuf(const GdString &
             tile = pixbuf_factory.create_from_base64(title_screen_scroll.c_str());
     } catch (std::exception &e) {
         gd_message("Caveset is storing an invalid title screen image: %s", e.what());
-        return animation;
+        screen.reset();
+        tile.reset();
+        valid = false;
     }
 
     if (tile.get() != NULL && tile->get_height() > 40) {
         gd_message("Caveset is storing an oversized tile image");
-        tile.release();
+        tile.reset();
     }
 
     /* if no special title image or unable to load that one, load the built-in */
@@ -75,20 +79,51 @@ std::vector<std::unique_ptr<Pixbuf>> get_title_animation_pixbuf(const GdString &
     g_assert(tile->get_height() < 40);
 
     /* create a big image, which is one tile larger than the title image size */
-    std::unique_ptr<Pixbuf> bigone = pixbuf_factory.create(screen->get_width(), screen->get_height() + tile->get_height());
+    bigone = pixbuf_factory.create(screen->get_width(), screen->get_height() + tile->get_height());
     /* and fill it with the tile. use copy(), so pixbuf data is initialized! */
     for (int y = 0; y < screen->get_height() + tile->get_height(); y += tile->get_height())
         for (int x = 0; x < screen->get_width(); x += tile->get_width())
             tile->copy(*bigone, x, y);
 
-    int framenum = one_frame_only ? 1 : tile->get_height();
-    for (int i = 0; i < framenum; i++) {
+    /* the frames themselves are created by get_frame() */
+    frames.resize(tile->get_height());
+}
+
+
+TitleAnimation::~TitleAnimation() = default;
+
+
+bool TitleAnimation::is_for(std::string const &title_screen, std::string const &title_screen_scroll) const {
+    return this->title_screen == title_screen && this->title_screen_scroll == title_screen_scroll;
+}
+
+
+Pixbuf const &TitleAnimation::get_frame(unsigned i) {
+    g_assert(i < frames.size());
+    if (frames[i] == NULL) {
         std::unique_ptr<Pixbuf> frame = pixbuf_factory.create(screen->get_width(), screen->get_height());
         // copy part of the big tiled image
         bigone->copy(0, i, screen->get_width(), screen->get_height(), *frame, 0, 0);
         // and composite it with the title image
         screen->blit(*frame, 0, 0);
-        // copy to array
+        frames[i] = std::move(frame);
+    }
+    return *frames[i];
+}
+
+
+std::vector<std::unique_ptr<Pixbuf>> get_title_animation_pixbuf(const GdString &title_screen, const GdString &title_screen_scroll, bool one_frame_only, PixbufFactory &pixbuf_factory) {
+    std::vector<std::unique_ptr<Pixbuf>> animation;
+
+    TitleAnimation title(title_screen, title_screen_scroll, pixbuf_factory);
+    if (!title.is_valid())
+        return animation;
+
+    unsigned framenum = one_frame_only ? 1 : title.get_frame_count();
+    for (unsigned i = 0; i < framenum; i++) {
+        Pixbuf const &composed = title.get_frame(i);
+        std::unique_ptr<Pixbuf> frame = pixbuf_factory.create(composed.get_width(), composed.get_height());
+        composed.copy(*frame, 0, 0);
         animation.push_back(std::move(frame));
     }
 
@@ -96,13 +131,13 @@ std::vector<std::unique_ptr<Pixbuf>> get_title_animation_pixbuf(const GdString &
 }
 
 std::vector<std::unique_ptr<Pixmap>> get_title_animation_pixmap(const GdString &title_screen, const GdString &title_screen_scroll, bool one_frame_only, Screen &screen, PixbufFactory &pixbuf_factory) {
-    std::vector<std::unique_ptr<Pixbuf>> pixbufs = get_title_animation_pixbuf(title_screen, title_screen_scroll, one_frame_only, pixbuf_factory);
-    if (pixbufs.empty())
-        pixbufs = get_title_animation_pixbuf(GdString(), GdString(), one_frame_only, pixbuf_factory);
+    /* an invalid title image is replaced by the built-in one */
+    TitleAnimation title(title_screen, title_screen_scroll, pixbuf_factory);
 
     std::vector<std::unique_ptr<Pixmap>> pixmaps;
-    for (unsigned i = 0; i < pixbufs.size(); ++i)
-        pixmaps.push_back(screen.create_scaled_pixmap_from_pixbuf(*pixbufs[i], false));
+    unsigned framenum = one_frame_only ? 1 : title.get_frame_count();
+    for (unsigned i = 0; i < framenum; ++i)
+        pixmaps.push_back(screen.create_scaled_pixmap_from_pixbuf(title.get_frame(i), false));
 
     return pixmaps;
 }
@@ -28,6 +28,7 @@
 
 #include <vector>
 #include <memory>
+#include <string>
 
 class Pixbuf;
 class Pixmap;
@@ -35,6 +36,39 @@ class Screen;
 class GdString;
 class PixbufFactory;
 
+/**
+ * The title screen animation of a caveset.
+ * The title images are decoded once, when the object is created; the frames
+ * are composed from them only when first asked for, and then kept.
+ * If the images stored in the caveset are invalid, the built-in ones are used.
+ */
+class TitleAnimation {
+public:
+    TitleAnimation(std::string const &title_screen, std::string const &title_screen_scroll, PixbufFactory &pixbuf_factory);
+    ~TitleAnimation();
+    /// True, if the animation was created from these title images.
+    bool is_for(std::string const &title_screen, std::string const &title_screen_scroll) const;
+    /// False, if the images of the caveset could not be decoded, and the built-in ones are shown instead.
+    bool is_valid() const {
+        return valid;
+    }
+    /// The number of frames, which is the height of the tile scrolling under the title image.
+    unsigned get_frame_count() const {
+        return frames.size();
+    }
+    /// Get a frame of the animation, composing it if not done yet.
+    Pixbuf const &get_frame(unsigned i);
+
+private:
+    std::string title_screen, title_screen_scroll;
+    bool valid;
+    PixbufFactory &pixbuf_factory;
+    std::unique_ptr<Pixbuf> screen;
+    /// The scrolling tile repeated, one tile larger than the title image.
+    std::unique_ptr<Pixbuf> bigone;
+    std::vector<std::unique_ptr<Pixbuf>> frames;
+};
+
 /**
  * Create and return an array of pixbufs, which contain the title animation, or the first frame only.
  * Up to the caller to delete the pixbufs!
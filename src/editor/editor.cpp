@@ -30,6 +30,7 @@
 #include <algorithm>
 #include <memory>
 #include <glib/gi18n.h>
+#include <glib/gstdio.h>
 
 #include "cave/caverendered.hpp"
 #include "gtk/gtkui.hpp"
@@ -54,6 +55,8 @@
 #include "cave/titleanimation.hpp"
 #include "misc/helptext.hpp"
 #include "mainwindow.hpp"
+#include "gfx/pngwriter.hpp"
+#include "fileops/bdcffsave.hpp"
 
 #include "cave/object/caveobjectboundaryfill.hpp"
 #include "cave/object/caveobjectcopypaste.hpp"
@@ -1520,6 +1523,190 @@ CaveStored *icon_view_get_selected_cave() {
 }
 
 
+/* THUMBNAILS
+ * the caves are rendered by worker threads; the thumbnails are drawn in the gui thread,
+ * as the cell renderer is shared. the thumbnails are also saved to the user's cache directory,
+ * named after a hash of the cave. if the file is there, the worker thread just loads it. */
+struct ThumbnailJob {
+    CaveStored const *cave;     ///< the cave in the caveset, only used to find it again
+    CaveStored copy;            ///< the copy which is rendered, as the original can be edited meanwhile
+    std::string key;
+    std::string filename;
+    GdkPixbuf *pixbuf;          ///< loaded from the cache
+    std::unique_ptr<CaveRendered> rendered;     ///< if not found in the cache
+
+    explicit ThumbnailJob(CaveStored const *cave) : cave(cave), copy(*cave), pixbuf(NULL) {}
+};
+
+static GMutex thumbnail_mutex;
+static std::vector<std::unique_ptr<ThumbnailJob>> thumbnails_done;
+static std::set<CaveStored const *> thumbnails_pending;
+
+
+/* the hash of everything the thumbnail depends on. */
+static std::string thumbnail_key(CaveStored const &cave) {
+    static CaveStored const default_values;
+    std::list<std::string> lines;
+    save_properties(lines, cave, default_values, cave.w * cave.h, cave.get_description_array());
+    if (!cave.map.empty()) {
+        std::string map;
+        for (int y = 0; y < cave.h; ++y)
+            for (int x = 0; x < cave.w; ++x)
+                map += Printf("%d,", int(cave.map(x, y)));
+        lines.push_back(map);
+    }
+    for (auto it = cave.objects.cbegin(); it != cave.objects.cend(); ++it) {
+        CaveObject const &obj = *it;
+        std::string levels;
+        for (int i = 0; i < 5; ++i)
+            levels += obj.seen_on[i] ? '1' : '0';
+        lines.push_back(levels + obj.get_bdcff());
+    }
+    /* the colors as drawn, as the c64 and atari colors depend on the palette settings */
+    std::string colors;
+    for (GdColor const *color : {&cave.colorb, &cave.color0, &cave.color1, &cave.color2, &cave.color3, &cave.color4, &cave.color5}) {
+        unsigned char r, g, b;
+        color->get_rgb(r, g, b);
+        colors += Printf("%d,%d,%d ", int(r), int(g), int(b));
+    }
+    lines.push_back(colors);
+    /* version of the thumbnails, the contents of the theme and the cell size */
+    lines.push_back(Printf("3 %s %d", editor_cell_renderer->get_theme_digest(), editor_cell_renderer->get_cell_pixbuf_size()));
+
+    GChecksum *checksum = g_checksum_new(G_CHECKSUM_SHA1);
+    for (auto const &line : lines) {
+        g_checksum_update(checksum, reinterpret_cast<guchar const *>(line.c_str()), line.size());
+        g_checksum_update(checksum, reinterpret_cast<guchar const *>("\n"), 1);
+    }
+    std::string key = g_checksum_get_string(checksum);
+    g_checksum_free(checksum);
+    return key;
+}
+
+
+static std::string thumbnail_cache_dir() {
+    return gd_tostring_free(g_build_path(G_DIR_SEPARATOR_S, g_get_user_cache_dir(), PACKAGE, "thumbnails", NULL));
+}
+
+
+/* set to false if the thumbnails cannot be saved, so it is not tried again and again. */
+static bool thumbnail_cache_writable = true;
+
+
+static gboolean thumbnails_deliver(gpointer data);
+static void icon_view_update_pixbufs();
+
+static void thumbnail_thread_func(gpointer data, gpointer) {
+    ThumbnailJob *job = static_cast<ThumbnailJob *>(data);
+    job->pixbuf = gdk_pixbuf_new_from_file(job->filename.c_str(), NULL);
+    if (job->pixbuf != NULL)
+        g_utime(job->filename.c_str(), NULL);   /* the cache is pruned by the modification time */
+    else
+        job->rendered = std::make_unique<CaveRendered>(job->copy, 0, 0); /* render at level 1, seed=0 */
+
+    g_mutex_lock(&thumbnail_mutex);
+    bool first = thumbnails_done.empty();
+    thumbnails_done.push_back(std::unique_ptr<ThumbnailJob>(job));
+    g_mutex_unlock(&thumbnail_mutex);
+    if (first)
+        g_idle_add_full(G_PRIORITY_LOW, thumbnails_deliver, NULL, NULL);
+}
+
+
+/* start rendering the thumbnail of a cave, if not already rendering. */
+static void thumbnail_request(CaveStored const *cave) {
+    static GThreadPool *pool = NULL;
+    if (pool == NULL) {
+        /* the thumbnails of the caves not seen for long, or edited since, are deleted */
+        gd_prune_cache_dir(thumbnail_cache_dir(), 2000, 30);
+        pool = g_thread_pool_new(thumbnail_thread_func, NULL, g_get_num_processors(), FALSE, NULL);
+    }
+
+    g_mutex_lock(&thumbnail_mutex);
+    bool pending = !thumbnails_pending.insert(cave).second;
+    g_mutex_unlock(&thumbnail_mutex);
+    if (pending)
+        return;
+
+    ThumbnailJob *job = new ThumbnailJob(cave);
+    job->key = thumbnail_key(*cave);
+    job->filename = gd_tostring_free(g_build_path(G_DIR_SEPARATOR_S, thumbnail_cache_dir().c_str(), (job->key + ".png").c_str(), NULL));
+    g_thread_pool_push(pool, job, NULL);
+}
+
+
+/* takes the thumbnails rendered by the threads, and puts them in the hash table. */
+static gboolean thumbnails_deliver(gpointer data) {
+    static PngWriter cache_writer(6);
+    /* drawing takes time, so a few thumbnails at a time */
+    static unsigned const max_delivered = 10;
+    /* if images were given to the writer, and not yet checked for errors */
+    static bool saved = false;
+
+    std::vector<std::unique_ptr<ThumbnailJob>> jobs;
+    g_mutex_lock(&thumbnail_mutex);
+    unsigned n = std::min<size_t>(max_delivered, thumbnails_done.size());
+    for (unsigned i = 0; i < n; ++i)
+        jobs.push_back(std::move(thumbnails_done[i]));
+    thumbnails_done.erase(thumbnails_done.begin(), thumbnails_done.begin() + n);
+    bool more = !thumbnails_done.empty();
+    for (auto const &job : jobs)
+        thumbnails_pending.erase(job->cave);
+    g_mutex_unlock(&thumbnail_mutex);
+
+    for (auto &job : jobs) {
+        /* the editor might be closed, or the cave deleted or edited since. then the thumbnail is not needed. */
+        bool valid = gd_editor_window != NULL;
+        if (valid) {
+            valid = false;
+            for (unsigned i = 0; i < caveset->caves.size(); ++i)
+                if (&caveset->caves[i] == job->cave)
+                    valid = true;
+        }
+        if (valid)
+            valid = thumbnail_key(*job->cave) == job->key;
+        if (!valid) {
+            if (job->pixbuf)
+                g_object_unref(job->pixbuf);
+            continue;
+        }
+
+        GdkPixbuf *pixbuf = job->pixbuf;
+        if (!pixbuf) {
+            pixbuf = gd_drawcave_to_pixbuf(*job->rendered, *editor_cell_renderer, 128, 128, true, true); /* draw 128x128 icons at max */
+            if (thumbnail_cache_writable) {
+                g_mkdir_with_parents(thumbnail_cache_dir().c_str(), 0700);
+                cache_writer.save(job->filename, gdk_pixbuf_get_width(pixbuf), gdk_pixbuf_get_height(pixbuf),
+                                  gdk_pixbuf_get_n_channels(pixbuf), gdk_pixbuf_get_pixels(pixbuf), gdk_pixbuf_get_rowstride(pixbuf));
+                saved = true;
+            }
+        }
+        if (!job->cave->selectable) {
+            GdkPixbuf *colored = gdk_pixbuf_composite_color_simple(pixbuf, gdk_pixbuf_get_width(pixbuf), gdk_pixbuf_get_height(pixbuf), GDK_INTERP_NEAREST, 160, 1, gd_flash_color.get_uint_0rgb(), gd_flash_color.get_uint_0rgb());
+            g_object_unref(pixbuf); /* forget original */
+            pixbuf = colored;
+        }
+        g_hash_table_insert(cave_pixbufs, const_cast<CaveStored *>(job->cave), pixbuf);
+    }
+
+    /* when all are delivered, check if they could be saved. the errors are reported here,
+     * in the gui thread, and only once; the thumbnails are not saved after an error. */
+    if (saved && !more) {
+        std::string errors;
+        saved = false;
+        if (!cache_writer.wait(&errors)) {
+            gd_warning("cannot save thumbnails to the cache: %s", errors);
+            thumbnail_cache_writable = false;
+        }
+    }
+
+    /* show the new thumbnails, and request them again for the caves edited meanwhile */
+    if (gd_editor_window != NULL && !jobs.empty())
+        icon_view_update_pixbufs();
+    return more;
+}
+
+
 static gboolean
 icon_view_update_pixbufs_timeout(gpointer data) {
     /* if no icon view found, remove interrupt. */
@@ -1529,41 +1716,28 @@ icon_view_update_pixbufs_timeout(gpointer data) {
     GtkTreeModel *model = gtk_icon_view_get_model(GTK_ICON_VIEW(iconview_cavelist));
     GtkTreePath *path = gtk_tree_path_new_first();
 
-    /* render a maximum of 5 pixbufs at a time */
-    int created = 0;
+    /* the thumbnails are rendered by the threads; here we only request them,
+     * and put the ones already rendered in the icon view. */
     GtkTreeIter iter;
-    gboolean finish;
-    while (created < 5 && (finish = gtk_tree_model_get_iter(model, &iter, path))) {
+    while (gtk_tree_model_get_iter(model, &iter, path)) {
         int cave_idx;
         GdkPixbuf *pixbuf_in_icon_view;
         gtk_tree_model_get(model, &iter, CAVE_COLUMN, &cave_idx, PIXBUF_COLUMN, &pixbuf_in_icon_view, -1);
         CaveStored *cave = &caveset->caves[cave_idx];
 
-        /* if we have no pixbuf, generate one. */
+        /* if we have no pixbuf, request one. */
         GdkPixbuf *pixbuf = (GdkPixbuf *) g_hash_table_lookup(cave_pixbufs, cave);
-        if (!pixbuf) {
-            pixbuf_in_icon_view = NULL; /* to force update below */
-            CaveRendered rendered(*cave, 0, 0); /* render at level 1, seed=0 */
-            pixbuf = gd_drawcave_to_pixbuf(rendered, *editor_cell_renderer, 128, 128, true, true); /* draw 128x128 icons at max */
-            if (!cave->selectable) {
-                GdkPixbuf *colored = gdk_pixbuf_composite_color_simple(pixbuf, gdk_pixbuf_get_width(pixbuf), gdk_pixbuf_get_height(pixbuf), GDK_INTERP_NEAREST, 160, 1, gd_flash_color.get_uint_0rgb(), gd_flash_color.get_uint_0rgb());
-                g_object_unref(pixbuf); /* forget original */
-                pixbuf = colored;
-            }
-            g_hash_table_insert(cave_pixbufs, cave, pixbuf);
-
-            created++;  /* created at least one, it took time */
-        }
-
-        /* if generated a new pixbuf, or the icon view does not contain the pixbuf: */
-        if (pixbuf != pixbuf_in_icon_view)
+        if (!pixbuf)
+            thumbnail_request(cave);
+        /* if the icon view does not contain the pixbuf: */
+        else if (pixbuf != pixbuf_in_icon_view)
             gtk_list_store_set(GTK_LIST_STORE(model), &iter, PIXBUF_COLUMN, pixbuf, -1);
 
         gtk_tree_path_next(path);
     }
     gtk_tree_path_free(path);
 
-    return finish;
+    return FALSE;
 }
 
 static void
@@ -1990,7 +2164,7 @@ save_cave_png(GdkPixbuf *pixbuf) {
     gtk_file_chooser_set_current_name(GTK_FILE_CHOOSER(dialog), Printf("%s.png", edited_cave().name).c_str());
     gtk_file_chooser_set_do_overwrite_confirmation(GTK_FILE_CHOOSER(dialog), TRUE);
 
-    GError *error = NULL;
+    std::string error;
     if (gtk_dialog_run(GTK_DIALOG(dialog)) == GTK_RESPONSE_ACCEPT) {
         char *filename = gtk_file_chooser_get_filename(GTK_FILE_CHOOSER(dialog));
         if (!g_str_has_suffix(filename, ".png")) {
@@ -1999,13 +2173,15 @@ save_cave_png(GdkPixbuf *pixbuf) {
             filename = suffixed;
         }
 
-        gdk_pixbuf_save(pixbuf, filename , "png", &error, "compression", "9", NULL);
+        /* a single image; wait for it, so the error can be shown */
+        PngWriter png_writer(gd_png_compression);
+        png_writer.save(filename, gdk_pixbuf_get_width(pixbuf), gdk_pixbuf_get_height(pixbuf),
+                        gdk_pixbuf_get_n_channels(pixbuf), gdk_pixbuf_get_pixels(pixbuf), gdk_pixbuf_get_rowstride(pixbuf));
+        png_writer.wait(&error);
         g_free(filename);
     }
-    if (error) {
-        gd_errormessage(error->message, NULL);
-        g_error_free(error);
-    }
+    if (!error.empty())
+        gd_errormessage(error.c_str(), NULL);
     gtk_widget_destroy(dialog);
 }
 
@@ -26,6 +26,8 @@
 #include <glib.h>
 #include <gtk/gtk.h>
 #include <glib/gi18n.h>
+#include <memory>
+#include <vector>
 
 #include "editor/exporthtml.hpp"
 #include "cave/cavetypes.hpp"
@@ -38,6 +40,65 @@
 #include "editor/editorcellrenderer.hpp"
 #include "gtk/gtkpixbuffactory.hpp"
 #include "gtk/gtkpixbuf.hpp"
+#include "gfx/pngwriter.hpp"
+#include "misc/util.hpp"
+
+
+/* renders all caves of the caveset with seed=0, using all processors. */
+static std::vector<std::unique_ptr<CaveRendered>> render_caves(CaveSet &caveset) {
+    std::vector<std::unique_ptr<CaveRendered>> rendered(caveset.caves.size());
+    gd_parallel_for(rendered.size(), [&](int i) {
+        rendered[i] = std::make_unique<CaveRendered>(caveset.caves[i], 0, 0);
+    });
+    return rendered;
+}
+
+
+/* a hash of everything the image of the cave depends on. it is stored in a file
+ * next to the png, so the image is only drawn and saved again if it changed. */
+static std::string cave_image_hash(CaveRendered const &cave, int cell_size, std::string const &theme_digest) {
+    std::vector<guint32> data;
+    data.push_back(2);      /* version of the image, to be increased if gd_drawcave_to_pixbuf changes */
+    data.push_back(cell_size);
+    data.push_back(cave.x1);
+    data.push_back(cave.y1);
+    data.push_back(cave.x2);
+    data.push_back(cave.y2);
+    data.push_back(cave.dirt_looks_like);
+    data.push_back(cave.expanding_wall_looks_like);
+    data.push_back(cave.amoeba_2_looks_like);
+    for (GdColor const *color : {&cave.color0, &cave.color1, &cave.color2, &cave.color3, &cave.color4, &cave.color5}) {
+        unsigned char r, g, b;
+        color->get_rgb(r, g, b);
+        data.push_back(r << 16 | g << 8 | b);
+    }
+    for (int y = cave.y1; y <= cave.y2; y++)
+        for (int x = cave.x1; x <= cave.x2; x++)
+            data.push_back(cave.map(x, y));
+
+    GChecksum *checksum = g_checksum_new(G_CHECKSUM_SHA1);
+    g_checksum_update(checksum, reinterpret_cast<guchar const *>(data.data()), data.size() * sizeof(data[0]));
+    g_checksum_update(checksum, reinterpret_cast<guchar const *>(theme_digest.c_str()), theme_digest.size());
+    std::string hash = g_checksum_get_string(checksum);
+    g_checksum_free(checksum);
+    return hash;
+}
+
+
+/* checks if the png file exists, and was saved from the same data. if so, returns its size, too. */
+static bool image_up_to_date(std::string const &imagename, std::string const &hash, int &width, int &height) {
+    std::string pngname = imagename + ".png", hashname = imagename + ".hash";
+    if (!g_file_test(pngname.c_str(), G_FILE_TEST_IS_REGULAR))
+        return false;
+    char *contents;
+    if (!g_file_get_contents(hashname.c_str(), &contents, NULL, NULL))
+        return false;
+    char stored[64];
+    bool up_to_date = sscanf(contents, "%63s %d %d", stored, &width, &height) == 3 && hash == stored;
+    g_free(contents);
+    return up_to_date;
+}
+
 
 /**
  * Save caveset as html gallery.
@@ -74,6 +135,10 @@ void gd_save_html(char *htmlname, CaveSet &caveset) {
 
     // CAVESET DATA
     contents += Printf("<H1>%ms</H1>\n", caveset.name);
+    /* the images are compressed by the writer threads, while the next caves are drawn */
+    PngWriter png_writer(gd_png_compression);
+    /* the hash files of the images saved; written only after the images are */
+    std::vector<std::pair<std::string, std::string>> new_hashes;
     /* if the game has its own title screen */
     if (caveset.title_screen != "") {
         GTKPixbufFactory pf;
@@ -83,17 +148,18 @@ void gd_save_html(char *htmlname, CaveSet &caveset) {
         if (!title_images.empty()) {
             GdkPixbuf *title_image = static_cast<GTKPixbuf &>(*title_images[0]).get_gdk_pixbuf();
 
-            char *pngname = g_strdup_printf("%s_%03d.png", pngoutbasename, 0); /* it is the "zeroth" image */
-            GError *error = NULL;
-            gdk_pixbuf_save(title_image, pngname, "png", &error, "compression", "9", NULL);
-            if (error) {
-                gd_warning(error->message);
-                g_error_free(error);
-                error = NULL;
+            std::string imagename = gd_tostring_free(g_strdup_printf("%s_%03d", pngoutbasename, 0)); /* it is the "zeroth" image */
+            std::string hash = gd_tostring_free(g_compute_checksum_for_string(G_CHECKSUM_SHA1, (caveset.title_screen + caveset.title_screen_scroll).c_str(), -1));
+            int width, height;
+            if (!image_up_to_date(imagename, hash, width, height)) {
+                width = gdk_pixbuf_get_width(title_image);
+                height = gdk_pixbuf_get_height(title_image);
+                png_writer.save(imagename + ".png", width, height,
+                                gdk_pixbuf_get_n_channels(title_image), gdk_pixbuf_get_pixels(title_image), gdk_pixbuf_get_rowstride(title_image));
+                new_hashes.push_back(std::make_pair(imagename + ".hash", Printf("%s %d %d\n", hash, width, height)));
             }
-            g_free(pngname);
 
-            contents += Printf("<IMAGE SRC=\"%s_%03d.png\" WIDTH=\"%d\" HEIGHT=\"%d\">\n", pngbasename, 0, gdk_pixbuf_get_width(title_image), gdk_pixbuf_get_height(title_image));
+            contents += Printf("<IMAGE SRC=\"%s_%03d.png\" WIDTH=\"%d\" HEIGHT=\"%d\">\n", pngbasename, 0, width, height);
             contents += "<BR>\n";
         }
     }
@@ -125,10 +191,11 @@ void gd_save_html(char *htmlname, CaveSet &caveset) {
     GTKPixbufFactory pf;
     GTKScreen screen(pf, NULL);
     EditorCellRenderer cr(screen, gd_theme);
+    /* rendering caves for png: seed=0 */
+    std::vector<std::unique_ptr<CaveRendered>> rendered_caves = render_caves(caveset);
     for (unsigned i = 0; i < caveset.caves.size(); i++) {
-        /* rendering cave for png: seed=0 */
         CaveStored &cave = caveset.caves[i];
-        CaveRendered rendered(cave, 0, 0);
+        CaveRendered const &rendered = *rendered_caves[i];
 
         /* check cave to see if we have amoeba or magic wall. properties will be shown in html, if so. */
         bool has_amoeba = false, has_magic = false;
@@ -144,18 +211,21 @@ void gd_save_html(char *htmlname, CaveSet &caveset) {
         /* cave header */
         contents += Printf("<A NAME=\"cave%03d\"></A>\n<H2>%ms</H2>\n", i + 1, cave.name);
 
-        /* save image */
-        char *pngname = g_strdup_printf("%s_%03d.png", pngoutbasename, i + 1);
-        GdkPixbuf *pixbuf = gd_drawcave_to_pixbuf(rendered, cr, 0, 0, true, false);
-        gdk_pixbuf_save(pixbuf, pngname, "png", &error, "compression", "9", NULL);
-        if (error) {
-            gd_warning(error->message);
-            g_error_free(error);
-            error = NULL;
+        /* save image, if not already there */
+        std::string imagename = gd_tostring_free(g_strdup_printf("%s_%03d", pngoutbasename, i + 1));
+        std::string hash = cave_image_hash(rendered, cr.get_cell_pixbuf_size(), cr.get_theme_digest());
+        int width, height;
+        if (!image_up_to_date(imagename, hash, width, height)) {
+            GdkPixbuf *pixbuf = gd_drawcave_to_pixbuf(rendered, cr, 0, 0, true, false);
+            width = gdk_pixbuf_get_width(pixbuf);
+            height = gdk_pixbuf_get_height(pixbuf);
+            png_writer.save(imagename + ".png", width, height,
+                            gdk_pixbuf_get_n_channels(pixbuf), gdk_pixbuf_get_pixels(pixbuf), gdk_pixbuf_get_rowstride(pixbuf));
+            g_object_unref(pixbuf);
+            new_hashes.push_back(std::make_pair(imagename + ".hash", Printf("%s %d %d\n", hash, width, height)));
         }
-        g_free(pngname);
-        contents += Printf("<IMAGE SRC=\"%s_%03d.png\" WIDTH=\"%d\" HEIGHT=\"%d\">\n", pngbasename, i + 1, gdk_pixbuf_get_width(pixbuf), gdk_pixbuf_get_height(pixbuf));
-        g_object_unref(pixbuf);
+        rendered_caves[i].reset();
+        contents += Printf("<IMAGE SRC=\"%s_%03d.png\" WIDTH=\"%d\" HEIGHT=\"%d\">\n", pngbasename, i + 1, width, height);
 
         contents += "<BR>\n";
         contents += "<TABLE>\n";
@@ -192,4 +262,10 @@ void gd_save_html(char *htmlname, CaveSet &caveset) {
         gd_critical(error->message);
         g_error_free(error);
     }
+    /* the errors of the images are logged. if some of them could not be saved,
+     * no hash is written, so all of them are saved again next time. */
+    if (png_writer.wait()) {
+        for (auto const &hashfile : new_hashes)
+            g_file_set_contents(hashfile.first.c_str(), hashfile.second.c_str(), -1, NULL);
+    }
 }
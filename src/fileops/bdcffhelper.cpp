@@ -23,6 +23,8 @@
 
 #include "config.h"
 
+#include <glib.h>
+#include <cstring>
 #include <iomanip>
 #include <stdexcept>
 #include "fileops/bdcffhelper.hpp"
@@ -40,6 +42,51 @@ AttribParam::AttribParam(const std::string &str, char separator) {
 }
 
 
+/// Constructor: split a line of a BDCFF file in memory.
+/// @param line The line to split.
+/// @param separator Separator between attrib and param; default is =.
+AttribParam::AttribParam(BdcffLine const &line, char separator) {
+    size_t equal = line.find(separator);
+    if (equal == std::string::npos)
+        throw std::runtime_error(Printf("No separator in line: '%s'", line.str()));
+    attrib.assign(line.data(), equal);
+    param.assign(line.data() + equal + 1, line.size() - equal - 1);
+}
+
+
+size_t BdcffLine::find(char c) const {
+    void const *found = memchr(text, c, length);
+    return found ? static_cast<char const *>(found) - text : std::string::npos;
+}
+
+
+bool BdcffLine::caseequal(char const *str) const {
+    return strlen(str) == length && g_ascii_strncasecmp(text, str, length) == 0;
+}
+
+
+bool BdcffLine::has_prefix(char const *prefix) const {
+    size_t prefixlen = strlen(prefix);
+    return prefixlen <= length && g_ascii_strncasecmp(text, prefix, prefixlen) == 0;
+}
+
+
+bool BdcffLine::has_attrib(std::string const &attrib) const {
+    return attrib.size() < length && text[attrib.size()] == '='
+           && g_ascii_strncasecmp(text, attrib.c_str(), attrib.size()) == 0;
+}
+
+
+void BdcffLine::strip() {
+    while (length > 0 && text[0] == ' ') {
+        ++text;
+        --length;
+    }
+    while (length > 0 && text[length - 1] == ' ')
+        --length;
+}
+
+
 /// Create a new formatter.
 /// @param F The name of the output string; for example
 ///         give it "Point" if intending to write a line like "Point=1 2 DIRT"
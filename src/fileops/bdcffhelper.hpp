@@ -52,6 +52,46 @@ public:
 };
 
 
+/**
+ * A line of a BDCFF file loaded in memory.
+ * The text is not copied; the object points into the buffer of the file,
+ * so the buffer must live longer than the lines. Like a C++17 string_view.
+ */
+class BdcffLine {
+    char const *text;
+    size_t length;
+public:
+    BdcffLine(char const *text_, size_t length_) : text(text_), length(length_) {
+    }
+    char const *data() const {
+        return text;
+    }
+    size_t size() const {
+        return length;
+    }
+    bool empty() const {
+        return length == 0;
+    }
+    char operator[](size_t i) const {
+        return text[i];
+    }
+    /// Create a copy of the line as an std::string.
+    std::string str() const {
+        return std::string(text, length);
+    }
+    /// Position of the first occurrence of the character, or std::string::npos.
+    size_t find(char c) const;
+    /// Check if equal to the string; the check is case-insensitive.
+    bool caseequal(char const *str) const;
+    /// Check if the line starts with the string; the check is case-insensitive.
+    bool has_prefix(char const *prefix) const;
+    /// Check if the line is an attrib=param line for the attrib given, like HasAttrib.
+    bool has_attrib(std::string const &attrib) const;
+    /// Remove spaces from the beginning and the end, like gd_strchomp().
+    void strip();
+};
+
+
 /// A class which splits a BDCFF line read
 /// into two parts - an attribute name and parameters.
 /// For example, "SlimePermeability=0.1" is split into
@@ -61,6 +101,7 @@ public:
     std::string attrib;
     std::string param;
     explicit AttribParam(const std::string &str, char separator = '=');
+    explicit AttribParam(BdcffLine const &line, char separator = '=');
 };
 
 /**
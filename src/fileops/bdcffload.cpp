@@ -24,6 +24,8 @@
 #include "config.h"
 
 #include <glib.h>
+#include <cstring>
+#include <vector>
 
 #include "fileops/bdcffload.hpp"
 
@@ -338,21 +340,45 @@ static bool cave_process_tags_func(CaveStored &cave, const std::string &attrib,
     return struct_set_own_property(cave, attrib, param, cave.w * cave.h);
 }
 
+/**
+ * The sections of a BDCFF file being loaded.
+ * Like BdcffFile, but the lines point into the buffer of the file instead of being copies.
+ */
+struct BdcffFileLines {
+    typedef std::vector<BdcffLine> Section;
+    struct CaveInfo {
+        Section highscore;
+        Section properties;
+        Section map;
+        Section objects;
+        std::vector<Section> replays;
+        std::vector<std::string> demo;
+    };
+
+    Section bdcff;
+    Section highscore;
+    Section mapcodes;
+    Section caveset_properties;
+    std::vector<CaveInfo> caves;
+};
+
 /// process a given cave property (by its name) - and do nothing, if no such property exists.
 /// this function helps processing some cave tags in advance.
 /// @param cave The cave to process the tag for.
 /// @param lines The list of lines to find the attrib in.
 /// @param name The name of the attribute to find.
 /// @return true, if the property is found. If found, it is also processed and removed.
-static bool cave_process_specific_tag(CaveStored &cave, BdcffFile::BdcffSection &lines, const std::string &name) {
-    auto it = find_if(lines.begin(), lines.end(), HasAttrib(name));
+static bool cave_process_specific_tag(CaveStored &cave, BdcffFileLines::Section &lines, const std::string &name) {
+    auto it = find_if(lines.begin(), lines.end(), [&name](BdcffLine const &line) {
+        return line.has_attrib(name);
+    });
     bool found = it != lines.end();
     if (found) {
         try {
             AttribParam ap(*it);        // split into attrib and param
             cave_process_tags_func(cave, ap.attrib, ap.param);
         } catch (std::exception &e) {
-            gd_warning("Cannot parse: %s", *it);
+            gd_warning("Cannot parse: %s", it->str());
         }
         lines.erase(it);            // erase after processing
     }
@@ -364,7 +390,7 @@ static bool cave_process_specific_tag(CaveStored &cave, BdcffFile::BdcffSection
 /// For example, the name is processed first, to be able to show all error messages with the cave name context.
 /// Then the engine tag is processed - well, because bdcff sucks.
 /// Then the size - to make sure ratios are read correctly - bdcff sucks.
-static void cave_process_all_tags(CaveStored &cave, BdcffFile::BdcffSection &lines) {
+static void cave_process_all_tags(CaveStored &cave, BdcffFileLines::Section &lines) {
     // first check cave name, so we can report errors correctly (saying that CaveStored xy: error foobar)
     cave_process_specific_tag(cave, lines, "Name");
     SetLoggerContextForFunction scf((cave.name == "") ? Printf("<unnamed cave>") : (Printf("Cave '%s'", cave.name)));
@@ -403,11 +429,11 @@ static void cave_process_all_tags(CaveStored &cave, BdcffFile::BdcffSection &lin
             AttribParam ap(*it);
             if (!cave_process_tags_func(cave, ap.attrib, ap.param)) {
                 gd_message("unknown tag '%s'", ap.attrib);
-                cave.unknown_tags += *it;
+                cave.unknown_tags.append(it->data(), it->size());
                 cave.unknown_tags += '\n';
             }
         } catch (std::exception &e) {
-            gd_warning("Cannot parse line: %s", *it);
+            gd_warning("Cannot parse line: %s", it->str());
         }
     }
 }
@@ -426,9 +452,11 @@ static bool add_highscore(HighScoreTable &hs, const std::string &name, const std
     return true;
 }
 
-static BdcffFile parse_bdcff_sections(const char *file_contents) {
-    BdcffFile file;
-    std::istringstream is(file_contents);
+/// Split the file to sections in a single pass. The lines are not copied,
+/// but point into file_contents, which must be kept until the lines are processed.
+/// The contents need not be zero-terminated.
+static BdcffFileLines parse_bdcff_sections(const char *file_contents, size_t length) {
+    BdcffFileLines file;
     enum ReadState {
         Start,          ///< should be nothing here.
         Bdcff,          ///< inside [bdcff], eg. version=0.5
@@ -444,15 +472,19 @@ static BdcffFile parse_bdcff_sections(const char *file_contents) {
         CaveMap         ///< map-encoded cave
     } state;
 
-    std::string line;
     state = Start;
     bool bailout = false;
-    for (int lineno = 1; !bailout && getline(is, line); lineno++) {
-        SetLoggerContextForFunction scf(Printf("Line %d", lineno));
-
-        size_t found_r;
-        while ((found_r = line.find('\r')) != std::string::npos)
-            line.erase(found_r, 1);     /* remove windows-nightmare \r-s */
+    char const *next = file_contents;
+    char const *file_end = file_contents + length;
+    for (int lineno = 1; !bailout && next < file_end; lineno++) {
+        char const *end = static_cast<char const *>(memchr(next, '\n', file_end - next));
+        if (end == NULL)
+            end = file_end;
+        BdcffLine line(next, end - next);
+        next = end < file_end ? end + 1 : end;
+
+        while (!line.empty() && line[line.size() - 1] == '\r')
+            line = BdcffLine(line.data(), line.size() - 1);    /* remove windows-nightmare \r-s */
         if (line.empty())
             continue;                   /* skip empty lines */
 
@@ -461,22 +493,24 @@ static BdcffFile parse_bdcff_sections(const char *file_contents) {
 
         /* STARTING WITH A BRACKET [ IS A SECTION */
         if (line[0] == '[') {
-            if (gd_str_ascii_caseequal(line, "[BDCFF]")) {
+            /* the context is only needed for the messages here, so it is not created for every line */
+            SetLoggerContextForFunction scf(Printf("Line %d", lineno));
+            if (line.caseequal("[BDCFF]")) {
                 if (state != Start) {
                     gd_critical("first section should be [BDCFF]. Bailing out!");
                     bailout = true;
                 }
                 state = Bdcff;
-            } else if (gd_str_ascii_caseequal(line, "[/BDCFF]")) {
+            } else if (line.caseequal("[/BDCFF]")) {
                 state = Start;
-            } else if (gd_str_ascii_caseequal(line, "[game]")) {
+            } else if (line.caseequal("[game]")) {
                 if (state != Bdcff)
                     gd_warning("[game] should be inside [BDCFF]");
                 state = Game;
-            } else if (gd_str_ascii_caseequal(line, "[/game]")) {
+            } else if (line.caseequal("[/game]")) {
                 if (state != Game)
                     gd_warning("[/game] not in [game] section");
-            } else if (gd_str_ascii_caseequal(line, "[mapcodes]")) {
+            } else if (line.caseequal("[mapcodes]")) {
                 switch (state) {
                     case Game:
                         state = GameMapCodes;
@@ -489,7 +523,7 @@ static BdcffFile parse_bdcff_sections(const char *file_contents) {
                         state = BdcffMapCodes;
                         break;
                 }
-            } else if (gd_str_ascii_caseequal(line, "[/mapcodes]")) {
+            } else if (line.caseequal("[/mapcodes]")) {
                 switch (state) {
                     case GameMapCodes:
                         state = Game;
@@ -501,25 +535,25 @@ static BdcffFile parse_bdcff_sections(const char *file_contents) {
                         gd_warning("[/mapcodes] not after [mapcodes]");
                         state = Game;
                 }
-            } else if (gd_str_ascii_caseequal(line, "[cave]")) {
+            } else if (line.caseequal("[cave]")) {
                 if (state != Game)
                     gd_warning("[cave] allowed only in [game] section");
                 state = Cave;
-                file.caves.push_back(BdcffFile::CaveInfo());    /* new empty space for a cave */
-            } else if (gd_str_ascii_caseequal(line, "[/cave]")) {
+                file.caves.push_back(BdcffFileLines::CaveInfo());    /* new empty space for a cave */
+            } else if (line.caseequal("[/cave]")) {
                 if (state != Cave)
                     gd_warning("[/cave] tag without starting [cave]");
                 state = Game;
-            } else if (gd_str_ascii_caseequal(line, "[map]")) {
+            } else if (line.caseequal("[map]")) {
                 if (state != Cave)
                     gd_warning("[map] section only allowed inside [cave]");
                 else    /* else: do not enter map reading when not in a cave! */
                     state = CaveMap;
-            } else if (gd_str_ascii_caseequal(line, "[/map]")) {
+            } else if (line.caseequal("[/map]")) {
                 if (state != CaveMap)
                     gd_warning("[/map] tag without starting [map]");
                 state = Cave;
-            } else if (gd_str_ascii_caseequal(line, "[highscore]")) {
+            } else if (line.caseequal("[highscore]")) {
                 /* can be inside game or cave */
                 if (state == Game)
                     state = GameHighScore;
@@ -529,7 +563,7 @@ static BdcffFile parse_bdcff_sections(const char *file_contents) {
                     gd_critical("[highscore] section only allowed inside [game] and [cave]. This confuses the parser, bailing out!");
                     bailout = true;
                 }
-            } else if (gd_str_ascii_caseequal(line, "[/highscore]")) {
+            } else if (line.caseequal("[/highscore]")) {
                 if (state == GameHighScore)
                     state = Game;
                 else if (state == CaveHighScore)
@@ -538,60 +572,60 @@ static BdcffFile parse_bdcff_sections(const char *file_contents) {
                     gd_critical("[/highscore] only allowed after starting [highscore]. This confuses the parser, bailing out!");
                     bailout = true;
                 }
-            } else if (gd_str_ascii_caseequal(line, "[objects]")) {
+            } else if (line.caseequal("[objects]")) {
                 if (state != Cave)
                     gd_warning("[objects] tag only allowed in [cave]");
                 if (file.caves.empty()) {
                     gd_warning("[replay] tag does not belong to any cave!");
-                    file.caves.push_back(BdcffFile::CaveInfo());
+                    file.caves.push_back(BdcffFileLines::CaveInfo());
                 }
                 state = CaveObjects;
-            } else if (gd_str_ascii_caseequal(line, "[/objects]")) {
+            } else if (line.caseequal("[/objects]")) {
                 if (state != CaveObjects)
                     gd_warning("[/objects] tag without starting [objects] tag");
                 state = Cave;
-            } else if (gd_str_ascii_caseequal(line, "[demo]")) {
+            } else if (line.caseequal("[demo]")) {
                 if (state != Cave)
                     gd_warning("[demo] tag only allowed in [cave]");
                 if (file.caves.empty()) {
                     gd_warning("[demo] tag does not belong to any cave!");
-                    file.caves.push_back(BdcffFile::CaveInfo());
+                    file.caves.push_back(BdcffFileLines::CaveInfo());
                 }
                 state = CaveDemo;
                 file.caves.back().demo.push_back("");   /* push an empty string, lines will be added */
-            } else if (gd_str_ascii_caseequal(line, "[/demo]")) {
+            } else if (line.caseequal("[/demo]")) {
                 if (state != CaveDemo)
                     gd_warning("[/demo] tag without starting [demo] tag");
                 state = Cave;
-            } else if (gd_str_ascii_caseequal(line, "[replay]")) {
+            } else if (line.caseequal("[replay]")) {
                 if (state != Cave)
                     gd_warning("[replay] tag only allowed in [cave]");
                 if (file.caves.empty()) {
                     gd_warning("[replay] tag does not belong to any cave!");
-                    file.caves.push_back(BdcffFile::CaveInfo());
+                    file.caves.push_back(BdcffFileLines::CaveInfo());
                 }
                 state = CaveSReplay;
-                file.caves.back().replays.push_back(BdcffFile::BdcffSection());
-            } else if (gd_str_ascii_caseequal(line, "[/replay]")) {
+                file.caves.back().replays.push_back(BdcffFileLines::Section());
+            } else if (line.caseequal("[/replay]")) {
                 if (state != CaveSReplay)
                     gd_warning("[/replay] tag without starting [replay] tag");
                 state = Cave;
             }
             /* GOSH i hate bdcff */
-            else if (gd_str_ascii_prefix(line, "[level=")) {
+            else if (line.has_prefix("[level=")) {
                 /* dump this thing in the object list. */
                 if (state != CaveObjects)
                     gd_message("[level] tag only allowed inside [objects] section. Ignored.");
                 else
                     file.caves.back().objects.push_back(line);
-            } else if (gd_str_ascii_caseequal(line, "[/level]")) {
+            } else if (line.caseequal("[/level]")) {
                 /* dump this thing in the object list. */
                 if (state != CaveObjects)
                     gd_message("[/level] tag only allowed inside [objects] section. Ignored.");
                 else
                     file.caves.back().objects.push_back(line);
             } else
-                gd_warning("unknown section: \"%s\"", line);
+                gd_warning("unknown section: \"%s\"", line.str());
 
             continue;
         }
@@ -606,13 +640,15 @@ static BdcffFile parse_bdcff_sections(const char *file_contents) {
         }
 
         /* if not a map, we may strip spaces. do it here. */
-        gd_strchomp(line);
+        line.strip();
 
         switch (state) {
-            case Start: /* should be nothing here. */
-                gd_critical("nothing allowed outside [BDCFF]: %s", line);
+            case Start: { /* should be nothing here. */
+                SetLoggerContextForFunction scf(Printf("Line %d", lineno));
+                gd_critical("nothing allowed outside [BDCFF]: %s", line.str());
                 bailout = true;
                 break;
+            }
 
             case Bdcff: /* inside [bdcff], eg. version=0.5 */
                 file.bdcff.push_back(line);
@@ -641,7 +677,8 @@ static BdcffFile parse_bdcff_sections(const char *file_contents) {
 
             case CaveDemo:      /* old styled demo (replay), just movements, no random data & the like */
                 /* does not contain anything to check for! */
-                file.caves.back().demo.back() += line + ' ';
+                file.caves.back().demo.back().append(line.data(), line.size());
+                file.caves.back().demo.back() += ' ';
                 break;
 
             case CaveHighScore: /* highscores for a cave */
@@ -665,9 +702,9 @@ static BdcffFile parse_bdcff_sections(const char *file_contents) {
     return file;
 }
 
-CaveSet load_from_bdcff(const char *contents) {
+CaveSet load_from_bdcff(const char *contents, size_t length) {
     // this may throw, but we do not catch
-    BdcffFile file = parse_bdcff_sections(contents);
+    BdcffFileLines file = parse_bdcff_sections(contents, length);
 
     /* this cave will store the default properties, specified in the [game] section for caves. */
     /* especially the pain-in-the-ass engine tag. */
@@ -735,9 +772,9 @@ CaveSet load_from_bdcff(const char *contents) {
             try {
                 AttribParam ap(*it, ' ');
                 if (!add_highscore(cs.highscore, ap.param, ap.attrib))
-                    gd_message("Invalid highscore: '%s'", *it);
+                    gd_message("Invalid highscore: '%s'", it->str());
             } catch (std::exception &e) {
-                gd_message("Invalid highscore line: '%s'", *it);
+                gd_message("Invalid highscore line: '%s'", it->str());
             }
         }
     }
@@ -760,7 +797,7 @@ CaveSet load_from_bdcff(const char *contents) {
 
     /* PROCESS CAVES */
     /* xxx const iterator cannot be used */
-    for (std::list<BdcffFile::CaveInfo>::iterator it = file.caves.begin(); it != file.caves.end(); ++it) {
+    for (auto it = file.caves.begin(); it != file.caves.end(); ++it) {
         CaveStored cave = default_cave;
 
         cave_process_all_tags(cave, it->properties);
@@ -772,9 +809,9 @@ CaveSet load_from_bdcff(const char *contents) {
                 try {
                     AttribParam ap(*hit, ' ');
                     if (!add_highscore(cave.highscore, ap.param, ap.attrib))
-                        gd_message("Invalid highscore: '%s'", *hit);
+                        gd_message("Invalid highscore: '%s'", hit->str());
                 } catch (std::exception &e) {
-                    gd_message("Invalid highscore line: '%s'", *hit);
+                    gd_message("Invalid highscore line: '%s'", hit->str());
                 }
             }
         }
@@ -812,11 +849,12 @@ CaveSet load_from_bdcff(const char *contents) {
             // [level] tags are badly designed in bdcff, as they are
             // not really "sections", but properties of objects.
             // yet, they are stored in sections. huge fail.
-            if (*oit == "[/Level]") {
+            std::string object = oit->str();
+            if (object == "[/Level]") {
                 for (unsigned n = 0; n < 5; ++n)
                     levels[n] = true;
-            } else if (gd_str_ascii_prefix(*oit, "[Level=")) {
-                std::istringstream is(oit->substr(oit->find('=') + 1));
+            } else if (gd_str_ascii_prefix(object, "[Level=")) {
+                std::istringstream is(object.substr(object.find('=') + 1));
                 for (unsigned n = 0; n < 5; ++n)
                     levels[n] = false;
                 int i;
@@ -833,13 +871,13 @@ CaveSet load_from_bdcff(const char *contents) {
                     is >> c; // read comma
                 }
             } else {
-                auto newobj = CaveObject::create_from_bdcff(*oit);
+                auto newobj = CaveObject::create_from_bdcff(object);
                 if (newobj) {
                     for (unsigned n = 0; n < 5; ++n)
                         newobj->seen_on[n] = levels[n];
                     cave.objects.push_back(std::move(newobj));
                 } else
-                    gd_warning("invalid object specification: %s", *oit);
+                    gd_warning("invalid object specification: %s", object);
             }
         }
 
@@ -855,7 +893,7 @@ CaveSet load_from_bdcff(const char *contents) {
                     AttribParam ap(*lines_it);
                     replay_process_tag(replay, ap.attrib, ap.param);
                 } else
-                    replay_process_tag(replay, "Movements", *lines_it); /* try to interpret it as a bdcff replay */
+                    replay_process_tag(replay, "Movements", lines_it->str()); /* try to interpret it as a bdcff replay */
             }
         }
 
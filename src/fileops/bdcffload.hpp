@@ -26,12 +26,18 @@
 #include "config.h"
 
 #include <string>
+#include <cstddef>
 
 class CaveSet;
 class Reflective;
 struct PropertyDescription;
 
-CaveSet load_from_bdcff(const char *contents);
+/// The version of the BDCFF loader. Increase it when load_from_bdcff(), or the engine
+/// defaults it sets, would load the same file differently; the cavesets cached by an
+/// earlier version are then not used, see caveset_cache_key().
+int const gd_bdcff_loader_version = 1;
+
+CaveSet load_from_bdcff(const char *contents, size_t length);
 
 bool struct_set_property(Reflective &str, const std::string &attrib, const std::string &param, int ratio, PropertyDescription const *prop_desc);
 
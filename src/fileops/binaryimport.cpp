@@ -74,7 +74,7 @@ static void startwith(C64Import::GdCavefileFormat format) {
 
 /* save bd1 caves from memory map */
 /* atari: a boolean value, true if try atari map. */
-static bool try_bd1(std::vector<unsigned char> const &memory, bool atari) {
+static bool try_bd1(unsigned char const *memory, bool atari) {
     /* there are cave pointers at 0x5806. two byte entries pointing to caves. */
     /* their value is relative to 0x582e. */
     /* atari values are 3500 and 3528. */
@@ -178,7 +178,7 @@ static bool try_bd1(std::vector<unsigned char> const &memory, bool atari) {
 
 
 /* save plck caves from c64 memory map */
-static bool try_plck(std::vector<unsigned char> const &memory) {
+static bool try_plck(unsigned char const *memory) {
     SetLoggerContextForFunction context("PLCK import");
     int x, i;
     int has_names = 0;
@@ -355,7 +355,7 @@ static bool try_plck(std::vector<unsigned char> const &memory) {
 
 
 /* save plck caves from atari memory map */
-static bool try_atari_plck(std::vector<unsigned char> const &memory) {
+static bool try_atari_plck(unsigned char const *memory) {
     SetLoggerContextForFunction context("PLCK import Atari");
     int x, i;
     int ok;
@@ -465,7 +465,7 @@ static bool try_atari_plck(std::vector<unsigned char> const &memory) {
 
 
 /* save crazy light caves from memory map */
-static bool try_crli(std::vector<unsigned char> const &memory) {
+static bool try_crli(unsigned char const *memory) {
     SetLoggerContextForFunction context("CrLi import");
 
     startwith(C64Import::GD_FORMAT_CRLI);
@@ -516,7 +516,7 @@ static bool try_crli(std::vector<unsigned char> const &memory) {
     return true;
 }
 
-static bool try_crdr(std::vector<unsigned char> const &memory) {
+static bool try_crdr(unsigned char const *memory) {
     SetLoggerContextForFunction context("CrDr import");
     int i, caves;
 
@@ -594,7 +594,7 @@ static bool try_crdr(std::vector<unsigned char> const &memory) {
 
 
 /* save bd2 caves from memory map */
-static bool try_bd2(std::vector<unsigned char> const &memory, bool atari) {
+static bool try_bd2(unsigned char const *memory, bool atari) {
     const int cavepointers = atari ? 0x86b0 : 0x89b0;
     const int cavecolors = atari ? 0x86d8 : 0x89d8;
     int i;
@@ -735,7 +735,7 @@ static bool try_bd2(std::vector<unsigned char> const &memory, bool atari) {
 
 
 /* save plck caves from memory map */
-static bool try_1stb(std::vector<unsigned char> const &memory) {
+static bool try_1stb(unsigned char const *memory) {
     SetLoggerContextForFunction context("1stB import");
     startwith(C64Import::GD_FORMAT_FIRSTB);
 
@@ -761,19 +761,18 @@ static bool try_1stb(std::vector<unsigned char> const &memory) {
 }
 
 
-/** load memory dump, and fill memory map. returns the memory dump, or throws an exception describing the problem. */
-std::vector<unsigned char> load_memory_dump(unsigned char const *file, size_t length) {
+/** find the 64k memory map in a memory dump file. returns a pointer to it inside the file buffer,
+ * so the file buffer must be kept while using the memory map; or throws an exception describing the problem. */
+unsigned char const *load_memory_dump(unsigned char const *file, size_t length) {
     const unsigned char vicemagic[] = {
         0x56, 0x49, 0x43, 0x45, 0x20, 0x53, 0x6E, 0x61, 0x70, 0x73, 0x68, 0x6F,
         0x74, 0x20, 0x46, 0x69, 0x6C, 0x65, 0x1A, 0x01, 0x00, 0x43, 0x36, 0x34
     };
-    std::vector<unsigned char> memory(65536);
 
-    if (memcmp(vicemagic, file, sizeof(vicemagic)) == 0) {
+    if (length >= 0x80 + 65536 && memcmp(vicemagic, file, sizeof(vicemagic)) == 0) {
         /* FOUND a vice snapshot file. */
         gd_debug("File is a VICE snapshot.");
-        memcpy(&memory[0], file + 0x80, 65536);
-        return memory;
+        return file + 0x80;
     }
 
     /* 65538 bytes: we hope that this is a full-memory map saved by vice. check it. */
@@ -783,16 +782,14 @@ std::vector<unsigned char> load_memory_dump(unsigned char const *file, size_t le
             throw std::runtime_error(
                 "Memory map should begin from address 0000. "
                 "Use save \"filename\" 0 0000 ffff in vice monitor.");
-        memcpy(&memory[0], file + 2, 65536);
         gd_debug("%s looks like a proper VICE memory map.");
-        return memory;
+        return file + 2;
     }
 
     /* or maybe a 64k map saved by atari800. read it. */
     if (length == 65536) {
-        memcpy(&memory[0], file, 65536);
         gd_debug("%s is maybe an atari800 memory map.");
-        return memory;
+        return file;
     }
 
     throw std::runtime_error(
@@ -802,7 +799,7 @@ std::vector<unsigned char> load_memory_dump(unsigned char const *file, size_t le
 }
 
 
-std::vector<unsigned char> gdash_binary_import(std::vector<unsigned char> const &memory) {
+std::vector<unsigned char> gdash_binary_import(unsigned char const *memory) {
     if (try_plck(memory) || try_atari_plck(memory) || try_bd1(memory, false) || try_bd1(memory, true)
             || try_bd2(memory, false) || try_bd2(memory, true) || try_crli(memory) || try_1stb(memory) || try_crdr(memory)) {
         /* write data length in little endian */
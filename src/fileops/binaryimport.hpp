@@ -29,7 +29,7 @@
 #include <vector>
 #include <cstddef>
 
-std::vector<unsigned char> load_memory_dump(unsigned char const *file, size_t length);
-std::vector<unsigned char> gdash_binary_import(std::vector<unsigned char> const &memory);
+unsigned char const *load_memory_dump(unsigned char const *file, size_t length);
+std::vector<unsigned char> gdash_binary_import(unsigned char const *memory);
 
 #endif
@@ -0,0 +1,402 @@
+/*
+ * Copyright (c) 2007-2018, GDash Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "config.h"
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <cstring>
+#include <stdexcept>
+
+#include "fileops/cavesetcache.hpp"
+#include "fileops/loadfile.hpp"
+#include "fileops/bdcffload.hpp"
+#include "cave/caveset.hpp"
+#include "cave/cavestored.hpp"
+#include "cave/helper/cavereplay.hpp"
+#include "cave/object/caveobject.hpp"
+#include "misc/logger.hpp"
+#include "misc/util.hpp"
+#include "settings.hpp"
+
+/*
+ * The binary caveset cache.
+ *
+ * Loading a BDCFF file means parsing text and setting every property through the reflective
+ * machinery. The cavesets loaded are stored in the user cache directory in their memory
+ * representation, so next time they can be read back without any parsing. The file name of
+ * a cache entry is the hash of the BDCFF file contents, the version of the loader, the layout
+ * of the data stored and the settings which affect loading, so the entry of a changed file,
+ * or one cached by a different loader, is simply not found. The entries not used for long
+ * are deleted.
+ *
+ * The cache is only read by the same program on the same machine, so the data is stored
+ * in the native byte order. Cave objects and replay movements are stored as their BDCFF
+ * description, as objects would need a separate format for each of their types, and the
+ * movements are private to the replay class. They are few: for the caves shipped with the
+ * game, parsing them is less than 2% of loading from the cache, which is itself more than
+ * ten times faster than loading the BDCFF files.
+ */
+
+/* increment this if the layout of the cache files changes */
+static guint32 const cache_version = 1;
+/* the number of cache files kept, and the days an unused one is kept for */
+static unsigned const cache_max_files = 300;
+static unsigned const cache_max_days = 60;
+static char const cache_magic[4] = { 'G', 'D', 'C', 'S' };
+
+
+/* writes the data to a string. */
+class CacheWriter {
+public:
+    std::string data;
+
+    template <typename T> void pod(T const &value) {
+        data.append(reinterpret_cast<char const *>(&value), sizeof(value));
+    }
+    void str(std::string const &s) {
+        pod(guint32(s.size()));
+        data.append(s);
+    }
+};
+
+
+/* reads the data written by the CacheWriter. throws if the data is truncated. */
+class CacheReader {
+private:
+    unsigned char const *pos, *end;
+    void check(size_t n) const {
+        if (size_t(end - pos) < n)
+            throw std::runtime_error("truncated caveset cache file");
+    }
+public:
+    CacheReader(unsigned char const *data, size_t length) : pos(data), end(data + length) {}
+
+    template <typename T> void pod(T &value) {
+        check(sizeof(value));
+        memcpy(&value, pos, sizeof(value));
+        pos += sizeof(value);
+    }
+    void str(std::string &s) {
+        guint32 length;
+        pod(length);
+        check(length);
+        s.assign(reinterpret_cast<char const *>(pos), length);
+        pos += length;
+    }
+    bool at_end() const {
+        return pos == end;
+    }
+};
+
+
+/* the value types of the reflective properties have fixed size and no pointers in them,
+ * so they can be stored as they are in memory. the same function both writes and reads them. */
+template <typename ARCHIVE>
+static void transfer_properties(ARCHIVE &ar, Reflective &str, PropertyDescription const *prop_desc) {
+    for (unsigned i = 0; prop_desc[i].identifier != NULL; i++) {
+        std::unique_ptr<GetterBase> const &prop = prop_desc[i].prop;
+
+        switch (prop_desc[i].type) {
+            case GD_TAB:
+            case GD_LABEL:
+                break;
+            case GD_TYPE_STRING:
+            case GD_TYPE_LONGSTRING:
+                ar.str(str.get<GdString>(prop));
+                break;
+            case GD_TYPE_INT:
+                ar.pod(str.get<GdInt>(prop));
+                break;
+            case GD_TYPE_INT_LEVELS:
+                ar.pod(str.get<GdIntLevels>(prop));
+                break;
+            case GD_TYPE_PROBABILITY:
+                ar.pod(str.get<GdProbability>(prop));
+                break;
+            case GD_TYPE_PROBABILITY_LEVELS:
+                ar.pod(str.get<GdProbabilityLevels>(prop));
+                break;
+            case GD_TYPE_BOOLEAN:
+                ar.pod(str.get<GdBool>(prop));
+                break;
+            case GD_TYPE_BOOLEAN_LEVELS:
+                ar.pod(str.get<GdBoolLevels>(prop));
+                break;
+            case GD_TYPE_COORDINATE:
+                ar.pod(str.get<Coordinate>(prop));
+                break;
+            case GD_TYPE_ELEMENT:
+            case GD_TYPE_EFFECT:
+                ar.pod(str.get<GdElement>(prop));
+                break;
+            case GD_TYPE_COLOR:
+                ar.pod(str.get<GdColor>(prop));
+                break;
+            case GD_TYPE_DIRECTION:
+                ar.pod(str.get<GdDirection>(prop));
+                break;
+            case GD_TYPE_SCHEDULING:
+                ar.pod(str.get<GdScheduling>(prop));
+                break;
+        }
+    }
+}
+
+
+static void write_highscore(CacheWriter &w, HighScoreTable const &hs) {
+    w.pod(guint32(hs.size()));
+    for (unsigned i = 0; i < hs.size(); ++i) {
+        w.str(hs[i].name);
+        w.pod(hs[i].score);
+    }
+}
+
+
+static void read_highscore(CacheReader &r, HighScoreTable &hs) {
+    guint32 count;
+    r.pod(count);
+    for (unsigned i = 0; i < count; ++i) {
+        std::string name;
+        int score;
+        r.str(name);
+        r.pod(score);
+        hs.add(name, score);
+    }
+}
+
+
+static void write_cave(CacheWriter &w, CaveStored const &const_cave) {
+    CaveStored &cave = const_cast<CaveStored &>(const_cave);    /* transfer_properties() is for reading, too */
+    transfer_properties(w, cave, cave.get_description_array());
+    transfer_properties(w, cave, CaveStored::cave_statistics_data);
+    write_highscore(w, cave.highscore);
+
+    /* map */
+    w.pod(gint32(cave.map.width()));
+    w.pod(gint32(cave.map.height()));
+    for (int y = 0; y < cave.map.height(); ++y)
+        for (int x = 0; x < cave.map.width(); ++x)
+            w.pod(guint16(cave.map(x, y)));
+
+    /* objects */
+    w.pod(guint32(cave.objects.size()));
+    for (auto const &object : cave.objects) {
+        w.pod(object.get().seen_on);
+        w.str(object.get().get_bdcff());
+    }
+
+    /* replays */
+    w.pod(guint32(cave.replays.size()));
+    for (auto &replay : cave.replays) {
+        transfer_properties(w, replay, replay.get_description_array());
+        w.str(replay.movements_to_bdcff());
+        w.pod(replay.wrong_checksum);
+        w.pod(replay.saved);
+    }
+}
+
+
+static void read_cave(CacheReader &r, CaveStored &cave) {
+    transfer_properties(r, cave, cave.get_description_array());
+    transfer_properties(r, cave, CaveStored::cave_statistics_data);
+    read_highscore(r, cave.highscore);
+
+    /* map */
+    gint32 w, h;
+    r.pod(w);
+    r.pod(h);
+    if (w < 0 || h < 0)
+        throw std::runtime_error("invalid map size in caveset cache file");
+    if (w > 0 && h > 0) {
+        cave.map.set_size(w, h);
+        for (int y = 0; y < h; ++y)
+            for (int x = 0; x < w; ++x) {
+                guint16 element;
+                r.pod(element);
+                if (element >= O_MAX)
+                    throw std::runtime_error("invalid element in caveset cache file");
+                cave.map(x, y) = GdElementEnum(element);
+            }
+    }
+
+    /* objects */
+    guint32 count;
+    r.pod(count);
+    for (unsigned i = 0; i < count; ++i) {
+        GdBoolLevels seen_on;
+        std::string bdcff;
+        r.pod(seen_on);
+        r.str(bdcff);
+        auto object = CaveObject::create_from_bdcff(bdcff);
+        if (!object)
+            throw std::runtime_error("invalid object in caveset cache file");
+        for (unsigned n = 0; n < 5; ++n)
+            object->seen_on[n] = seen_on[n];
+        cave.objects.push_back(std::move(object));
+    }
+
+    /* replays */
+    r.pod(count);
+    for (unsigned i = 0; i < count; ++i) {
+        cave.replays.push_back(CaveReplay());
+        CaveReplay &replay = cave.replays.back();
+        std::string movements;
+        transfer_properties(r, replay, replay.get_description_array());
+        r.str(movements);
+        if (!replay.load_from_bdcff(movements))
+            throw std::runtime_error("invalid replay in caveset cache file");
+        r.pod(replay.wrong_checksum);
+        r.pod(replay.saved);
+    }
+}
+
+
+static std::string cache_dir() {
+    return gd_tostring_free(g_build_path(G_DIR_SEPARATOR_S, g_get_user_cache_dir(), PACKAGE, "cavesets", NULL));
+}
+
+
+static std::string cache_filename(std::string const &key) {
+    return gd_tostring_free(g_build_path(G_DIR_SEPARATOR_S, cache_dir().c_str(), (key + ".bin").c_str(), NULL));
+}
+
+
+/* the identifiers and types of the properties stored, in their order, so a program
+ * with different properties does not use the entries. */
+static void add_properties(std::string &layout, PropertyDescription const *prop_desc) {
+    for (unsigned i = 0; prop_desc[i].identifier != NULL; i++)
+        layout += Printf("%s %d %d\n", prop_desc[i].identifier, int(prop_desc[i].type), prop_desc[i].flags);
+}
+
+
+static std::string const &cache_layout() {
+    static std::string const layout = [] {
+        CaveSet caveset;
+        CaveStored cave;
+        CaveReplay replay;
+        std::string layout;
+        add_properties(layout, caveset.get_description_array());
+        add_properties(layout, cave.get_description_array());
+        add_properties(layout, CaveStored::cave_statistics_data);
+        add_properties(layout, replay.get_description_array());
+        return layout;
+    }();
+    return layout;
+}
+
+
+/**
+ * Calculate the key of the cache entry for a caveset file.
+ * @param contents The contents of the file.
+ * @param length The length of the contents.
+ */
+std::string caveset_cache_key(unsigned char const *contents, size_t length) {
+    GChecksum *checksum = g_checksum_new(G_CHECKSUM_SHA1);
+    g_checksum_update(checksum, contents, length);
+    /* the versions of the loader and the cache, the layout of the data, and the settings used by the loader */
+    std::string extra = Printf("\n%s %d %d %d %d %d", PACKAGE_VERSION, gd_bdcff_loader_version, cache_version, int(O_MAX),
+                               int(length), gd_use_bdcff_highscore ? 1 : 0);
+    g_checksum_update(checksum, reinterpret_cast<guchar const *>(extra.c_str()), extra.size());
+    g_checksum_update(checksum, reinterpret_cast<guchar const *>(cache_layout().c_str()), cache_layout().size());
+    std::string key = g_checksum_get_string(checksum);
+    g_checksum_free(checksum);
+    return key;
+}
+
+
+/**
+ * Load a caveset from the cache.
+ * @param caveset The caveset to fill; it should be newly created.
+ * @param key The key returned by caveset_cache_key().
+ * @return True, if the cache had the caveset. If false, the caveset should be loaded from the file.
+ */
+bool caveset_cache_load(CaveSet &caveset, std::string const &key) {
+    std::string filename = cache_filename(key);
+    if (!g_file_test(filename.c_str(), G_FILE_TEST_IS_REGULAR))
+        return false;
+
+    try {
+        MappedFile file(filename.c_str());
+        CacheReader r(file.data(), file.size());
+        char magic[4];
+        guint32 version;
+        r.pod(magic);
+        r.pod(version);
+        if (memcmp(magic, cache_magic, sizeof(magic)) != 0 || version != cache_version)
+            throw std::runtime_error("not a caveset cache file");
+
+        CaveSet loaded;
+        transfer_properties(r, loaded, loaded.get_description_array());
+        read_highscore(r, loaded.highscore);
+        guint32 count;
+        r.pod(count);
+        for (unsigned i = 0; i < count; ++i) {
+            loaded.caves.push_back(CaveStored());
+            read_cave(r, loaded.caves.back());
+        }
+        if (!r.at_end())
+            throw std::runtime_error("extra data in caveset cache file");
+
+        caveset = std::move(loaded);
+    } catch (std::exception &e) {
+        /* a broken cache entry is simply dropped; the caveset will be loaded from the file. */
+        gd_debug("%s: %s", filename, e.what());
+        g_unlink(filename.c_str());
+        return false;
+    }
+    /* the entries are deleted by their modification time, so this one is kept */
+    g_utime(filename.c_str(), NULL);
+    gd_debug("caveset loaded from cache %s", filename);
+    return true;
+}
+
+
+/**
+ * Store a caveset loaded from a file in the cache.
+ * Failing to save is not an error, the file will be loaded again next time.
+ * @param caveset The caveset loaded.
+ * @param key The key returned by caveset_cache_key().
+ */
+void caveset_cache_save(CaveSet const &caveset, std::string const &key) {
+    CacheWriter w;
+    w.pod(cache_magic);
+    w.pod(cache_version);
+    transfer_properties(w, const_cast<CaveSet &>(caveset), caveset.get_description_array());
+    write_highscore(w, caveset.highscore);
+    w.pod(guint32(caveset.caves.size()));
+    for (auto const &cave : caveset.caves)
+        write_cave(w, cave);
+
+    /* the first time a caveset is saved, the old ones are deleted */
+    static bool pruned = false;
+    if (!pruned) {
+        gd_prune_cache_dir(cache_dir(), cache_max_files, cache_max_days);
+        pruned = true;
+    }
+
+    std::string filename = cache_filename(key);
+    g_mkdir_with_parents(cache_dir().c_str(), 0700);
+    if (!g_file_set_contents(filename.c_str(), w.data.data(), w.data.size(), NULL))
+        gd_debug("cannot save caveset cache %s", filename);
+}
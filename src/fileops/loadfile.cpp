@@ -24,16 +24,20 @@
 #include "fileops/loadfile.hpp"
 
 #include <glib/gi18n.h>
+#include <cstring>
 #include <stdexcept>
-#include <fstream>
+#include <string>
+#include <vector>
 #include "cave/caveset.hpp"
 #include "fileops/binaryimport.hpp"
 #include "fileops/brcimport.hpp"
 #include "fileops/c64import.hpp"
 #include "fileops/bdcffload.hpp"
+#include "fileops/cavesetcache.hpp"
 #include "misc/logger.hpp"
 #include "misc/util.hpp"
 #include "misc/autogfreeptr.hpp"
+#include "misc/printf.hpp"
 
 
 /** load some caveset from the binary data in the buffer.
@@ -70,7 +74,21 @@ CaveSet create_from_buffer(const unsigned char *buffer, int length, char const *
 
     /* try to load as BDCFF */
     if (g_str_has_suffix(filename, ".bd") || g_str_has_suffix(filename, ".BD")) {
-        CaveSet newcaves = load_from_bdcff((char const *) buffer);
+        size_t bdcff_length = length == -1 ? strlen((char const *) buffer) : length;
+        std::string cache_key = caveset_cache_key(buffer, bdcff_length);
+        CaveSet newcaves;
+        if (!caveset_cache_load(newcaves, cache_key)) {
+            Logger::Container const &messages = Logger::get_active_logger().get_messages();
+            size_t messages_before = messages.size();
+            newcaves = load_from_bdcff((char const *) buffer, bdcff_length);
+            /* only cache the caveset if it loaded cleanly, so the warnings are shown every time the file is loaded. */
+            bool clean = true;
+            for (size_t i = messages_before; i < messages.size(); ++i)
+                if (messages[i].sev != ErrorMessage::Debug)
+                    clean = false;
+            if (clean)
+                caveset_cache_save(newcaves, cache_key);
+        }
         newcaves.last_selected_cave = newcaves.first_selectable_cave_index();
         /* remember filename, as the input is a bdcff file */
         if (g_path_is_absolute(filename)) {
@@ -87,7 +105,7 @@ CaveSet create_from_buffer(const unsigned char *buffer, int length, char const *
     /* if could not determine file format so far, try to load as a snapshot file */
     if (g_str_has_suffix(filename, ".vsf") || g_str_has_suffix(filename, ".VSF")
             || length == 65536 || length == 65538) {
-        std::vector<unsigned char> memory = load_memory_dump(buffer, length);
+        unsigned char const *memory = load_memory_dump(buffer, length);
         std::vector<unsigned char> imported = gdash_binary_import(memory);
         return create_from_buffer(&imported[0], imported.size(), filename);
     }
@@ -102,35 +120,42 @@ CaveSet create_from_buffer(const unsigned char *buffer, int length, char const *
  * @return The caveset loaded. If impossible to load, throws an exception.
  */
 CaveSet load_caveset_from_file(const char *filename) {
-    std::vector<unsigned char> contents = load_file_to_vector(filename);
-    /* -1 because the loader adds a terminating zero */
-    return create_from_buffer(&contents[0], contents.size() - 1, filename);
+    MappedFile file(filename);
+    if (file.size() > G_MAXINT)
+        throw std::runtime_error(_("File is too big."));
+    return create_from_buffer(file.data(), file.size(), filename);
 }
 
 
 /**
- * Load a file to an array of bytes.
+ * Map a file to memory.
  * @param filename The name of the file.
- * @return The file loaded. If impossible to load, throws an exception.
+ * If impossible to open, throws an exception.
  */
-std::vector<unsigned char> load_file_to_vector(char const *filename) {
-    /* open file */
-    std::ifstream is;
-    is.open(filename, std::ios::in | std::ios::binary);
-    if (!is)
-        throw std::runtime_error(_("Unable to open file."));
-    /* check size */
-    is.seekg(0, is.end);
-    int filesize = is.tellg();
-    is.seekg(0, is.beg);
-    if (filesize > (2 * 1 << 20))
-        throw std::runtime_error(_("File bigger than 2MiB, refusing to load."));
-    /* read file. the vector will be one bytes bigger, so it can be added a terminating zero char. */
-    std::vector<unsigned char> contents(filesize + 1);
-    if (!is.read((char *) &contents[0], filesize))
-        throw std::runtime_error(_("Unable to read file."));
-    is.close();
-    contents[filesize] = '\0';
-
-    return contents;
+MappedFile::MappedFile(char const *filename) {
+    GError *error = NULL;
+    file = g_mapped_file_new(filename, FALSE, &error);
+    if (file == NULL) {
+        std::string message = Printf("%s %s", _("Unable to open file."), error->message);
+        g_error_free(error);
+        throw std::runtime_error(message);
+    }
+}
+
+
+MappedFile::~MappedFile() {
+    g_mapped_file_unref(file);
+}
+
+
+/** The contents of the file. For an empty file, a valid pointer to nothing. */
+unsigned char const *MappedFile::data() const {
+    static unsigned char const empty[1] = { 0 };
+    char const *contents = g_mapped_file_get_contents(file);
+    return contents != NULL ? reinterpret_cast<unsigned char const *>(contents) : empty;
+}
+
+
+size_t MappedFile::size() const {
+    return g_mapped_file_get_length(file);
 }
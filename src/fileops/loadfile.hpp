@@ -26,11 +26,29 @@
 
 #include "config.h"
 
-#include <vector>
+#include <glib.h>
+#include <cstddef>
 
 class CaveSet;
 
-std::vector<unsigned char> load_file_to_vector(char const *filename);
+/**
+ * A file mapped read-only to memory, with GMappedFile.
+ * The importers work directly on the mapped bytes, so the file is not read into a buffer.
+ * The contents are not zero-terminated.
+ */
+class MappedFile {
+public:
+    explicit MappedFile(char const *filename);
+    MappedFile(MappedFile const &) = delete;
+    MappedFile &operator=(MappedFile const &) = delete;
+    ~MappedFile();
+    unsigned char const *data() const;
+    size_t size() const;
+
+private:
+    GMappedFile *file;
+};
+
 CaveSet load_caveset_from_file(const char *filename);
 CaveSet create_from_buffer(const unsigned char *buffer, int length, char const *filename = "");
 
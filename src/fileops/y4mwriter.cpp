@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2007-2018, GDash Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "config.h"
+
+#include <glib.h>
+#include <cerrno>
+#include <cstring>
+
+#include "fileops/y4mwriter.hpp"
+#include "gfx/pixbuf.hpp"
+#include "misc/logger.hpp"
+#include "misc/printf.hpp"
+
+
+Y4MWriter::Y4MWriter(std::string const &target, int width, int height, int fps)
+    : width(width), height(height), pipe(!target.empty() && target[0] == '|'), out(NULL), thread(NULL), finishing(false) {
+    g_mutex_init(&mutex);
+    g_cond_init(&cond);
+
+    if (pipe) {
+#ifdef G_OS_WIN32
+        out = _popen(target.c_str() + 1, "wb");
+#else
+        /* if the command exits, writing to the pipe would kill the whole program
+         * with SIGPIPE; the write fails with EPIPE instead. */
+        struct sigaction ignore;
+        memset(&ignore, 0, sizeof(ignore));
+        ignore.sa_handler = SIG_IGN;
+        sigemptyset(&ignore.sa_mask);
+        sigaction(SIGPIPE, &ignore, &saved_sigpipe);
+        out = popen(target.c_str() + 1, "w");
+#endif
+    } else
+        out = fopen(target.c_str(), "wb");
+    if (out == NULL) {
+        gd_critical("Cannot open %s for video output: %s", target, g_strerror(errno));
+        return;
+    }
+
+    /* 4:2:0 chroma, full frames, square pixels. the colors are bt.601 with limited range,
+     * which is what the players assume if nothing else is said. */
+    std::string header = Printf("YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", width, height, fps);
+    if (fputs(header.c_str(), out) < 0) {
+        gd_critical("Cannot write to %s: %s", target, g_strerror(errno));
+        return;
+    }
+    thread = g_thread_new("y4mwriter", writer_thread, this);
+}
+
+
+Y4MWriter::~Y4MWriter() {
+    if (thread != NULL) {
+        g_mutex_lock(&mutex);
+        finishing = true;
+        g_cond_broadcast(&cond);
+        g_mutex_unlock(&mutex);
+        g_thread_join(thread);
+        report_error();
+    }
+    if (out != NULL) {
+#ifdef G_OS_WIN32
+        if (pipe)
+            _pclose(out);
+#else
+        if (pipe)
+            pclose(out);
+#endif
+        else
+            fclose(out);
+    }
+#ifndef G_OS_WIN32
+    if (pipe)
+        sigaction(SIGPIPE, &saved_sigpipe, NULL);
+#endif
+    g_cond_clear(&cond);
+    g_mutex_clear(&mutex);
+}
+
+
+void Y4MWriter::add_frame(guint32 const *pixels, int pitch) {
+    if (thread == NULL)
+        return;
+
+    std::vector<guint32> frame(size_t(width) * height);
+    for (int y = 0; y < height; ++y)
+        memcpy(&frame[size_t(y) * width], reinterpret_cast<char const *>(pixels) + size_t(y) * pitch, width * sizeof(guint32));
+
+    g_mutex_lock(&mutex);
+    while (queue.size() >= max_queued)
+        g_cond_wait(&cond, &mutex);
+    queue.push_back(std::move(frame));
+    g_cond_broadcast(&cond);
+    g_mutex_unlock(&mutex);
+    report_error();
+}
+
+
+/* the error of the thread is logged on the thread of the caller. */
+void Y4MWriter::report_error() {
+    g_mutex_lock(&mutex);
+    std::string message;
+    message.swap(error);
+    g_mutex_unlock(&mutex);
+    if (!message.empty())
+        gd_critical("%s", message);
+}
+
+
+gpointer Y4MWriter::writer_thread(gpointer data) {
+    Y4MWriter *writer = static_cast<Y4MWriter *>(data);
+    std::vector<unsigned char> yuv;
+    bool ok = true;
+
+    g_mutex_lock(&writer->mutex);
+    for (;;) {
+        while (writer->queue.empty() && !writer->finishing)
+            g_cond_wait(&writer->cond, &writer->mutex);
+        if (writer->queue.empty())
+            break;
+        std::vector<guint32> frame = std::move(writer->queue.front());
+        writer->queue.pop_front();
+        /* there is place in the queue now */
+        g_cond_broadcast(&writer->cond);
+        g_mutex_unlock(&writer->mutex);
+
+        /* after an error, the frames are still taken, so add_frame() does not wait forever. */
+        std::string message;
+        if (ok && !writer->write_frame(frame, yuv)) {
+            if (writer->pipe && errno == EPIPE)
+                message = "Cannot write video frame: the video encoder has exited!";
+            else
+                message = Printf("Cannot write video frame: %s", g_strerror(errno));
+            ok = false;
+        }
+
+        g_mutex_lock(&writer->mutex);
+        if (!message.empty())
+            writer->error = message;
+    }
+    g_mutex_unlock(&writer->mutex);
+    return NULL;
+}
+
+
+/* convert a frame to the planar y, u, v format and write it. for u and v,
+ * 2x2 pixels are averaged. the conversion uses the bt.601 integer formulas. */
+bool Y4MWriter::write_frame(std::vector<guint32> const &frame, std::vector<unsigned char> &yuv) {
+    int cw = (width + 1) / 2, ch = (height + 1) / 2;
+    yuv.resize(size_t(width) * height + 2 * size_t(cw) * ch);
+    unsigned char *yplane = &yuv[0];
+    unsigned char *uplane = yplane + size_t(width) * height;
+    unsigned char *vplane = uplane + size_t(cw) * ch;
+
+    for (int y = 0; y < height; ++y) {
+        guint32 const *row = &frame[size_t(y) * width];
+        unsigned char *yrow = yplane + size_t(y) * width;
+        for (int x = 0; x < width; ++x) {
+            int r = (row[x] >> Pixbuf::rshift) & 0xff, g = (row[x] >> Pixbuf::gshift) & 0xff, b = (row[x] >> Pixbuf::bshift) & 0xff;
+            yrow[x] = ((66 * r + 129 * g + 25 * b + 128) >> 8) + 16;
+        }
+    }
+    for (int cy = 0; cy < ch; ++cy) {
+        guint32 const *row1 = &frame[size_t(2 * cy) * width];
+        guint32 const *row2 = 2 * cy + 1 < height ? row1 + width : row1;
+        for (int cx = 0; cx < cw; ++cx) {
+            int x1 = 2 * cx, x2 = 2 * cx + 1 < width ? 2 * cx + 1 : 2 * cx;
+            guint32 const p[4] = { row1[x1], row1[x2], row2[x1], row2[x2] };
+            int r = 0, g = 0, b = 0;
+            for (guint32 pixel : p) {
+                r += (pixel >> Pixbuf::rshift) & 0xff;
+                g += (pixel >> Pixbuf::gshift) & 0xff;
+                b += (pixel >> Pixbuf::bshift) & 0xff;
+            }
+            /* the sums are four times the average; the division is in the shifts. */
+            uplane[size_t(cy) * cw + cx] = ((-38 * r - 74 * g + 112 * b + 512) >> 10) + 128;
+            vplane[size_t(cy) * cw + cx] = ((112 * r - 94 * g - 18 * b + 512) >> 10) + 128;
+        }
+    }
+
+    return fputs("FRAME\n", out) >= 0 && fwrite(&yuv[0], 1, yuv.size(), out) == yuv.size();
+}
@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2007-2018, GDash Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef Y4MWRITER_HPP_INCLUDED
+#define Y4MWRITER_HPP_INCLUDED
+
+#include "config.h"
+
+#include <glib.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <deque>
+#ifndef G_OS_WIN32
+#include <csignal>
+#endif
+
+/// @ingroup Graphics
+/// Writes video frames to a YUV4MPEG2 stream, which most video encoders
+/// (ffmpeg, x264, mencoder...) can read directly.
+/// The stream goes to a file, or to the standard input of a command.
+/// The frames are converted to YUV 4:2:0 and written by a thread, so adding
+/// a frame only copies its pixels.
+/// While a pipe is open, SIGPIPE is ignored; if the command exits, the writes
+/// fail with EPIPE, and that is reported as a write error.
+/// Write errors are reported by add_frame() or the destructor, as the logger
+/// is not to be used from the thread.
+class Y4MWriter {
+public:
+    /// @param target The name of the file, or a command to pipe the stream to, if it starts with '|'.
+    /// @param width Width of the frames in pixels.
+    /// @param height Height of the frames in pixels.
+    /// @param fps Frames per second.
+    /// If the file or the pipe cannot be opened, the error is reported here; see is_ok().
+    Y4MWriter(std::string const &target, int width, int height, int fps);
+    /// Writes the frames still waiting, and closes the file or the pipe.
+    ~Y4MWriter();
+
+    /// True, if the file or the pipe could be opened, and the frames can be added.
+    bool is_ok() const {
+        return thread != NULL;
+    }
+
+    /// Add a frame. If the writer thread is much behind, waits for it.
+    /// @param pixels The pixels, in the format of the Pixbuf class.
+    /// @param pitch Bytes per row.
+    void add_frame(guint32 const *pixels, int pitch);
+
+private:
+    Y4MWriter(Y4MWriter const &) = delete;
+    Y4MWriter &operator=(Y4MWriter const &) = delete;
+
+    /// The number of frames copied but not yet written, after which add_frame() waits.
+    static const unsigned max_queued = 32;
+
+    int width, height;
+    bool pipe;
+    FILE *out;
+#ifndef G_OS_WIN32
+    struct sigaction saved_sigpipe;     ///< the SIGPIPE handler before opening the pipe
+#endif
+    GThread *thread;
+    GMutex mutex;
+    GCond cond;
+    std::deque<std::vector<guint32>> queue;
+    bool finishing;
+    std::string error;                  ///< set by the thread if a write fails; to be reported
+
+    static gpointer writer_thread(gpointer data);
+    bool write_frame(std::vector<guint32> const &frame, std::vector<unsigned char> &yuv);
+    void report_error();
+};
+
+#endif
@@ -367,14 +367,6 @@ void App::timer_event(int ms_elapsed) {
 }
 
 
-void App::timer2_event() {
-    if (have_activity()) {
-        topmost_activity().timer2_event();
-        process_commands();
-    }
-}
-
-
 void App::keypress_event(Activity::KeyCode keycode, int gfxlib_keycode) {
     /* send it to the gameinput object. */
     gameinput->keypress(gfxlib_keycode);
@@ -248,8 +248,6 @@ public:
     /* events */
     /** See Activity::timer_event(). */
     void timer_event(int ms_elapsed);
-    /** See Activity::timer2_event(). */
-    void timer2_event();
     /**
      * To be called from the running environment when the user presses a key.
      * The keypresses are preprocessed - not all keypresses will get through to the
@@ -179,6 +179,9 @@ void GameActivity::keypress_event(KeyCode keycode, int gfxlib_keycode) {
 void GameActivity::timer_event(int ms_elapsed) {
     GameRenderer::State state = gamerenderer.main_int(ms_elapsed, paused, app->gameinput);
     queue_redraw();
+    /* the next iteration of the cave can run while this frame is drawn and presented */
+    if (!paused)
+        game->iterate_ahead(app->gameinput);
 
     /* state of game, returned by gd_game_main_int */
     switch (state) {
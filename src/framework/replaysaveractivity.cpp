@@ -32,7 +32,7 @@
 #include "framework/replaysaveractivity.hpp"
 #include "framework/app.hpp"
 #include "framework/commands.hpp"
-#include "sdl/IMG_savepng.hpp"
+#include "fileops/y4mwriter.hpp"
 #include "sound/sound.hpp"
 #include "cave/gamecontrol.hpp"
 #include "cave/titleanimation.hpp"
@@ -76,8 +76,15 @@ void SDLInmemoryScreen::configure_size() {
 }
 
 
-void SDLInmemoryScreen::save(char const *filename) {
-    IMG_SavePNG(filename, surface.get(), 2);        // 2 = not too much compression, but a bit faster than the default
+void SDLInmemoryScreen::save(PngWriter &png_writer, char const *filename) {
+    /* the surface was created with the masks of the Pixbuf, so it is rgba in memory */
+    png_writer.save(filename, surface->w, surface->h, 4, static_cast<unsigned char const *>(surface->pixels), surface->pitch);
+}
+
+
+void SDLInmemoryScreen::save(Y4MWriter &video) {
+    /* the surface was created with the masks of the Pixbuf, so the writer can take it as it is */
+    video.add_frame(static_cast<guint32 const *>(surface->pixels), surface->pitch);
 }
 
 
@@ -88,11 +95,15 @@ Pixbuf const *SDLInmemoryScreen::create_pixbuf_screenshot() const {
 }
 
 
-ReplaySaverActivity::ReplaySaverActivity(App *app, CaveStored *cave, CaveReplay *replay, std::string const &filename_prefix)
+ReplaySaver::ReplaySaver(CaveSet *caveset, CaveStored *cave, CaveReplay *replay, std::string const &filename_prefix, ReplaySaverSound *sound)
     :
-    Activity(app),
+    wavlen(0),
+    frame(0),
     filename_prefix(filename_prefix),
-    game(GameControl::new_replay(app->caveset, cave, replay)),
+    wavfile(NULL),
+    png_writer(gd_png_compression),
+    saved_gd_show_name_of_game(gd_show_name_of_game),
+    game(GameControl::new_replay(caveset, cave, replay)),
     pf(),
     pm(pf),
     fm(pm, ""),
@@ -102,36 +113,55 @@ ReplaySaverActivity::ReplaySaverActivity(App *app, CaveStored *cave, CaveReplay
     pm.set_size(cell_size * gd_view_width, cell_size * (gd_view_height + 1), false);
     gamerenderer.screen_initialized();
     gamerenderer.set_show_replay_sign(false);
-    std::string wav_filename = filename_prefix + ".wav";
+    /* a .y4m file or a |command gets the video stream; otherwise png files are saved. */
+    if (!filename_prefix.empty() && filename_prefix[0] == '|') {
+        wav_filename = Printf("%s%sout.wav", gd_last_folder, G_DIR_SEPARATOR);
+        video = std::make_unique<Y4MWriter>(filename_prefix, pm.get_width(), pm.get_height(), 25);
+    } else if (g_str_has_suffix(filename_prefix.c_str(), ".y4m")) {
+        wav_filename = filename_prefix.substr(0, filename_prefix.size() - 4) + ".wav";
+        video = std::make_unique<Y4MWriter>(filename_prefix, pm.get_width(), pm.get_height(), 25);
+    } else
+        wav_filename = filename_prefix + ".wav";
+    if (video && !video->is_ok()) {
+        /* the video writer has already told the reason */
+        return;
+    }
     wavfile = fopen(wav_filename.c_str(), "wb");
     if (!wavfile) {
         gd_critical("Cannot open %s for sound output", wav_filename);
-        app->enqueue_command(std::make_unique<PopActivityCommand>(app));
         return;
     }
     fseek(wavfile, 44, SEEK_SET);    /* 44bytes offset: start of data in a wav file */
-    wavlen = 0;
-    frame = 0;
-    /* save settings and install own settings */
-    saved_gd_show_name_of_game = gd_show_name_of_game;
+    /* install own settings; the user's ones are saved above */
     gd_show_name_of_game = true;
-}
-
 
-void ReplaySaverActivity::shown_event() {
-    std::vector<std::unique_ptr<Pixmap>> animation = get_title_animation_pixmap(app->caveset->title_screen, app->caveset->title_screen_scroll, true, pm, pf);
+    std::vector<std::unique_ptr<Pixmap>> animation = get_title_animation_pixmap(caveset->title_screen, caveset->title_screen_scroll, true, pm, pf);
     pm.blit(*animation[0], 0, 0);
-    gd_music_stop();
 
-    /* enable own timer and sound saver */
-    install_own_mixer();
+    /* enable the offline sound mixer, and start it from silence */
+    if (sound == NULL) {
+        own_sound = std::make_unique<ReplaySaverSound>(true);
+        sound = own_sound.get();
+    }
+    frequency = sound->frequency;
+    channels = sound->channels;
+    bits = sound->bits;
+    if (!gd_sound_set_offline(true))
+        gd_critical("Cannot start the offline sound mixer. The replay saver will not work correctly!");
 }
 
 
-ReplaySaverActivity::~ReplaySaverActivity() {
-    Mix_SetPostMix(NULL, NULL);    /* remove wav file saver */
-    uninstall_own_mixer();
+ReplaySaver::~ReplaySaver() {
+    /* closing the video writes the frames still queued. */
+    video.reset();
+    png_writer.wait();
+
+    /* if the output files could not be opened, there is nothing more to do. */
+    if (wavfile == NULL)
+        return;
+
     gd_sound_off();
+    own_sound.reset();
 
     /* write wav header, as now we now its final size. */
     fseek(wavfile, 0, SEEK_SET);
@@ -168,18 +198,23 @@ ReplaySaverActivity::~ReplaySaverActivity() {
     if (i != 44)
         gd_critical("Could not write wav header to file!");
 
-    std::string message = Printf(_("Saved %d video frames and %dMiB of audio data to %s_*.png and %s.wav."), frame + 1, wavlen / 1048576, filename_prefix, filename_prefix);
-    app->show_message(_("Replay Saved"), message);
-
     // restore settings
     gd_show_name_of_game = saved_gd_show_name_of_game;
-    gd_sound_set_music_volume();
-    gd_sound_set_chunk_volumes();
-    gd_music_play_random();
 }
 
 
-void ReplaySaverActivity::install_own_mixer() {
+std::string ReplaySaver::summary() const {
+    if (filename_prefix[0] == '|')
+        return Printf(_("Sent %d video frames to %s, and saved %dMiB of audio data to %s."), frame, filename_prefix.substr(1), wavlen / 1048576, wav_filename);
+    else if (g_str_has_suffix(filename_prefix.c_str(), ".y4m"))
+        return Printf(_("Saved %d video frames to %s, and %dMiB of audio data to %s."), frame, filename_prefix, wavlen / 1048576, wav_filename);
+    else
+        return Printf(_("Saved %d video frames and %dMiB of audio data to %s_*.png and %s.wav."), frame + 1, wavlen / 1048576, filename_prefix, filename_prefix);
+}
+
+
+ReplaySaverSound::ReplaySaverSound(bool restart)
+    : restart(restart) {
     gd_sound_close();
 
     /* we setup mixing and other parameters for our own needs. */
@@ -220,11 +255,10 @@ void ReplaySaverActivity::install_own_mixer() {
         default:
             g_assert_not_reached();
     }
-    Mix_SetPostMix(mixfunc, this);
 }
 
 
-void ReplaySaverActivity::uninstall_own_mixer() {
+ReplaySaverSound::~ReplaySaverSound() {
     gd_sound_close();
 
     // restore settings
@@ -238,28 +272,73 @@ void ReplaySaverActivity::uninstall_own_mixer() {
     else
         g_unsetenv("SDL_AUDIODRIVER");
 
-    gd_sound_init();
+    if (restart)
+        gd_sound_init();
 }
 
 
-/* this function saves the wav file, and also does the timing! */
-void ReplaySaverActivity::mixfunc(void *udata, Uint8 *stream, int len) {
-    ReplaySaverActivity *rs = static_cast<ReplaySaverActivity *>(udata);
-
-    if (!rs->wavfile)
-        return;
-    if (fwrite(stream, 1, len, rs->wavfile) != size_t(len))
+bool ReplaySaver::save_frame() {
+    /* first the sound of the frame, as the mixer callback did it when playing in real time */
+    gint16 stream[44100 / 25 * 2];
+    gd_sound_mix_offline(stream, G_N_ELEMENTS(stream) / 2);
+    if (fwrite(stream, 1, sizeof(stream), wavfile) != sizeof(stream))
         gd_critical("Cannot write to wav file!");
+    wavlen += sizeof(stream);
+
+    /* iterate and see what happened */
+    /* give no gameinputhandler to the renderer */
+    GameRenderer::State state = gamerenderer.main_int(GameControl::step_ms, false, NULL);
+    gamerenderer.draw(pm.must_redraw_all_before_flip());
+    pm.do_the_flip();
+
+    /* before incrementing frame number, check if to save the frame to disk. */
+    if (video)
+        pm.save(*video);
+    else
+        pm.save(png_writer, Printf("%s_%08d.png", filename_prefix, frame).c_str());
+    frame++;
 
-    // push a user event -> to do the timing
-    SDL_Event ev;
-    ev.type = SDL_USEREVENT + 1;
-    SDL_PushEvent(&ev);
+    switch (state) {
+        case GameRenderer::Nothing:
+            break;
 
-    rs->wavlen += len;
+        case GameRenderer::Stop:        /* game stopped, this could be a replay or a snapshot */
+        case GameRenderer::GameOver:    /* game over should not happen for a replay, but no problem */
+            return false;
+    }
+    return true;
+}
+
+
+ReplaySaverActivity::ReplaySaverActivity(App *app, CaveStored *cave, CaveReplay *replay, std::string const &filename_prefix)
+    :
+    Activity(app),
+    saving(false),
+    saver(std::make_unique<ReplaySaver>(app->caveset, cave, replay, filename_prefix)) {
+    if (!saver->is_ok())
+        app->enqueue_command(std::make_unique<PopActivityCommand>(app));
+}
+
+
+ReplaySaverActivity::~ReplaySaverActivity() {
+    bool ok = saver->is_ok();
+    std::string message = saver->summary();
+    /* this writes the files, and reinstalls the normal sound */
+    saver.reset();
+    if (ok)
+        app->show_message(_("Replay Saved"), message);
+
+    gd_sound_set_music_volume();
+    gd_sound_set_chunk_volumes();
+    gd_music_play_random();
+}
+
+
+void ReplaySaverActivity::shown_event() {
+    gd_music_stop();
+    saving = saver->is_ok();
 }
 
-#include <typeinfo>
 
 void ReplaySaverActivity::redraw_event(bool full) const {
     app->clear_screen();
@@ -271,9 +350,9 @@ void ReplaySaverActivity::redraw_event(bool full) const {
     // show it to the user.
     // it is not in displayformat, but a small image - not that slow to draw.
     // center coordinates
-    int x = (app->screen->get_width() - pm.get_width()) / 2;
-    int y = (app->screen->get_height() - pm.get_height()) / 2;
-    Pixbuf const *pb = pm.create_pixbuf_screenshot();
+    Pixbuf const *pb = saver->create_pixbuf_screenshot();
+    int x = (app->screen->get_width() - pb->get_width()) / 2;
+    int y = (app->screen->get_height() - pb->get_height()) / 2;
     app->screen->blit_pixbuf(*pb, x, y, false);
     delete pb;
 
@@ -281,27 +360,30 @@ void ReplaySaverActivity::redraw_event(bool full) const {
 }
 
 
-void ReplaySaverActivity::timer2_event() {
-    /* iterate and see what happened */
-    /* give no gameinputhandler to the renderer */
-    GameRenderer::State state = gamerenderer.main_int(40, false, NULL);
-    gamerenderer.draw(pm.must_redraw_all_before_flip());
-    pm.do_the_flip();
-    switch (state) {
-        case GameRenderer::Nothing:
-            break;
+void ReplaySaverActivity::timer_event(int) {
+    if (!saving)
+        return;
 
-        case GameRenderer::Stop:        /* game stopped, this could be a replay or a snapshot */
-        case GameRenderer::GameOver:    /* game over should not happen for a replay, but no problem */
+    /* save frames until the time budget is used up; then let the main loop show the last one. */
+    gint64 const start = g_get_monotonic_time();
+    do {
+        if (!saver->save_frame()) {
+            saving = false;
             app->enqueue_command(std::make_unique<PopActivityCommand>(app));
-            break;
-    }
+        }
+    } while (saving && g_get_monotonic_time() - start < time_budget_us);
+    queue_redraw();
+}
 
-    /* before incrementing frame number, check if to save the frame to disk. */
-    pm.save(Printf("%s_%08d.png", filename_prefix, frame).c_str());
 
-    queue_redraw();
-    frame++;
+bool gd_save_replay(CaveSet *caveset, CaveStored *cave, CaveReplay *replay, std::string const &filename_prefix, ReplaySaverSound *sound) {
+    ReplaySaver saver(caveset, cave, replay, filename_prefix, sound);
+    if (!saver.is_ok())
+        return false;
+    while (saver.save_frame())
+        ;
+    gd_message("%s", saver.summary());
+    return true;
 }
 
 #endif /* IFDEF HAVE_SDL */
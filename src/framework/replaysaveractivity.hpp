@@ -35,8 +35,11 @@
 #include "gfx/fontmanager.hpp"
 #include "gfx/cellrenderer.hpp"
 #include "cave/gamerender.hpp"
+#include "gfx/pngwriter.hpp"
 
+class CaveSet;
 class CaveStored;
+class Y4MWriter;
 class CaveReplay;
 class GameControl;
 
@@ -50,68 +53,100 @@ public:
     virtual std::unique_ptr<Pixmap> create_pixmap_from_pixbuf(Pixbuf const &pb, bool keep_alpha) const override;
 
     Pixbuf const *create_pixbuf_screenshot() const;
-    void save(char const *filename);
+    void save(PngWriter &png_writer, char const *filename);
+    void save(Y4MWriter &video);
 };
 
 
 /**
- * This activity plays a replay, and saves every animation frame to
- * a PNG file, along with the sound to a WAV file.
+ * Switches the sound module to the offline mixer of the replay saver, for the
+ * lifetime of the object. The sound of the user is closed, the settings are
+ * tweaked, and a stream is opened with the dummy audio driver only to load the
+ * sound samples. When saving many replays, one object can be shared by them,
+ * so the audio device is not reopened for every replay. */
+class ReplaySaverSound {
+public:
+    /** Ctor. Saves the sound preferences of the user, and restarts the SDL audio
+     * subsystem with the required settings.
+     * @param restart If true, the sound of the user is restarted by the destructor.
+     *      If false, it is left closed, which is what the command line wants. */
+    explicit ReplaySaverSound(bool restart);
+    /** Destructor. Reverts to the original sound preferences of the user. */
+    ~ReplaySaverSound();
+
+    /** Sound settings reported by SDL. */
+    int frequency, channels, bits;
+
+private:
+    ReplaySaverSound(ReplaySaverSound const &) = delete;
+    ReplaySaverSound &operator=(ReplaySaverSound const &) = delete;
+
+    /** Whether to restart the sound of the user in the destructor. */
+    bool restart;
+    /** User's sound preference to be restored after replay saving. */
+    bool saved_gd_sdl_sound;
+    /** User's sound preference to be restored after replay saving. */
+    bool saved_gd_sdl_44khz_mixing;
+    /** User's sound preference to be restored after replay saving. */
+    bool saved_gd_sdl_16bit_mixing;
+    /** User's sound preference to be restored after replay saving. */
+    bool saved_gd_sound_stereo;
+    /** SDL sound environment variable saved, to be restored after replay saving. */
+    std::string saved_driver;
+};
+
+
+/**
+ * Plays a replay, and saves every animation frame to PNG files, along with
+ * the sound to a WAV file. The frames can also be streamed to a single
+ * YUV4MPEG2 video file, or piped to an encoder.
  *
  * This is implemented using a normal GameControl object, but it is given
- * a special kind of Screen which can be saved to a PNG file. Also
- * the normal sound stream is closed, and a special stream is requested
- * from SDL with the dummy audio driver. A mixer callback func is also
- * registered for SDL_Mixer, which will save the audio data.
- *
- * During saving the replay, the normal timer events which are forwarded
- * from the App are not used for the timing of the cave. The mixer callback
- * registered to SDL_Mixer also pushes SDL events (SDL_USEREVENT+1), which
- * are then sent to App::timer2_event() in sdlmain.cpp. This is used
- * to iterate the cave. The size of
- * the sound buffer is set to hold 20ms of sound data, so SDL_Mixer is
- * forced to generate us the events every 20ms - thus we can do an 50fps
- * animation.
+ * a special kind of Screen which can be saved to a PNG file. The sound
+ * is not played; it is mixed by the offline mixer, see ReplaySaverSound.
  *
- * During saving the replay, the image is shown to the user, but it is not
- * scaled, and there will be no sound. (As sound goes only to the memory
- * and the WAV file.) This does not take too much CPU power; compressing
- * the PNG files is eats much more.
+ * The saving does not depend on any timing of SDL. Every frame mixes the
+ * next 1/25th of a second of audio, iterates the cave by 40ms and saves
+ * the image, in this order; so the output is always the same for the
+ * same replay. The caller decides how many frames to save at once.
  *
- * The whole thing only works in the SDL version, it is not implemented
- * in the GTK game. Maybe it would be nice to put it in the GTK version
- * instead. */
-class ReplaySaverActivity: public Activity {
+ * It does not need an App, so replays can also be saved from the command
+ * line, see gd_save_replay(). */
+class ReplaySaver {
 public:
-    /** Ctor.
-     * The created Activity, when pushed, will start to record the replay.
-     * When finishing, it will automatically quit. There is no way for
-     * the user to cancel the saving.
-     * @param app The parent app.
+    /** Ctor. Opens the output files, and switches the sound to the offline mixer.
+     * @param caveset The caveset, which has the cave.
      * @param cave The cave which has the replay to record.
      * @param replay The replay to record to the files.
      * @param filename_prefix A filename prefix of the output files,
-     *      to which .wav and _xxxxxx.png will be appended. */
-    ReplaySaverActivity(App *app, CaveStored *cave, CaveReplay *replay, std::string const &filename_prefix);
+     *      to which .wav and _xxxxxx.png will be appended. If it ends
+     *      with .y4m, the frames are written to that video file instead.
+     *      If it starts with |, the video is piped to that command, and
+     *      the sound goes to out.wav in the last used folder.
+     * @param sound The offline mixer to use. If NULL, the saver installs one for
+     *      its lifetime, and restarts the sound of the user afterwards. */
+    ReplaySaver(CaveSet *caveset, CaveStored *cave, CaveReplay *replay, std::string const &filename_prefix, ReplaySaverSound *sound = NULL);
     /** Destructor.
      * Has many things to do - write a WAV header, reinstall the normal mixer etc. */
-    ~ReplaySaverActivity();
-    virtual void redraw_event(bool full) const;
-    /**
-     * When the Activity is shown, it will install its own sound mixer. */
-    virtual void shown_event();
-    /** The timer2 event generated by the sound mixer will do the cave timing. */
-    virtual void timer2_event();
+    ~ReplaySaver();
+
+    /** True, if the output files could be opened. If not, the reason is already reported. */
+    bool is_ok() const {
+        return wavfile != NULL;
+    }
+    /** Mix the sound, iterate the cave and save the image of one frame.
+     * @return false, if the replay is finished; the last frame is also saved. */
+    bool save_frame();
+    /** A message for the user, which tells what was saved to where. */
+    std::string summary() const;
+    /** The image of the last frame saved. */
+    Pixbuf const *create_pixbuf_screenshot() const {
+        return pm.create_pixbuf_screenshot();
+    }
 
 private:
-    /** The SDL_Mixer post mixing callback, which saves the WAV file
-     * and sends SDL_USEREVENT+1-s to do the cave timing. */
-    static void mixfunc(void *udata, Uint8 *stream, int len);
-    /** Save sound preferences of the user, restart the SDL audio subsystem
-     * with the required settings and install the mixer callbacks. */
-    void install_own_mixer();
-    /** Revert to the original sound preferences of the user. */
-    void uninstall_own_mixer();
+    ReplaySaver(ReplaySaver const &) = delete;
+    ReplaySaver &operator=(ReplaySaver const &) = delete;
 
     /** Bytes written to the wav file. */
     unsigned int wavlen;
@@ -122,20 +157,19 @@ private:
     std::string filename_prefix;
     /** The WAV file opened for writing. */
     FILE *wavfile;
+    /** The name of the WAV file. */
+    std::string wav_filename;
+    /** The video stream, if the frames are not saved to PNG files. */
+    std::unique_ptr<Y4MWriter> video;
+    /** Compresses the PNG files in the background. */
+    PngWriter png_writer;
+
+    /** The offline mixer, if installed by this object. */
+    std::unique_ptr<ReplaySaverSound> own_sound;
 
     // saved settings
-    /** User's sound preference to be restored after replay saving. */
-    bool saved_gd_sdl_sound;
-    /** User's sound preference to be restored after replay saving. */
-    bool saved_gd_sdl_44khz_mixing;
-    /** User's sound preference to be restored after replay saving. */
-    bool saved_gd_sdl_16bit_mixing;
-    /** User's sound preference to be restored after replay saving. */
+    /** User's preference to be restored after replay saving. */
     bool saved_gd_show_name_of_game;
-    /** User's sound preference to be restored after replay saving. */
-    bool saved_gd_sound_stereo;
-    /** SDL sound environment variable saved, to be restored after replay saving. */
-    std::string saved_driver;
 
     /** GameControl object which plays the replay. */
     std::unique_ptr<GameControl> game;
@@ -151,6 +185,60 @@ private:
     GameRenderer gamerenderer;
 };
 
+
+/**
+ * This activity saves a replay with a ReplaySaver, and shows the frames
+ * saved to the user meanwhile.
+ *
+ * In each timer event, as many frames are saved as fit into a short time
+ * budget, so the saving runs as fast as the machine can do it, but the
+ * main loop still gets to process the events and to show the last image.
+ *
+ * The whole thing only works in the SDL version, it is not implemented
+ * in the GTK game. Maybe it would be nice to put it in the GTK version
+ * instead. */
+class ReplaySaverActivity: public Activity {
+public:
+    /** Ctor.
+     * The created Activity, when pushed, will start to record the replay.
+     * When finishing, it will automatically quit. There is no way for
+     * the user to cancel the saving.
+     * @param app The parent app.
+     * @param cave The cave which has the replay to record.
+     * @param replay The replay to record to the files.
+     * @param filename_prefix See ReplaySaver. */
+    ReplaySaverActivity(App *app, CaveStored *cave, CaveReplay *replay, std::string const &filename_prefix);
+    /** Destructor.
+     * Closes the files, and tells the user what was saved. */
+    ~ReplaySaverActivity();
+    virtual void redraw_event(bool full) const;
+    /**
+     * When the Activity is shown, it stops the music. */
+    virtual void shown_event();
+    /** Saves frames until the time budget is used up. */
+    virtual void timer_event(int ms_elapsed);
+
+private:
+    /** The wall clock time in microseconds, for which frames are saved in a timer event.
+     * Less than the period of the timer, so the window stays responsive. */
+    static const gint64 time_budget_us = 15000;
+
+    /** True while the replay is being saved. */
+    bool saving;
+    std::unique_ptr<ReplaySaver> saver;
+};
+
+
+/**
+ * Save a replay without showing anything, for the command line.
+ * @param caveset The caveset, which has the cave.
+ * @param cave The cave which has the replay to record.
+ * @param replay The replay to record to the files.
+ * @param filename_prefix See ReplaySaver.
+ * @param sound The offline mixer, to be shared by the replays saved; see ReplaySaver.
+ * @return true, if the files could be written. */
+bool gd_save_replay(CaveSet *caveset, CaveStored *cave, CaveReplay *replay, std::string const &filename_prefix, ReplaySaverSound *sound = NULL);
+
 #endif /* IFDEF HAVE_SDL */
 
 #endif
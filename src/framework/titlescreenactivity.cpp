@@ -58,23 +58,39 @@ TitleScreenActivity::TitleScreenActivity(App *app)
 }
 
 
+TitleScreenActivity::~TitleScreenActivity() = default;
+
+
 void TitleScreenActivity::release_pixmaps() {
-    clear_animation();
+    /* the decoded images are kept, only the scaled pixmaps have to be recreated */
+    animation.clear();
 }
 
 
 void TitleScreenActivity::render_animation() const {
-    if (animation.empty()) {
-        animation = get_title_animation_pixmap(app->caveset->title_screen, app->caveset->title_screen_scroll, false, *app->screen, app->screen->pixbuf_factory);
+    if (title_animation == NULL) {
+        title_animation = std::make_unique<TitleAnimation>(app->caveset->title_screen, app->caveset->title_screen_scroll, app->screen->pixbuf_factory);
+        animation.clear();
         /* this is required because the caveset might have changed since the last redraw, and
          * thus the title screen might have changed, and the new title screen might have fewer
          * frames than the original. */
         animcycle = 0;
     }
+    /* the pixmaps are created by animation_frame(), when first shown */
+    if (animation.empty())
+        animation.resize(title_animation->get_frame_count());
+}
+
+
+Pixmap const &TitleScreenActivity::animation_frame(int i) const {
+    if (animation[i] == NULL)
+        animation[i] = app->screen->create_scaled_pixmap_from_pixbuf(title_animation->get_frame(i), false);
+    return *animation[i];
 }
 
 
 void TitleScreenActivity::clear_animation() {
+    title_animation.reset();
     animation.clear();
 }
 
@@ -85,11 +101,14 @@ void TitleScreenActivity::shown_event() {
     int cell_size = CELL_RENDERER_CELL_SIZE * scale;
     app->screen->set_size(cell_size * gd_view_width, cell_size * (gd_view_height + 1), gd_fullscreen);
 
+    /* the caveset might have been changed while hidden; otherwise, the animation is reused. */
+    if (title_animation != NULL && !title_animation->is_for(app->caveset->title_screen, app->caveset->title_screen_scroll))
+        clear_animation();
     /* render title screen animation in memory pixmap */
     render_animation();
 
     /* height of title screen, then decide which lines to show and where */
-    image_h = animation[0]->get_height();
+    image_h = animation_frame(0).get_height();
     int font_h = app->font_manager->get_font_height();
     /* less than 2 lines left - place for only one line of text. */
     if (app->screen->get_height() - image_h < 2 * font_h) {
@@ -119,7 +138,7 @@ void TitleScreenActivity::shown_event() {
 
 
 void TitleScreenActivity::hidden_event() {
-    clear_animation();
+    /* the animation is kept, so returning to the title screen is quick */
 }
 
 
@@ -134,13 +153,14 @@ void TitleScreenActivity::redraw_event(bool full) const {
         app->font_manager->blittext_n(-1, y_gameline, "%c%s: %c%s %c%s", GD_COLOR_INDEX_WHITE, _("Game"), GD_COLOR_INDEX_YELLOW, app->caveset->name, GD_COLOR_INDEX_RED, app->caveset->edited ? "*" : "");
     }
 
-    int dx = (app->screen->get_width() - animation[animcycle]->get_width()) / 2; /* centered horizontally */
+    Pixmap const &frame = animation_frame(animcycle);
+    int dx = (app->screen->get_width() - frame.get_width()) / 2; /* centered horizontally */
     int dy;
-    if (animation[animcycle]->get_height() < image_centered_threshold)
-        dy = (image_centered_threshold - animation[animcycle]->get_height()) / 2; /* centered vertically */
+    if (frame.get_height() < image_centered_threshold)
+        dy = (image_centered_threshold - frame.get_height()) / 2; /* centered vertically */
     else
         dy = 0; /* top of screen, as not too much space was left for info lines */
-    app->screen->blit(*animation[animcycle], dx, dy);
+    app->screen->blit(frame, dx, dy);
 
     if (show_status) {
         switch (which_status) {
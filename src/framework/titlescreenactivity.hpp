@@ -31,6 +31,7 @@
 #include <memory>
 
 class Pixmap;
+class TitleAnimation;
 
 class TitleScreenActivity: public Activity, public PixmapStorage {
 public:
@@ -40,7 +41,7 @@ public:
     virtual void timer_event(int ms_elapsed);
     virtual void shown_event();
     virtual void hidden_event();
-    ~TitleScreenActivity() = default;
+    ~TitleScreenActivity();
 
     /// Implement PixbufStorage
     virtual void release_pixmaps();
@@ -48,6 +49,9 @@ public:
 private:
     const int scale;
     const int image_centered_threshold;
+    /// decoded title images of the caveset, kept while the activity lives
+    mutable std::unique_ptr<TitleAnimation> title_animation;
+    /// the frames scaled for the screen, created when first shown
     mutable std::vector<std::unique_ptr<Pixmap>> animation;
     int frames, time_ms;
     mutable int animcycle;
@@ -59,6 +63,7 @@ private:
     int cavenum, levelnum;
 
     void render_animation() const;
+    Pixmap const &animation_frame(int i) const;
     void clear_animation();
 };
 
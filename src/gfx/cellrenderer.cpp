@@ -23,6 +23,7 @@
 
 #include "config.h"
 
+#include <algorithm>
 #include <memory>
 
 #include "gfx/cellrenderer.hpp"
@@ -31,11 +32,84 @@
 #include "gfx/pixbuf.hpp"
 #include "gfx/pixbuffactory.hpp"
 #include "gfx/screen.hpp"
+#include "settings.hpp"
+#include "misc/util.hpp"
 
 
 /* data */
 #include "c64_gfx.cpp"
 
+
+/// The cells rendered by the prewarm thread.
+/// Everything the thread needs is copied here when it is started, so it
+/// does not touch the CellRenderer, only the colorized cells_all pixbuf,
+/// which is not modified while the thread is running.
+struct CellRenderer::PrewarmJob {
+    PixbufFactory const &pixbuf_factory;
+    Pixbuf &cells_all;
+    unsigned cell_size;
+    double scaling_factor;
+    GdScalingType scaling_type;
+    bool pal_emulation;
+    std::vector<unsigned> indexes;
+    std::vector<std::unique_ptr<Pixbuf>> results;
+    gint cancel;
+    gint done;
+    GThread *thread;
+
+    PrewarmJob(PixbufFactory const &pixbuf_factory, Pixbuf &cells_all, unsigned cell_size, Screen const &screen)
+        : pixbuf_factory(pixbuf_factory), cells_all(cells_all), cell_size(cell_size),
+          scaling_factor(screen.get_pixmap_scale()), scaling_type(screen.get_scaling_type()), pal_emulation(screen.get_pal_emulation()),
+          cancel(0), done(0), thread(NULL) {}
+
+    static gpointer run(gpointer data);
+};
+
+
+/* this runs in its own thread. does the same as CellRenderer::cell(), but
+ * stops at the scaled pixbuf, as pixmaps must be created in the main thread. */
+gpointer CellRenderer::PrewarmJob::run(gpointer data) {
+    PrewarmJob *job = static_cast<PrewarmJob *>(data);
+
+    for (unsigned n = 0; n < job->indexes.size() && !g_atomic_int_get(&job->cancel); ++n) {
+        int type = job->indexes[n] / NUM_OF_CELLS;  // 0=normal, 1=colored1, 2=colored2
+        int index = job->indexes[n] % NUM_OF_CELLS;
+        std::unique_ptr<Pixbuf> pb = job->pixbuf_factory.create_subpixbuf(job->cells_all,
+            (index % NUM_OF_CELLS_X) * job->cell_size, (index / NUM_OF_CELLS_X) * job->cell_size, job->cell_size, job->cell_size);
+        if (type == 1)
+            pb = job->pixbuf_factory.create_composite_color(*pb, gd_flash_color);
+        else if (type == 2)
+            pb = job->pixbuf_factory.create_composite_color(*pb, gd_select_color);
+        job->results[n] = job->pixbuf_factory.create_scaled(*pb, job->scaling_factor, job->scaling_type, job->pal_emulation);
+    }
+
+    g_atomic_int_set(&job->done, 1);
+    return NULL;
+}
+
+
+/// A colorized theme, stored when switching to other cave colors.
+/// The pixmaps are only valid, if the scaling settings of the screen are the same.
+struct CellRenderer::PaletteCacheEntry {
+    GdColor color0, color1, color2, color3, color4, color5;
+    double scaling_factor;
+    GdScalingType scaling_type;
+    bool pal_emulation;
+    std::unique_ptr<Pixbuf> cells_all;
+    std::unique_ptr<Pixbuf> cells_pixbufs[NUM_OF_CELLS];
+    std::unique_ptr<Pixmap> cells[3 * NUM_OF_CELLS];
+
+    /// Approximate number of bytes used by the pixbufs and pixmaps.
+    size_t memory_used() const {
+        size_t bytes = size_t(cells_all->get_width()) * cells_all->get_height() * 4;
+        for (unsigned i = 0; i < G_N_ELEMENTS(cells); ++i)
+            if (cells[i] != NULL)
+                bytes += size_t(cells[i]->get_width()) * cells[i]->get_height() * 4;
+        return bytes;
+    }
+};
+
+
 CellRenderer::CellRenderer(Screen &screen, const std::string &theme_file)
     :   PixmapStorage(screen),
         is_c64_colored(false),
@@ -51,22 +125,140 @@ CellRenderer::CellRenderer(Screen &screen, const std::string &theme_file)
 }
 
 
+CellRenderer::~CellRenderer() {
+    prewarm_stop();
+}
+
+
 /** Remove colored Pixbufs and Pixmaps created. */
 void CellRenderer::remove_cached() {
     for (unsigned i = 0; i < G_N_ELEMENTS(cells_pixbufs); ++i) {
         cells_pixbufs[i].reset();
     }
-    CellRenderer::release_pixmaps();
+    remove_pixmaps();
     if (is_c64_colored) {
         cells_all.reset();
     }
 }
 
 
-void CellRenderer::release_pixmaps() {
+/** Remove the Pixmaps of the current colors. */
+void CellRenderer::remove_pixmaps() {
+    /* the prewarmed pixbufs are scaled for the current screen, so they must go, too */
+    prewarm_stop();
     for (unsigned i = 0; i < G_N_ELEMENTS(cells); ++i) {
         cells[i].reset();
+        cells_prewarmed[i].reset();
+    }
+}
+
+
+void CellRenderer::release_pixmaps() {
+    remove_pixmaps();
+    /* the stored palettes keep their colorized pixbufs, but not the pixmaps */
+    for (auto &entry : palette_cache)
+        for (unsigned i = 0; i < G_N_ELEMENTS(entry->cells); ++i)
+            entry->cells[i].reset();
+}
+
+
+/** Store the colorized cells of the current colors in the palette cache,
+ * so they can be used again if the same colors are selected later.
+ * The least recently used palettes are dropped to stay in gd_cell_cache_megabytes. */
+void CellRenderer::palette_cache_store() {
+    prewarm_stop();
+    if (cells_all == NULL)
+        return;
+
+    std::unique_ptr<PaletteCacheEntry> entry = std::make_unique<PaletteCacheEntry>();
+    entry->color0 = color0;
+    entry->color1 = color1;
+    entry->color2 = color2;
+    entry->color3 = color3;
+    entry->color4 = color4;
+    entry->color5 = color5;
+    entry->scaling_factor = screen.get_pixmap_scale();
+    entry->scaling_type = screen.get_scaling_type();
+    entry->pal_emulation = screen.get_pal_emulation();
+    entry->cells_all = std::move(cells_all);
+    for (unsigned i = 0; i < G_N_ELEMENTS(cells_pixbufs); ++i)
+        entry->cells_pixbufs[i] = std::move(cells_pixbufs[i]);
+    for (unsigned i = 0; i < G_N_ELEMENTS(cells); ++i)
+        entry->cells[i] = std::move(cells[i]);
+    palette_cache.push_front(std::move(entry));
+
+    size_t const budget = size_t(std::max(gd_cell_cache_megabytes, 0)) * 1024 * 1024;
+    size_t used = 0;
+    auto it = palette_cache.begin();
+    while (it != palette_cache.end() && used + (*it)->memory_used() <= budget) {
+        used += (*it)->memory_used();
+        ++it;
+    }
+    palette_cache.erase(it, palette_cache.end());
+}
+
+
+/** If the current colors are found in the palette cache, take the cells from there. */
+void CellRenderer::palette_cache_restore() {
+    for (auto it = palette_cache.begin(); it != palette_cache.end(); ++it) {
+        PaletteCacheEntry &entry = **it;
+        if (entry.color0 != color0 || entry.color1 != color1 || entry.color2 != color2
+                || entry.color3 != color3 || entry.color4 != color4 || entry.color5 != color5)
+            continue;
+
+        cells_all = std::move(entry.cells_all);
+        for (unsigned i = 0; i < G_N_ELEMENTS(cells_pixbufs); ++i)
+            cells_pixbufs[i] = std::move(entry.cells_pixbufs[i]);
+        /* the pixmaps can only be used if they were scaled the same way */
+        if (entry.scaling_factor == screen.get_pixmap_scale() && entry.scaling_type == screen.get_scaling_type()
+                && entry.pal_emulation == screen.get_pal_emulation())
+            for (unsigned i = 0; i < G_N_ELEMENTS(cells); ++i)
+                cells[i] = std::move(entry.cells[i]);
+        /* it is in use now; will be stored again at the front of the list on the next color change */
+        palette_cache.erase(it);
+        return;
+    }
+}
+
+
+void CellRenderer::prewarm(std::vector<unsigned> const &indexes) {
+    prewarm_stop();
+    if (cells_all == NULL)
+        create_colorized_cells();
+
+    std::unique_ptr<PrewarmJob> job = std::make_unique<PrewarmJob>(screen.pixbuf_factory, *cells_all, cell_size, screen);
+    for (unsigned i : indexes)
+        if (i < G_N_ELEMENTS(cells) && cells[i] == NULL && cells_prewarmed[i] == NULL)
+            job->indexes.push_back(i);
+    if (job->indexes.empty())
+        return;
+    job->results.resize(job->indexes.size());
+    job->thread = g_thread_new("cellprewarm", PrewarmJob::run, job.get());
+    prewarm_job = std::move(job);
+}
+
+
+/** If the prewarm thread has finished, take all the cells it has rendered. */
+void CellRenderer::prewarm_collect() {
+    if (prewarm_job == NULL || !g_atomic_int_get(&prewarm_job->done))
+        return;
+    g_thread_join(prewarm_job->thread);
+    for (unsigned n = 0; n < prewarm_job->indexes.size(); ++n) {
+        unsigned i = prewarm_job->indexes[n];
+        if (cells[i] == NULL)
+            cells_prewarmed[i] = std::move(prewarm_job->results[n]);
     }
+    prewarm_job.reset();
+}
+
+
+/** Cancel the prewarm thread, and drop everything it has rendered. */
+void CellRenderer::prewarm_stop() {
+    if (prewarm_job == NULL)
+        return;
+    g_atomic_int_set(&prewarm_job->cancel, 1);
+    g_thread_join(prewarm_job->thread);
+    prewarm_job.reset();
 }
 
 
@@ -83,6 +275,12 @@ Pixbuf &CellRenderer::cell_pixbuf(unsigned i) {
 
 Pixmap &CellRenderer::cell(unsigned i) {
     g_assert(i < G_N_ELEMENTS(cells));
+    if (cells[i] == NULL)
+        prewarm_collect();
+    if (cells[i] == NULL && cells_prewarmed[i] != NULL) {
+        cells[i] = screen.create_pixmap_from_pixbuf(*cells_prewarmed[i], false);
+        cells_prewarmed[i].reset();
+    }
     if (cells[i] == NULL) {
         int type = i / NUM_OF_CELLS;  // 0=normal, 1=colored1, 2=colored2
         int index = i % NUM_OF_CELLS;
@@ -143,6 +341,7 @@ bool CellRenderer::loadcells_image(std::unique_ptr<Pixbuf> image) {
         return false;
 
     /* remove old stuff */
+    palette_cache.clear();
     remove_cached();
     loaded.reset();
 
@@ -181,11 +380,19 @@ bool CellRenderer::loadcells_file(const std::string &filename) {
 /* if successful, ok. */
 /* if fails, or no theme specified, load the builtin */
 void CellRenderer::load_theme_file(const std::string &theme_file) {
+    gchar *contents;
+    gsize length;
     if (theme_file != "" && loadcells_file(theme_file)) {
         /* loaded from png file */
+        if (g_file_get_contents(theme_file.c_str(), &contents, &length, NULL)) {
+            theme_digest = gd_tostring_free(g_compute_checksum_for_data(G_CHECKSUM_SHA1, reinterpret_cast<guchar const *>(contents), length));
+            g_free(contents);
+        } else
+            theme_digest = theme_file;
     } else {
         std::unique_ptr<Pixbuf> image = screen.pixbuf_factory.create_from_inline(sizeof(c64_gfx), c64_gfx);
         loadcells_image(std::move(image));
+        theme_digest = "builtin";
     }
 }
 
@@ -197,14 +404,18 @@ int CellRenderer::get_cell_size() {
 void CellRenderer::select_pixbuf_colors(GdColor c0, GdColor c1, GdColor c2, GdColor c3, GdColor c4, GdColor c5) {
     if (c0 != color0 || c1 != color1 || c2 != color2 || c3 != color3 || c4 != color4 || c5 != color5) {
         /* if not the same colors as requested before */
+        if (is_c64_colored)
+            palette_cache_store();
         color0 = c0;
         color1 = c1;
         color2 = c2;
         color3 = c3;
         color4 = c4;
         color5 = c5;
-        if (is_c64_colored)
+        if (is_c64_colored) {
             remove_cached();
+            palette_cache_restore();
+        }
     }
 }
 
@@ -254,6 +465,40 @@ bool CellRenderer::check_if_pixbuf_c64_png(Pixbuf const &image) {
 }
 
 
+/* colorizes a single pixel of the loaded image. see create_colorized_cells() for the details. */
+static guint32 colorize_pixel(guint32 pixel, GdColor const colshsv[], GdColor const colsrgb[]) {
+    /* rgb values found in image */
+    unsigned r = (pixel & Pixbuf::rmask) >> Pixbuf::rshift;
+    unsigned g = (pixel & Pixbuf::gmask) >> Pixbuf::gshift;
+    unsigned b = (pixel & Pixbuf::bmask) >> Pixbuf::bshift;
+    unsigned a = (pixel & Pixbuf::amask) >> Pixbuf::ashift;
+    unsigned short inh;
+    unsigned char ins, inv;
+    GdColor::from_rgb(r, g, b).get_hsv(inh, ins, inv);
+
+    /* the color code from the original image (essentially the hue) will select the color index */
+    unsigned index = c64_color_index(inh, ins, inv, a);
+
+    /* and then shade it, and convert to rgb */
+    unsigned char resr, resg, resb;
+    if (index == 0 || index >= 6) {
+        /* for the background and the editor colors, no shading is used */
+        colsrgb[index].get_rgb(resr, resg, resb);
+    } else {
+        /* otherwise the saturation and value from the original image will modify it */
+        unsigned short pixh;
+        unsigned char pixs, pixv;
+        colshsv[index].get_hsv(pixh, pixs, pixv);
+        GdColor::from_hsv(pixh, pixs * ins / 100, pixv * inv / 100).get_rgb(resr, resg, resb);
+    }
+
+    guint32 newcolword =
+        resr << Pixbuf::rshift | resg << Pixbuf::gshift | resb << Pixbuf::bshift | a << Pixbuf::ashift;
+
+    return newcolword;
+}
+
+
 /** This function takes the loaded image, and transforms it using the selected
  * cave colors, to create cells_all.
  *
@@ -299,42 +544,23 @@ void CellRenderer::create_colorized_cells() {
     colsrgb[7] = colshsv[7].to_rgb();  /* white, opaque */
     colsrgb[8] = colshsv[8].to_rgb();  /* for the transparent */
 
+    /* the loaded image of a c64 colored theme has only 0x00 and 0xff bytes in its pixels
+     * (see check_if_pixbuf_c64_png), so it has at most 16 different pixel values. only
+     * those are colorized, and the image is converted with a lookup table, which is
+     * indexed by the most significant bits of the four bytes of a pixel. */
+    guint32 table[16];
+    for (unsigned i = 0; i < G_N_ELEMENTS(table); ++i) {
+        guint32 pixel = (i & 1 ? 0x000000ff : 0) | (i & 2 ? 0x0000ff00 : 0) | (i & 4 ? 0x00ff0000 : 0) | (i & 8 ? 0xff000000 : 0);
+        table[i] = colorize_pixel(pixel, colshsv, colsrgb);
+    }
+
     int w = loaded->get_width(), h = loaded->get_height();
     cells_all = screen.pixbuf_factory.create(w, h);
 
     for (int y = 0; y < h; y++) {
         const guint32 *p = loaded->get_row(y);
         guint32 *to = cells_all->get_row(y);
-        for (int x = 0; x < w; x++) {
-            /* rgb values found in image */
-            unsigned r = (p[x] & loaded->rmask) >> loaded->rshift;
-            unsigned g = (p[x] & loaded->gmask) >> loaded->gshift;
-            unsigned b = (p[x] & loaded->bmask) >> loaded->bshift;
-            unsigned a = (p[x] & loaded->amask) >> loaded->ashift;
-            unsigned short inh;
-            unsigned char ins, inv;
-            GdColor::from_rgb(r, g, b).get_hsv(inh, ins, inv);
-
-            /* the color code from the original image (essentially the hue) will select the color index */
-            unsigned index = c64_color_index(inh, ins, inv, a);
-
-            /* and then shade it, and convert to rgb */
-            unsigned char resr, resg, resb;
-            if (index == 0 || index >= 6) {
-                /* for the background and the editor colors, no shading is used */
-                colsrgb[index].get_rgb(resr, resg, resb);
-            } else {
-                /* otherwise the saturation and value from the original image will modify it */
-                unsigned short pixh;
-                unsigned char pixs, pixv;
-                colshsv[index].get_hsv(pixh, pixs, pixv);
-                GdColor::from_hsv(pixh, pixs * ins / 100, pixv * inv / 100).get_rgb(resr, resg, resb);
-            }
-
-            guint32 newcolword =
-                resr << cells_all->rshift | resg << cells_all->gshift | resb << cells_all->bshift | a << cells_all->ashift;
-
-            to[x] = newcolword;
-        }
+        for (int x = 0; x < w; x++)
+            to[x] = table[(p[x] >> 7 & 1) | (p[x] >> 14 & 2) | (p[x] >> 21 & 4) | (p[x] >> 28 & 8)];
     }
 }
@@ -26,7 +26,10 @@
 #ifndef CELLRENDERER_HPP_INCLUDED
 #define CELLRENDERER_HPP_INCLUDED
 
+#include <glib.h>
 #include <vector>
+#include <list>
+#include <memory>
 
 #include "cave/cavetypes.hpp"
 #include "cave/colors.hpp"
@@ -58,12 +61,27 @@ protected:
     /// The size of the loaded pixbufs
     unsigned cell_size;
 
+    /// SHA-1 of the contents of the loaded theme file, or "builtin".
+    std::string theme_digest;
+
     /// The cache to store the pixbufs already rendered.
     std::unique_ptr<Pixbuf> cells_pixbufs[NUM_OF_CELLS];
 
     /// The cache to store the pixbufs already rendered.
     std::unique_ptr<Pixmap> cells[3 * NUM_OF_CELLS];
 
+    /// Scaled pixbufs rendered in advance by prewarm(); cell() converts them to pixmaps.
+    std::unique_ptr<Pixbuf> cells_prewarmed[3 * NUM_OF_CELLS];
+
+    /// The background job started by prewarm().
+    struct PrewarmJob;
+    std::unique_ptr<PrewarmJob> prewarm_job;
+
+    /// A colorized theme kept for later, with the cells already rendered from it.
+    struct PaletteCacheEntry;
+    /// The colorized themes of the palettes used recently. The front is the most recently used.
+    std::list<std::unique_ptr<PaletteCacheEntry>> palette_cache;
+
     /// If using c64 gfx, these store the current color theme.
     GdColor color0, color1, color2, color3, color4, color5;
 
@@ -71,6 +89,11 @@ protected:
     bool loadcells_image(std::unique_ptr<Pixbuf> loadcells_image);
     bool loadcells_file(const std::string &filename);
     virtual void remove_cached();
+    void prewarm_collect();
+    void prewarm_stop();
+    void remove_pixmaps();
+    void palette_cache_store();
+    void palette_cache_restore();
 
 public:
     /// The Screen for which the CellRenderer is drawing.
@@ -83,18 +106,33 @@ public:
     virtual void release_pixmaps();
 
     /// Destructor.
-    virtual ~CellRenderer() = default;
+    virtual ~CellRenderer();
 
     /// @brief Loads a new theme.
     /// The theme_file can be a file name of a png file, or empty.
     void load_theme_file(const std::string &theme_file);
 
+    /// @brief Returns a digest of the loaded theme.
+    /// It changes if the contents of the theme file change, so it can be
+    /// part of the key of images cached on the disk.
+    std::string const &get_theme_digest() const {
+        return theme_digest;
+    }
+
     /// @brief Returns a particular cell.
     Pixbuf &cell_pixbuf(unsigned i);
 
     /// @brief Returns a particular cell.
     Pixmap &cell(unsigned i);
 
+    /// @brief Render the given cells in a background thread.
+    /// The cells are colorized (if needed) and scaled for the current screen settings,
+    /// and cell() will take them when they are first drawn, instead of rendering them
+    /// then. The results are published all at once, when the thread has finished.
+    /// Changing the colors or the theme, or releasing the pixmaps cancels the job.
+    /// @param indexes The cells to render, as given to cell().
+    void prewarm(std::vector<unsigned> const &indexes);
+
     /// @brief Returns the size of the pixmaps stored.
     /// They are squares, so there is only one function, not two for width and height.
     int get_cell_size();
@@ -151,62 +151,59 @@ FontManager::FontManager(Screen &screen, const std::string &theme_file)
 
 FontManager::container::const_iterator FontManager::find(const GdColor &c, bool widefont) {
     container &cnt = widefont ? wide : narrow;
-    
-    // find font in list
-    container::iterator it = find_if(cnt.begin(), cnt.end(), [uint = c.get_uint_0rgb()] (RenderedFont const &f) {
-        return f.uint == uint;
-    });
-    if (it == cnt.end()) {
+    std::unordered_map<guint32, container::iterator> &index = widefont ? wide_index : narrow_index;
+    guint32 uint = c.get_uint_0rgb();
+
+    // find font in the index
+    auto found = index.find(uint);
+    if (found == index.end()) {
         // if not found, create it
         cnt.push_front(RenderedFont(font, font_size, widefont, c, screen));
+        index[uint] = cnt.begin();
         // if list became too long, remove one from the end
-        if (cnt.size() > 8)
+        if (cnt.size() > max_cached_fonts) {
+            index.erase(cnt.back().uint);
             cnt.pop_back();
+        }
     } else {
         // put the font found to the beginning of the list
-        cnt.splice(cnt.begin(), cnt, it);
+        cnt.splice(cnt.begin(), cnt, found->second);
     }
     return cnt.begin();
 }
 
-/* function which draws characters on the screen. used internally. */
-/* x=-1 -> center horizontally */
-int FontManager::blittext_internal(int x, int y, char const *text, bool widefont) {
+/* process a piece of text for drawing: normalize, convert to characters of the
+ * font and calculate their positions. the result does not depend on the color
+ * or the size of the font, so it can be reused every time the text is drawn. */
+FontManager::TextLayout FontManager::layout_text(char const *text) {
     AutoGFreePtr<char> normalized(g_utf8_normalize(text, -1, G_NORMALIZE_ALL));
     AutoGFreePtr<gunichar> ucs(g_utf8_to_ucs4(normalized, -1, NULL, NULL, NULL));
+    TextLayout layout;
 
-    container::const_iterator font = find(current_color, widefont);
-    int w = font->get_character(' ').get_width();
-    int h = get_line_height();
-
-    if (x == -1) {
-        gunichar c;
-        int len = 0;
-        for (int i = 0; (c = ucs[i]) != '\0'; ++i) {
-            if (c == GD_COLOR_SETCOLOR)
-                i += 1; /* do not count; skip next char */
-            else if (c >= 0x300 && c < 0x370)
-                ;       /* do not count, diacritical. */
-            else
-                len++;  /* count char */
-        }
-        x = screen.get_width() / 2 - (w * len) / 2;
+    /* length for centering */
+    gunichar c;
+    for (int i = 0; (c = ucs[i]) != '\0'; ++i) {
+        if (c == GD_COLOR_SETCOLOR)
+            i += 1; /* do not count; skip next char */
+        else if (c >= 0x300 && c < 0x370)
+            ;       /* do not count, diacritical. */
+        else
+            layout.centered_length++;  /* count char */
     }
 
-    int xc = x;
-    gunichar c;
+    int col = 0, line = 0;
     for (int i = 0; (c = ucs[i]) != '\0'; ++i) {
         if (c >= 0x300 && c < 0x370) {
             // unicode diacritical mark block
             switch (c) {
                 case 0x301:
-                    screen.blit(font->get_character(GD_ACUTE_CHAR), xc - w, y);
+                    layout.chars.push_back({col - 1, line, GD_ACUTE_CHAR, layout.final_color});
                     break;
                 case 0x308:
-                    screen.blit(font->get_character(GD_UMLAUT_CHAR), xc - w, y);
+                    layout.chars.push_back({col - 1, line, GD_UMLAUT_CHAR, layout.final_color});
                     break;
                 case 0x30B:
-                    screen.blit(font->get_character(GD_DOUBLE_ACUTE_CHAR), xc - w, y);
+                    layout.chars.push_back({col - 1, line, GD_DOUBLE_ACUTE_CHAR, layout.final_color});
                     break;
             }
             continue;
@@ -216,9 +213,7 @@ int FontManager::blittext_internal(int x, int y, char const *text, bool widefont
             i++;
             c = ucs[i];
             /* 64 was added in colors.hpp, now subtract it */
-            c -= 64;
-            current_color = GdColor::from_gdash_index(c);
-            font = find(current_color, widefont);
+            layout.final_color = c - 64;
 
             continue;
         }
@@ -315,32 +310,74 @@ int FontManager::blittext_internal(int x, int y, char const *text, bool widefont
         }
 
         if (c == '\n') { /* if it is an enter */
-            y += h;
-            xc = x;
+            line++;
+            col = 0;
         } else
         if (c == '\t') { /* if it a tabulator */
             do {
-                xc += w;
-            } while ((xc - x) / w % 8 != 0);
+                col++;
+            } while (col % 8 != 0);
         } else {
-            gunichar i;
+            int i;
 
             if (c < RenderedFont::NUM_OF_CHARS)
                 i = c;
             else
                 i = GD_UNKNOWN_CHAR;
 
-            screen.blit(font->get_character(i), xc, y);
-            xc += w;
+            layout.chars.push_back({col, line, i, layout.final_color});
+            col++;
+        }
+    }
+    layout.end_col = col;
+
+    return layout;
+}
+
+FontManager::TextLayout const &FontManager::get_layout(char const *text) {
+    auto found = layouts.find(text);
+    if (found != layouts.end())
+        return found->second;
+    /* texts with changing numbers in them would fill the cache, so it is simply
+     * emptied when full. */
+    if (layouts.size() >= max_cached_layouts)
+        layouts.clear();
+    return layouts.emplace(text, layout_text(text)).first->second;
+}
+
+/* function which draws characters on the screen. used internally. */
+/* x=-1 -> center horizontally */
+int FontManager::blittext_internal(int x, int y, char const *text, bool widefont) {
+    TextLayout const &layout = get_layout(text);
+
+    container::const_iterator font = find(current_color, widefont);
+    int w = font->get_character(' ').get_width();
+    int h = get_line_height();
+
+    if (x == -1)
+        x = screen.get_width() / 2 - (w * layout.centered_length) / 2;
+
+    GdColor const initial_color = current_color;
+    int color = -1;
+    for (LaidOutChar const &c : layout.chars) {
+        if (c.color != color) {
+            color = c.color;
+            font = find(color == -1 ? initial_color : GdColor::from_gdash_index(color), widefont);
         }
+        screen.blit(font->get_character(c.character), x + c.col * w, y + c.line * h);
     }
+    /* the color set by the text remains for the next piece of text */
+    if (layout.final_color != -1)
+        current_color = GdColor::from_gdash_index(layout.final_color);
 
-    return xc;
+    return x + layout.end_col * w;
 }
 
 void FontManager::release_pixmaps() {
     narrow.clear();
     wide.clear();
+    narrow_index.clear();
+    wide_index.clear();
 }
 
 int FontManager::get_font_height() const {
@@ -27,6 +27,7 @@
 #define FONTMANAGER_HPP_INCLUDED
 
 #include <list>
+#include <unordered_map>
 #include <glib.h>
 #include <string>
 #include <vector>
@@ -151,12 +152,47 @@ private:
     /// The Screen on which this FontManager is working.
     Screen &screen;
 
-    /// Rendered fonts are stored in a list for caching.
+    /// Rendered fonts are stored in a list for caching, the most recently used first.
     typedef std::list<RenderedFont> container;
     
     /// Cached fonts for narrow and wide letters.
     container narrow, wide;
 
+    /// Cached fonts by GdColor::get_uint_0rgb(), so they are found without searching the list.
+    std::unordered_map<guint32, container::iterator> narrow_index, wide_index;
+
+    /// Maximum number of colors for which the narrow and the wide fonts are cached.
+    /// As the glyphs are rendered on demand, a color costs only the glyphs drawn with it.
+    static const unsigned max_cached_fonts = 32;
+
+    /// A character of a laid out text. Its position is given in character cells
+    /// from the start of the text, so it does not depend on the size of the font.
+    struct LaidOutChar {
+        int col, line;
+        int character;      ///< Code of the character in the font.
+        int color;          ///< GDash color index set by the text, or -1 for the color set before drawing.
+    };
+
+    /// A piece of text, processed for drawing by layout_text().
+    struct TextLayout {
+        std::vector<LaidOutChar> chars;
+        int centered_length = 0;  ///< Number of characters counted when centering the text.
+        int end_col = 0;          ///< Column of the cursor after drawing the text.
+        int final_color = -1;     ///< GDash color index of the last color change in the text, or -1.
+    };
+
+    /// Laid out texts, so drawing the same text again needs no unicode processing.
+    std::unordered_map<std::string, TextLayout> layouts;
+
+    /// Maximum number of texts in the layout cache.
+    static const unsigned max_cached_layouts = 256;
+
+    /// @brief Normalize a UTF8 text and convert it to positioned characters of the font.
+    static TextLayout layout_text(char const *text);
+
+    /// @brief Return the layout of a text, from the cache or newly created.
+    TextLayout const &get_layout(char const *text);
+
     /// @brief Return with the narrow/wide rendered font.
     /// If it does not exist yet, create. If too many
     /// rendered characters are in the cache, delete the
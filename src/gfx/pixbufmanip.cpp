@@ -25,53 +25,173 @@
 
 #include <cstring>
 #include <cmath>
+#include <algorithm>
+#include <vector>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
+#include "gfx/pixbufmanip.hpp"
 #include "settings.hpp"
 #include "gfx/pixbuf.hpp"
 #include "cave/colors.hpp"
 
-/* somewhat optimized implementation of the Scale2x algorithm. */
-/* http://scale2x.sourceforge.net */
-void scale2x(const Pixbuf &src, Pixbuf &dest) {
-    int sh = src.get_height(), sw = src.get_width();
+/* the worker threads used by pixbuf_process_row_bands. */
+struct RowBands {
+    std::function<void(int, int)> const &func;
+    GMutex mutex;
+    GCond cond;
+    int remaining;
 
-    for (int y = 0; y < sh; ++y) {
-        // wraparound
-        int ym = (y + sh - 1) % sh;
-        int yp = (y + sh + 1) % sh;
-
-        for (int x = 0; x < sw; ++x) {
-            int xm = (x + sw - 1) % sw;
-            int xp = (x + sw + 1) % sw;
-
-            guint32 B = src(x, ym);
-            guint32 D = src(xm, y);
-            guint32 E = src(x, y);
-            guint32 F = src(xp, y);
-            guint32 H = src(x, yp);
-
-            guint32 E0, E1, E2, E3;
-            if (B != H && D != F) {
-                E0 = D == B ? D : E;
-                E1 = B == F ? F : E;
-                E2 = D == H ? D : E;
-                E3 = H == F ? F : E;
-            } else {
-                E0 = E;
-                E1 = E;
-                E2 = E;
-                E3 = E;
-            }
+    explicit RowBands(std::function<void(int, int)> const &func) : func(func), remaining(0) {
+        g_mutex_init(&mutex);
+        g_cond_init(&cond);
+    }
+    ~RowBands() {
+        g_cond_clear(&cond);
+        g_mutex_clear(&mutex);
+    }
+};
+
+struct RowBand {
+    RowBands *bands;
+    int y1, y2;
+};
+
+static void row_band_thread_func(gpointer data, gpointer) {
+    RowBand *band = static_cast<RowBand *>(data);
+    band->bands->func(band->y1, band->y2);
+    g_mutex_lock(&band->bands->mutex);
+    if (--band->bands->remaining == 0)
+        g_cond_signal(&band->bands->cond);
+    g_mutex_unlock(&band->bands->mutex);
+}
+
+
+void pixbuf_process_row_bands(int width, int height, std::function<void(int, int)> const &func) {
+    /* smaller images (like cells) are not worth the synchronization */
+    static int const min_pixels_per_band = 128 * 128;
+    static int const num_bands = g_get_num_processors();
+    static GThreadPool *pool = num_bands > 1 ? g_thread_pool_new(row_band_thread_func, NULL, num_bands, FALSE, NULL) : NULL;
 
-            dest(x * 2, y * 2) = E0;
-            dest(x * 2 + 1, y * 2) = E1;
-            dest(x * 2, y * 2 + 1) = E2;
-            dest(x * 2 + 1, y * 2 + 1) = E3;
+    int bands = std::min(num_bands, width * height / min_pixels_per_band);
+    bands = std::min(bands, height);
+    if (pool == NULL || bands < 2) {
+        func(0, height);
+        return;
+    }
+
+    /* the first band is processed by the calling thread, the others by the pool */
+    RowBands rowbands(func);
+    std::vector<RowBand> work(bands);
+    for (int i = 0; i < bands; ++i) {
+        work[i].bands = &rowbands;
+        work[i].y1 = height * i / bands;
+        work[i].y2 = height * (i + 1) / bands;
+    }
+    rowbands.remaining = bands - 1;
+    for (int i = 1; i < bands; ++i)
+        g_thread_pool_push(pool, &work[i], NULL);
+    func(work[0].y1, work[0].y2);
+    g_mutex_lock(&rowbands.mutex);
+    while (rowbands.remaining > 0)
+        g_cond_wait(&rowbands.cond, &rowbands.mutex);
+    g_mutex_unlock(&rowbands.mutex);
+}
+
+
+/* one pixel of scale2x. rowm, row and rowp are the row above, the row of the pixel
+ * and the row below; xm and xp are the columns left and right to x (with wraparound).
+ * d0 and d1 are the two destination rows. */
+static inline void scale2x_pixel(guint32 const *rowm, guint32 const *row, guint32 const *rowp, int xm, int x, int xp, guint32 *d0, guint32 *d1) {
+    guint32 B = rowm[x];
+    guint32 D = row[xm];
+    guint32 E = row[x];
+    guint32 F = row[xp];
+    guint32 H = rowp[x];
+
+    if (B != H && D != F) {
+        d0[x * 2] = D == B ? D : E;
+        d0[x * 2 + 1] = B == F ? F : E;
+        d1[x * 2] = D == H ? D : E;
+        d1[x * 2 + 1] = H == F ? F : E;
+    } else {
+        d0[x * 2] = E;
+        d0[x * 2 + 1] = E;
+        d1[x * 2] = E;
+        d1[x * 2 + 1] = E;
+    }
+}
+
+
+#ifdef __SSE2__
+/* select a where the mask is set, b otherwise */
+static inline __m128i sse2_select(__m128i mask, __m128i a, __m128i b) {
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+#endif
+
+
+static void scale2x_rows(const Pixbuf &src, Pixbuf &dest, int y1, int y2) {
+    int const sh = src.get_height(), sw = src.get_width();
+    unsigned char const *srcpixels = src.get_pixels();
+    int const srcpitch = src.get_pitch();
+    unsigned char *destpixels = dest.get_pixels();
+    int const destpitch = dest.get_pitch();
+
+    for (int y = y1; y < y2; ++y) {
+        // wraparound
+        int ym = y == 0 ? sh - 1 : y - 1;
+        int yp = y == sh - 1 ? 0 : y + 1;
+        guint32 const *rowm = reinterpret_cast<guint32 const *>(srcpixels + ym * srcpitch);
+        guint32 const *row = reinterpret_cast<guint32 const *>(srcpixels + y * srcpitch);
+        guint32 const *rowp = reinterpret_cast<guint32 const *>(srcpixels + yp * srcpitch);
+        guint32 *d0 = reinterpret_cast<guint32 *>(destpixels + y * 2 * destpitch);
+        guint32 *d1 = reinterpret_cast<guint32 *>(destpixels + (y * 2 + 1) * destpitch);
+
+        /* left edge, wraparound */
+        scale2x_pixel(rowm, row, rowp, sw - 1, 0, 1 % sw, d0, d1);
+        int x = 1;
+#ifdef __SSE2__
+        /* four pixels at a time, as long as x+1..x+4 is inside the row */
+        for (; x + 4 < sw; x += 4) {
+            __m128i B = _mm_loadu_si128(reinterpret_cast<__m128i const *>(rowm + x));
+            __m128i D = _mm_loadu_si128(reinterpret_cast<__m128i const *>(row + x - 1));
+            __m128i E = _mm_loadu_si128(reinterpret_cast<__m128i const *>(row + x));
+            __m128i F = _mm_loadu_si128(reinterpret_cast<__m128i const *>(row + x + 1));
+            __m128i H = _mm_loadu_si128(reinterpret_cast<__m128i const *>(rowp + x));
+
+            /* the pixels where B == H or D == F are simply copied */
+            __m128i copy = _mm_or_si128(_mm_cmpeq_epi32(B, H), _mm_cmpeq_epi32(D, F));
+            __m128i E0 = sse2_select(_mm_andnot_si128(copy, _mm_cmpeq_epi32(D, B)), D, E);
+            __m128i E1 = sse2_select(_mm_andnot_si128(copy, _mm_cmpeq_epi32(B, F)), F, E);
+            __m128i E2 = sse2_select(_mm_andnot_si128(copy, _mm_cmpeq_epi32(D, H)), D, E);
+            __m128i E3 = sse2_select(_mm_andnot_si128(copy, _mm_cmpeq_epi32(H, F)), F, E);
+
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(d0 + x * 2), _mm_unpacklo_epi32(E0, E1));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(d0 + x * 2 + 4), _mm_unpackhi_epi32(E0, E1));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(d1 + x * 2), _mm_unpacklo_epi32(E2, E3));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(d1 + x * 2 + 4), _mm_unpackhi_epi32(E2, E3));
         }
+#endif
+        for (; x < sw - 1; ++x)
+            scale2x_pixel(rowm, row, rowp, x - 1, x, x + 1, d0, d1);
+        /* right edge, wraparound */
+        if (sw > 1)
+            scale2x_pixel(rowm, row, rowp, sw - 2, sw - 1, 0, d0, d1);
     }
 }
 
 
+/* somewhat optimized implementation of the Scale2x algorithm. */
+/* http://scale2x.sourceforge.net */
+void scale2x(const Pixbuf &src, Pixbuf &dest) {
+    pixbuf_process_row_bands(src.get_width(), src.get_height(), [&](int y1, int y2) {
+        scale2x_rows(src, dest, y1, y2);
+    });
+}
+
+
 void scale2xnearest(const Pixbuf &src, Pixbuf &dest) {
     int const width = src.get_width(), height = src.get_height();
     for (int y = 0; y < height; ++y) {
@@ -109,67 +229,124 @@ void scale3xnearest(const Pixbuf &src, Pixbuf &dest) {
 }
 
 
-void scale3x(const Pixbuf &src, Pixbuf &dest) {
-    int sh = src.get_height(), sw = src.get_width();
+/* one pixel of scale3x. see scale2x_pixel() for the parameters; d0, d1 and d2 are the three destination rows. */
+static inline void scale3x_pixel(guint32 const *rowm, guint32 const *row, guint32 const *rowp, int xm, int x, int xp, guint32 *d0, guint32 *d1, guint32 *d2) {
+    guint32 A = rowm[xm];
+    guint32 B = rowm[x];
+    guint32 C = rowm[xp];
+    guint32 D = row[xm];
+    guint32 E = row[x];
+    guint32 F = row[xp];
+    guint32 G = rowp[xm];
+    guint32 H = rowp[x];
+    guint32 I = rowp[xp];
+    int nx = x * 3; /* new coordinate */
+
+    if (B != H && D != F) {
+        d0[nx] = D == B ? D : E;
+        d0[nx + 1] = (D == B && E != C) || (B == F && E != A) ? B : E;
+        d0[nx + 2] = B == F ? F : E;
+        d1[nx] = (D == B && E != G) || (D == H && E != A) ? D : E;
+        d1[nx + 1] = E;
+        d1[nx + 2] = (B == F && E != I) || (H == F && E != C) ? F : E;
+        d2[nx] = D == H ? D : E;
+        d2[nx + 1] = (D == H && E != I) || (H == F && E != G) ? H : E;
+        d2[nx + 2] = H == F ? F : E;
+    } else {
+        d0[nx] = d0[nx + 1] = d0[nx + 2] = E;
+        d1[nx] = d1[nx + 1] = d1[nx + 2] = E;
+        d2[nx] = d2[nx + 1] = d2[nx + 2] = E;
+    }
+}
 
-    for (int y = 0; y < sh; ++y) {
-        int ny = y * 3; /* new coordinate */
+
+static void scale3x_rows(const Pixbuf &src, Pixbuf &dest, int y1, int y2) {
+    int const sh = src.get_height(), sw = src.get_width();
+    unsigned char const *srcpixels = src.get_pixels();
+    int const srcpitch = src.get_pitch();
+    unsigned char *destpixels = dest.get_pixels();
+    int const destpitch = dest.get_pitch();
+
+    for (int y = y1; y < y2; ++y) {
         // wraparound
-        int ym = (y + sh - 1) % sh;
-        int yp = (y + sh + 1) % sh;
-
-        for (int x = 0; x < sw; ++x) {
-            int nx = x * 3; /* new coordinate */
-            int xm = (x + sw - 1) % sw;
-            int xp = (x + sw + 1) % sw;
-
-            guint32 A = src(xm, ym);
-            guint32 B = src(x, ym);
-            guint32 C = src(xp, ym);
-            guint32 D = src(xm, y);
-            guint32 E = src(x, y);
-            guint32 F = src(xp, y);
-            guint32 G = src(xm, yp);
-            guint32 H = src(x, yp);
-            guint32 I = src(xp, yp);
-
-            guint32 E0, E1, E2, E3, E4, E5, E6, E7, E8;
-            if (B != H && D != F) {
-                E0 = D == B ? D : E;
-                E1 = (D == B && E != C) || (B == F && E != A) ? B : E;
-                E2 = B == F ? F : E;
-                E3 = (D == B && E != G) || (D == H && E != A) ? D : E;
-                E4 = E;
-                E5 = (B == F && E != I) || (H == F && E != C) ? F : E;
-                E6 = D == H ? D : E;
-                E7 = (D == H && E != I) || (H == F && E != G) ? H : E;
-                E8 = H == F ? F : E;
-            } else {
-                E0 = E;
-                E1 = E;
-                E2 = E;
-                E3 = E;
-                E4 = E;
-                E5 = E;
-                E6 = E;
-                E7 = E;
-                E8 = E;
+        int ym = y == 0 ? sh - 1 : y - 1;
+        int yp = y == sh - 1 ? 0 : y + 1;
+        guint32 const *rowm = reinterpret_cast<guint32 const *>(srcpixels + ym * srcpitch);
+        guint32 const *row = reinterpret_cast<guint32 const *>(srcpixels + y * srcpitch);
+        guint32 const *rowp = reinterpret_cast<guint32 const *>(srcpixels + yp * srcpitch);
+        guint32 *d0 = reinterpret_cast<guint32 *>(destpixels + y * 3 * destpitch);
+        guint32 *d1 = reinterpret_cast<guint32 *>(destpixels + (y * 3 + 1) * destpitch);
+        guint32 *d2 = reinterpret_cast<guint32 *>(destpixels + (y * 3 + 2) * destpitch);
+
+        /* left edge, wraparound */
+        scale3x_pixel(rowm, row, rowp, sw - 1, 0, 1 % sw, d0, d1, d2);
+        int x = 1;
+#ifdef __SSE2__
+        /* four pixels at a time, as long as x+1..x+4 is inside the row */
+        for (; x + 4 < sw; x += 4) {
+            __m128i A = _mm_loadu_si128(reinterpret_cast<__m128i const *>(rowm + x - 1));
+            __m128i B = _mm_loadu_si128(reinterpret_cast<__m128i const *>(rowm + x));
+            __m128i C = _mm_loadu_si128(reinterpret_cast<__m128i const *>(rowm + x + 1));
+            __m128i D = _mm_loadu_si128(reinterpret_cast<__m128i const *>(row + x - 1));
+            __m128i E = _mm_loadu_si128(reinterpret_cast<__m128i const *>(row + x));
+            __m128i F = _mm_loadu_si128(reinterpret_cast<__m128i const *>(row + x + 1));
+            __m128i G = _mm_loadu_si128(reinterpret_cast<__m128i const *>(rowp + x - 1));
+            __m128i H = _mm_loadu_si128(reinterpret_cast<__m128i const *>(rowp + x));
+            __m128i I = _mm_loadu_si128(reinterpret_cast<__m128i const *>(rowp + x + 1));
+
+            __m128i DB = _mm_cmpeq_epi32(D, B), BF = _mm_cmpeq_epi32(B, F);
+            __m128i DH = _mm_cmpeq_epi32(D, H), HF = _mm_cmpeq_epi32(H, F);
+            __m128i EA = _mm_cmpeq_epi32(E, A), EC = _mm_cmpeq_epi32(E, C);
+            __m128i EG = _mm_cmpeq_epi32(E, G), EI = _mm_cmpeq_epi32(E, I);
+            /* the pixels where B == H or D == F are simply copied */
+            __m128i copy = _mm_or_si128(_mm_cmpeq_epi32(B, H), _mm_cmpeq_epi32(D, F));
+
+            /* andnot(x, y) is y && !x */
+            __m128i out[9];
+            out[0] = sse2_select(_mm_andnot_si128(copy, DB), D, E);
+            out[1] = sse2_select(_mm_andnot_si128(copy, _mm_or_si128(_mm_andnot_si128(EC, DB), _mm_andnot_si128(EA, BF))), B, E);
+            out[2] = sse2_select(_mm_andnot_si128(copy, BF), F, E);
+            out[3] = sse2_select(_mm_andnot_si128(copy, _mm_or_si128(_mm_andnot_si128(EG, DB), _mm_andnot_si128(EA, DH))), D, E);
+            out[4] = E;
+            out[5] = sse2_select(_mm_andnot_si128(copy, _mm_or_si128(_mm_andnot_si128(EI, BF), _mm_andnot_si128(EC, HF))), F, E);
+            out[6] = sse2_select(_mm_andnot_si128(copy, DH), D, E);
+            out[7] = sse2_select(_mm_andnot_si128(copy, _mm_or_si128(_mm_andnot_si128(EI, DH), _mm_andnot_si128(EG, HF))), H, E);
+            out[8] = sse2_select(_mm_andnot_si128(copy, HF), F, E);
+
+            /* sse2 has no three-way interleave, so the results are written pixel by pixel */
+            guint32 e[9][4];
+            for (int i = 0; i < 9; ++i)
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(e[i]), out[i]);
+            for (int i = 0; i < 4; ++i) {
+                int nx = (x + i) * 3;
+                d0[nx] = e[0][i];
+                d0[nx + 1] = e[1][i];
+                d0[nx + 2] = e[2][i];
+                d1[nx] = e[3][i];
+                d1[nx + 1] = e[4][i];
+                d1[nx + 2] = e[5][i];
+                d2[nx] = e[6][i];
+                d2[nx + 1] = e[7][i];
+                d2[nx + 2] = e[8][i];
             }
-
-            dest(nx, ny) = E0;
-            dest(nx + 1, ny) = E1;
-            dest(nx + 2, ny) = E2;
-            dest(nx, ny + 1) = E3;
-            dest(nx + 1, ny + 1) = E4;
-            dest(nx + 2, ny + 1) = E5;
-            dest(nx, ny + 2) = E6;
-            dest(nx + 1, ny + 2) = E7;
-            dest(nx + 2, ny + 2) = E8;
         }
+#endif
+        for (; x < sw - 1; ++x)
+            scale3x_pixel(rowm, row, rowp, x - 1, x, x + 1, d0, d1, d2);
+        /* right edge, wraparound */
+        if (sw > 1)
+            scale3x_pixel(rowm, row, rowp, sw - 2, sw - 1, 0, d0, d1, d2);
     }
 }
 
 
+void scale3x(const Pixbuf &src, Pixbuf &dest) {
+    pixbuf_process_row_bands(src.get_width(), src.get_height(), [&](int y1, int y2) {
+        scale3x_rows(src, dest, y1, y2);
+    });
+}
+
+
 /* pal emulation for 32-bit rgba images. */
 
 /* used:
@@ -192,12 +369,20 @@ void scale3x(const Pixbuf &src, Pixbuf &dest) {
     256*b=u+y
 */
 
-struct YUV {
-    /* we use values *256 here for fixed point math, so 8bits is not enough */
-    gint32 y, u, v;
-};
+/* the filters work on a single row of y, u, v or alpha values; the values are *256
+ * for fixed point math, so 8 bits is not enough. rows passed to the filters are padded
+ * with two wrapped-around values on both sides, so row[-2] and row[width+1] can be read. */
+static int const pal_row_padding = 2;
+
+static void wrap_pad(gint32 *row, int width) {
+    for (int p = 1; p <= pal_row_padding; p++) {
+        row[-p] = row[((-p % width) + width) % width];
+        row[width - 1 + p] = row[(width - 1 + p) % width];
+    }
+}
 
-static void luma_blur(YUV **yuv, YUV **work, int width, int height) {
+
+static void luma_blur(gint32 const *in, gint32 *out, int width) {
     /* convolution "matrices" could be 5 numbers, ie. x-2, x-1, x, x+1, x+2... */
     /* but the output already has problems for x-1 and x+1. as the game only
        pal_emus cells, not complete screens - so they are only 3 pixels wide */
@@ -208,130 +393,66 @@ static void luma_blur(YUV **yuv, YUV **work, int width, int height) {
     /* for right edge of image. */
     static const int lconv_right[] = { 6, 10, 1, }, ldiv_right = lconv_right[0] + lconv_right[1] + lconv_right[2];
 
-    /* apply convolution matrix */
-    /* luma blur */
-    for (int y = 0; y < height; y++) {
-        YUV n;    /* new value of this pixel in yuv */
-        int x, xm, xp;
-
-        /* for x = 0 (left edge) */
-        xm = width - 1;
-        x = 0;
-        xp = 1;
-        n.y = (yuv[y][xm].y * lconv_left[0] + yuv[y][x].y * lconv_left[1] + yuv[y][xp].y * lconv_left[2]) / ldiv_left;
-        work[y][x].y = n.y;
-
-        /* for x = 1..width-2 */
-        for (int x = 1; x < width - 1; x++) {
-            int xm = x - 1;
-            int xp = x + 1;
-            n.y = (yuv[y][xm].y * lconv[0] + yuv[y][x].y * lconv[1] + yuv[y][xp].y * lconv[2]) / ldiv;
-            work[y][x].y = n.y;
-        }
-
-        /* for x = width-1 (right edge) */
-        xm = width - 2;
-        x = width - 1;
-        xp = 0;
-        n.y = (yuv[y][xm].y * lconv_right[0] + yuv[y][x].y * lconv_right[1] + yuv[y][xp].y * lconv_right[2]) / ldiv_right;
-        work[y][x].y = n.y;
-    }
-
-    for (int y = 0; y < height; y++)
-        for (int x = 0; x < width; x++)
-            yuv[y][x].y = work[y][x].y;
+    /* left edge */
+    out[0] = (in[width - 1] * lconv_left[0] + in[0] * lconv_left[1] + in[1] * lconv_left[2]) / ldiv_left;
+    /* x = 1..width-2, no wraparound here, so the compiler can vectorize the loop */
+    for (int x = 1; x < width - 1; x++)
+        out[x] = (in[x - 1] * lconv[0] + in[x] * lconv[1] + in[x + 1] * lconv[2]) / ldiv;
+    /* right edge */
+    out[width - 1] = (in[width - 2] * lconv_right[0] + in[width - 1] * lconv_right[1] + in[width] * lconv_right[2]) / ldiv_right;
 }
 
 
-static void chroma_blur(YUV **yuv, YUV **work, int width, int height) {
+static void chroma_blur(gint32 const *in, gint32 *out, int width) {
     /* convolution "matrix" for chrominance */
     /* x-2, x-1, x, x+1, x+2 */
     static const int cconv[] = { 1, 1, 1, 1, 1, }, cdiv = cconv[0] + cconv[1] + cconv[2] + cconv[3] + cconv[4];
 
-    /* apply convolution matrix */
-    for (int y = 0; y < height; y++) {
-        for (int x = 0; x < width; x++) {
-            int xm, xm2, xp, xp2;
-
-            /* turnaround coordinates */
-            xm2 = (x - 2 + width) % width;
-            xm = (x - 1 + width) % width;
-            xp = (x + 1) % width;
-            xp2 = (x + 2) % width;
-
-            /* chroma blur */
-            work[y][x].u = (yuv[y][xm2].u * cconv[0] + yuv[y][xm].u * cconv[1] + yuv[y][x].u * cconv[2] + yuv[y][xp].u * cconv[3] + yuv[y][xp2].u * cconv[4]) / cdiv;
-            work[y][x].v = (yuv[y][xm2].v * cconv[0] + yuv[y][xm].v * cconv[1] + yuv[y][x].v * cconv[2] + yuv[y][xp].v * cconv[3] + yuv[y][xp2].v * cconv[4]) / cdiv;
-        }
-    }
-
-    for (int y = 0; y < height; y++)
-        for (int x = 0; x < width; x++) {
-            yuv[y][x].u = work[y][x].u;
-            yuv[y][x].v = work[y][x].v;
-        }
+    for (int x = 0; x < width; x++)
+        out[x] = (in[x - 2] * cconv[0] + in[x - 1] * cconv[1] + in[x] * cconv[2] + in[x + 1] * cconv[3] + in[x + 2] * cconv[4]) / cdiv;
 }
 
+
 #define CROSSTALK_SIZE 16
 
-static void chroma_crosstalk_to_luma(YUV **yuv, YUV **work, int width, int height) {
-    /* arrays to store things */
-    static int crosstalk_sin[CROSSTALK_SIZE];
-    static int crosstalk_cos[CROSSTALK_SIZE];
+struct CrosstalkTable {
     /* crosstalk will be amplitude/div; we use these two to have integer arithmetics */
-    const int crosstalk_amplitude = 384;
-    const int crosstalk_div = 256;
-    static bool crosstalk_calculated = false;
+    static const int amplitude = 384;
+    static const int div = 256;
+    int sin[CROSSTALK_SIZE];
+    int cos[CROSSTALK_SIZE];
 
-    if (!crosstalk_calculated) {
-        crosstalk_calculated = true;
+    CrosstalkTable() {
         for (int i = 0; i < CROSSTALK_SIZE; i++) {
             double f = (double)i / CROSSTALK_SIZE * 2.0 * G_PI * 2;
-            crosstalk_sin[i] = crosstalk_amplitude * sin(f);
-            crosstalk_cos[i] = crosstalk_amplitude * cos(f);
+            sin[i] = amplitude * ::sin(f);
+            cos[i] = amplitude * ::cos(f);
         }
     }
+};
 
-    /* apply edge detection matrix */
-    for (int y = 0; y < height; y++) {
-        for (int x = 0; x < width; x++) {
-            const int conv[] = { -1, 1, 0, 0, 0,};
-
-            /* turnaround coordinates */
-            int xm2 = (x - 2 + width) % width;
-            int xm = (x - 1 + width) % width;
-            int xp = (x + 1) % width;
-            int xp2 = (x + 2) % width;
-
-            /* edge detect */
-            work[y][x].u = yuv[y][xm2].u * conv[0] + yuv[y][xm].u * conv[1] + yuv[y][x].u * conv[2] + yuv[y][xp].u * conv[3] + yuv[y][xp2].u * conv[4];
-            work[y][x].v = yuv[y][xm2].v * conv[0] + yuv[y][xm].v * conv[1] + yuv[y][x].v * conv[2] + yuv[y][xp].v * conv[3] + yuv[y][xp2].v * conv[4];
-        }
+static void chroma_crosstalk_to_luma(gint32 const *u, gint32 const *v, gint32 *y, int width, int row) {
+    /* initialized once, even if more threads get here at the same time */
+    static CrosstalkTable const crosstalk;
+    /* edge detection matrix */
+    static const int conv[] = { -1, 1, 0, 0, 0, };
+    /* rows 3&4 */
+    int const vsign = row / 2 % 2 == 1 ? -1 : 1;
+
+    for (int x = 0; x < width; x++) {
+        /* edge detect */
+        int eu = u[x - 2] * conv[0] + u[x - 1] * conv[1] + u[x] * conv[2] + u[x + 1] * conv[3] + u[x + 2] * conv[4];
+        int ev = v[x - 2] * conv[0] + v[x - 1] * conv[1] + v[x] * conv[2] + v[x + 1] * conv[3] + v[x + 2] * conv[4];
+        y[x] += (crosstalk.sin[x % CROSSTALK_SIZE] * eu + vsign * crosstalk.cos[x % CROSSTALK_SIZE] * ev) / crosstalk.div;
     }
-
-    for (int y = 0; y < height; y++)
-        if (y / 2 % 2 == 1) /* rows 3&4 */
-            for (int x = 0; x < width; x++)
-                yuv[y][x].y += (crosstalk_sin[x % CROSSTALK_SIZE] * work[y][x].u - crosstalk_cos[x % CROSSTALK_SIZE] * work[y][x].v) / crosstalk_div; /* odd lines (/2) */
-        else          /* rows 1&2 */
-            for (int x = 0; x < width; x++)
-                yuv[y][x].y += (crosstalk_sin[x % CROSSTALK_SIZE] * work[y][x].u + crosstalk_cos[x % CROSSTALK_SIZE] * work[y][x].v) / crosstalk_div; /* even lines (/2) */
 }
 
 #undef CROSSTALK_SIZE
 
 
-static void scanline_shade(YUV **yuv, YUV **work, int width, int height) {
-    if (gd_pal_emu_scanline_shade < 0)
-        gd_pal_emu_scanline_shade = 0;
-    if (gd_pal_emu_scanline_shade > 100)
-        gd_pal_emu_scanline_shade = 100;
-    int shade = gd_pal_emu_scanline_shade * 256 / 100;
-
-    /* apply shade for every second row */
-    for (int y = 1; y < height; y += 2)
-        for (int x = 0; x < width; x++)
-            yuv[y][x].y = yuv[y][x].y * shade / 256;
+static void scanline_shade(gint32 *y, int width, int shade) {
+    for (int x = 0; x < width; x++)
+        y[x] = y[x] * shade / 256;
 }
 
 
@@ -343,74 +464,77 @@ static inline int clamp(int value, int min, int max) {
     return value;
 }
 
-void pal_emulate(Pixbuf &pb) {
-    int width = pb.get_width();
-    int height = pb.get_height();
 
-    /* memory for yuv images */
-    YUV **yuv = new YUV*[height];
-    for (int y = 0; y < height; y++)
-        yuv[y] = new YUV[width];
-    YUV **work = new YUV*[height];
-    for (int y = 0; y < height; y++)
-        work[y] = new YUV[width];
-    YUV **alpha = new YUV*[height]; /* alpha is not really yuv, only y will be used. luma blur touches only y. */
-    for (int y = 0; y < height; y++)
-        alpha[y] = new YUV[width];
+/* pal emulation of a single row of the image, which is done in one go, while the
+ * row is in the cache. scratch must have place for 7 padded rows. */
+static void pal_emulate_row(guint32 *row, int y, int width, int shade, gint32 *scratch) {
+    int const stride = width + 2 * pal_row_padding;
+    gint32 *luma = scratch + pal_row_padding;
+    gint32 *u = luma + stride;
+    gint32 *v = u + stride;
+    gint32 *alpha = v + stride; /* alpha is not really yuv, but it is blurred like luma. */
+    gint32 *work_y = alpha + stride;
+    gint32 *work_u = work_y + stride;
+    gint32 *work_v = work_u + stride;
 
     /* convert to yuv */
-    for (int y = 0; y < height; y++) {
-        guint32 *row = pb.get_row(y);
-
-        for (int x = 0; x < width; x++) {
-            int r = (row[x] >> pb.rshift) & 0xff;
-            int g = (row[x] >> pb.gshift) & 0xff;
-            int b = (row[x] >> pb.bshift) & 0xff;
-
-            /* now y, u, v will contain values * 256 */
-            yuv[y][x].y = 77 * r + 150 * g + 29 * b; /* always pos */
-            yuv[y][x].u = -37 * r - 74 * g + 111 * b; /* pos or neg */
-            yuv[y][x].v = 157 * r - 131 * g - 26 * b; /* pos or neg */
-
-            /* alpha is copied as is, and is not *256 */
-            alpha[y][x].y = (row[x] >> pb.ashift) & 0xff;
-        }
+    for (int x = 0; x < width; x++) {
+        int r = (row[x] >> Pixbuf::rshift) & 0xff;
+        int g = (row[x] >> Pixbuf::gshift) & 0xff;
+        int b = (row[x] >> Pixbuf::bshift) & 0xff;
+
+        /* now y, u, v will contain values * 256 */
+        luma[x] = 77 * r + 150 * g + 29 * b; /* always pos */
+        u[x] = -37 * r - 74 * g + 111 * b; /* pos or neg */
+        v[x] = 157 * r - 131 * g - 26 * b; /* pos or neg */
+
+        /* alpha is copied as is, and is not *256 */
+        alpha[x] = (row[x] >> Pixbuf::ashift) & 0xff;
     }
-
-    /* we give them an array to "work" in, so that is not free()d and malloc() four times */
-    luma_blur(yuv, work, width, height);
-    chroma_blur(yuv, work, width, height);
-    chroma_crosstalk_to_luma(yuv, work, width, height);
-    scanline_shade(yuv, work, width, height);
-
-    luma_blur(alpha, work, width, height);
+    wrap_pad(luma, width);
+    wrap_pad(u, width);
+    wrap_pad(v, width);
+    wrap_pad(alpha, width);
+
+    luma_blur(luma, work_y, width);
+    chroma_blur(u, work_u, width);
+    chroma_blur(v, work_v, width);
+    wrap_pad(work_u, width);
+    wrap_pad(work_v, width);
+    chroma_crosstalk_to_luma(work_u, work_v, work_y, width, y);
+    /* apply shade for every second row */
+    if (y % 2 == 1)
+        scanline_shade(work_y, width, shade);
+    /* the original alpha is not needed anymore, so the luma buffer can take the result */
+    luma_blur(alpha, luma, width);
 
     /* convert back to rgb */
-    for (int y = 0; y < height; y++) {
-        guint32 *row = pb.get_row(y);
-
-        for (int x = 0; x < width; x++) {
-            /* back to rgb */
-            int r = clamp((256 * yuv[y][x].y                + 292 * yuv[y][x].v + 32768) / 65536, 0, 255);
-            int g = clamp((256 * yuv[y][x].y - 101 * yuv[y][x].u - 149 * yuv[y][x].v + 32768) / 65536, 0, 255);
-            int b = clamp((256 * yuv[y][x].y + 519 * yuv[y][x].u                + 32768) / 65536, 0, 255);
-
-            /* alpha channel is preserved, others are converted back from yuv */
-            row[x] = (alpha[y][x].y << pb.ashift) | (r << pb.rshift) | (g << pb.gshift) | (b << pb.bshift);
-        }
+    for (int x = 0; x < width; x++) {
+        int r = clamp((256 * work_y[x]                  + 292 * work_v[x] + 32768) / 65536, 0, 255);
+        int g = clamp((256 * work_y[x] - 101 * work_u[x] - 149 * work_v[x] + 32768) / 65536, 0, 255);
+        int b = clamp((256 * work_y[x] + 519 * work_u[x]                  + 32768) / 65536, 0, 255);
 
+        /* alpha channel is preserved, others are converted back from yuv */
+        row[x] = (luma[x] << Pixbuf::ashift) | (r << Pixbuf::rshift) | (g << Pixbuf::gshift) | (b << Pixbuf::bshift);
     }
+}
+
 
-    /* free arrays */
-    for (int y = 0; y < height; y++)
-        delete[] yuv[y];
-    delete[] yuv;
-    for (int y = 0; y < height; y++)
-        delete[] alpha[y];
-    delete[] alpha;
-    for (int y = 0; y < height; y++)
-        delete[] work[y];
-    delete[] work;
+void pal_emulate(Pixbuf &pb) {
+    int width = pb.get_width();
+    int height = pb.get_height();
+    unsigned char *pixels = pb.get_pixels();
+    int pitch = pb.get_pitch();
+    int shade = clamp(gd_pal_emu_scanline_shade, 0, 100) * 256 / 100;
+
+    /* every filter works horizontally, so the rows can be processed independently */
+    pixbuf_process_row_bands(width, height, [&](int y1, int y2) {
+        /* kept between calls, so emulating every frame does not allocate */
+        static thread_local std::vector<gint32> scratch;
+        scratch.resize(7 * (width + 2 * pal_row_padding));
+        for (int y = y1; y < y2; y++)
+            pal_emulate_row(reinterpret_cast<guint32 *>(pixels + y * pitch), y, width, shade, scratch.data());
+    });
 }
 
 
@@ -26,10 +26,16 @@
 #include "config.h"
 
 #include <glib.h>
+#include <functional>
 
 class Pixbuf;
 class GdColor;
 
+/// Call func(y1, y2) for bands of rows [y1, y2) which cover an image of the given size.
+/// Large images are split to bands which are processed by worker threads in parallel;
+/// small ones are processed at once by the calling thread.
+void pixbuf_process_row_bands(int width, int height, std::function<void(int, int)> const &func);
+
 void scale2x(const Pixbuf &src, Pixbuf &dest);
 void scale3x(const Pixbuf &src, Pixbuf &dest);
 void scale2xnearest(const Pixbuf &src, Pixbuf &dest);
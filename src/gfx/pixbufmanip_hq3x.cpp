@@ -32,6 +32,8 @@
  *
  * The RGBtoYUV lookup table is removed, as scaling is only done once
  * in GDash for every cave loading, not continuously during the game.
+ * Instead, the YUV values and the neighbour patterns are calculated
+ * once per row by HqxRows, and bands of rows are scaled in parallel.
  *
  * The interpolation functions are changed so they do not produce
  * overflows for the most significant bytes. So when calculating, they
@@ -99,7 +101,7 @@
 #define PIXEL22_5   Interp5(dp+dpL+dpL+2, w[6], w[8]);
 #define PIXEL22_C   *(dp+dpL+dpL+2) = w[5];
 
-void hq3x(Pixbuf const &src, Pixbuf &dst) {
+static void hq3x_rows(Pixbuf const &src, Pixbuf &dst, int y1, int y2) {
     guint32  w[10];
 
     //   +----+----+----+
@@ -117,8 +119,11 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
     int sh = src.get_height();
     int dpL = dst.get_pitch() / 4; /* 4 bytes/pixel */
 
-    for (int j = 0; j < sh; j++) {
+    HqxRows rows(src, y1);
+    for (int j = y1; j < y2; j++, rows.next()) {
         const guint32 *line = src.get_row(j);
+        const guint32 *prevyuv = rows.prev_yuv(), *lineyuv = rows.yuv(), *nextyuv = rows.next_yuv();
+        const int *patterns = rows.patterns();
         const guint32 *prevline, *nextline;
         if (j > 0)      prevline = src.get_row(j - 1);
         else prevline = src.get_row(sh - 1);
@@ -150,23 +155,13 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                 w[9] = nextline[0];
             }
 
-            int pattern = 0;
-            int flag = 1;
-
-            guint32 YUV1 = RGBtoYUV(w[5]);
-
-            for (int k = 1; k <= 9; k++) {
-                if (k == 5) continue;
-
-                if (w[k] != w[5]) {
-                    guint32 YUV2 = RGBtoYUV(w[k]);
-                    if ((abs(gint32(YUV1 & Ymask) - gint32(YUV2 & Ymask)) > trY) ||
-                            (abs(gint32(YUV1 & Umask) - gint32(YUV2 & Umask)) > trU) ||
-                            (abs(gint32(YUV1 & Vmask) - gint32(YUV2 & Vmask)) > trV))
-                        pattern |= flag;
-                }
-                flag <<= 1;
-            }
+            int pattern = patterns[i];
+            guint32 const yuv[10] = {
+                0,
+                prevyuv[i - 1], prevyuv[i], prevyuv[i + 1],
+                lineyuv[i - 1], lineyuv[i], lineyuv[i + 1],
+                nextyuv[i - 1], nextyuv[i], nextyuv[i + 1],
+            };
 
             guint32 *dp = dst.get_row(j * 3) + i * 3;
 
@@ -381,7 +376,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                 case 18:
                 case 50: {
                     PIXEL00_1M
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL01_C
                         PIXEL02_1M
                         PIXEL12_C
@@ -405,7 +400,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL10_1
                     PIXEL11
                     PIXEL20_1M
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL12_C
                         PIXEL21_C
                         PIXEL22_1M
@@ -423,7 +418,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL02_2
                     PIXEL11
                     PIXEL12_1
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL10_C
                         PIXEL20_1M
                         PIXEL21_C
@@ -437,7 +432,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                 }
                 case 10:
                 case 138: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_1M
                         PIXEL01_C
                         PIXEL10_C
@@ -537,7 +532,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                 case 22:
                 case 54: {
                     PIXEL00_1M
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL01_C
                         PIXEL02_C
                         PIXEL12_C
@@ -561,7 +556,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL10_1
                     PIXEL11
                     PIXEL20_1M
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL12_C
                         PIXEL21_C
                         PIXEL22_C
@@ -579,7 +574,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL02_2
                     PIXEL11
                     PIXEL12_1
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL10_C
                         PIXEL20_C
                         PIXEL21_C
@@ -593,7 +588,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                 }
                 case 11:
                 case 139: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_C
                         PIXEL01_C
                         PIXEL10_C
@@ -612,7 +607,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                 }
                 case 19:
                 case 51: {
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL00_1L
                         PIXEL01_C
                         PIXEL02_1M
@@ -632,7 +627,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                 }
                 case 146:
                 case 178: {
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL01_C
                         PIXEL02_1M
                         PIXEL12_C
@@ -652,7 +647,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                 }
                 case 84:
                 case 85: {
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL02_1U
                         PIXEL12_C
                         PIXEL21_C
@@ -672,7 +667,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                 }
                 case 112:
                 case 113: {
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL12_C
                         PIXEL20_1L
                         PIXEL21_C
@@ -692,7 +687,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                 }
                 case 200:
                 case 204: {
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL10_C
                         PIXEL20_1M
                         PIXEL21_C
@@ -712,7 +707,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                 }
                 case 73:
                 case 77: {
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL00_1U
                         PIXEL10_C
                         PIXEL20_1M
@@ -732,7 +727,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                 }
                 case 42:
                 case 170: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_1M
                         PIXEL01_C
                         PIXEL10_C
@@ -752,7 +747,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                 }
                 case 14:
                 case 142: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_1M
                         PIXEL01_C
                         PIXEL02_1R
@@ -868,7 +863,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                 }
                 case 26:
                 case 31: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_C
                         PIXEL10_C
                     } else {
@@ -876,7 +871,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                         PIXEL10_3
                     }
                     PIXEL01_C
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_C
                         PIXEL12_C
                     } else {
@@ -892,7 +887,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                 case 82:
                 case 214: {
                     PIXEL00_1M
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL01_C
                         PIXEL02_C
                     } else {
@@ -903,7 +898,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL11
                     PIXEL12_C
                     PIXEL20_1M
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL21_C
                         PIXEL22_C
                     } else {
@@ -918,7 +913,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL01_1
                     PIXEL02_1M
                     PIXEL11
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL10_C
                         PIXEL20_C
                     } else {
@@ -926,7 +921,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                         PIXEL20_4
                     }
                     PIXEL21_C
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL12_C
                         PIXEL22_C
                     } else {
@@ -937,7 +932,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                 }
                 case 74:
                 case 107: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_C
                         PIXEL01_C
                     } else {
@@ -948,7 +943,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL10_C
                     PIXEL11
                     PIXEL12_1
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_C
                         PIXEL21_C
                     } else {
@@ -959,7 +954,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 27: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_C
                         PIXEL01_C
                         PIXEL10_C
@@ -978,7 +973,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                 }
                 case 86: {
                     PIXEL00_1M
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL01_C
                         PIXEL02_C
                         PIXEL12_C
@@ -1001,7 +996,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL10_C
                     PIXEL11
                     PIXEL20_1M
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL12_C
                         PIXEL21_C
                         PIXEL22_C
@@ -1018,7 +1013,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL02_1M
                     PIXEL11
                     PIXEL12_1
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL10_C
                         PIXEL20_C
                         PIXEL21_C
@@ -1032,7 +1027,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                 }
                 case 30: {
                     PIXEL00_1M
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL01_C
                         PIXEL02_C
                         PIXEL12_C
@@ -1055,7 +1050,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL10_1
                     PIXEL11
                     PIXEL20_1M
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL12_C
                         PIXEL21_C
                         PIXEL22_C
@@ -1072,7 +1067,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL02_1M
                     PIXEL11
                     PIXEL12_C
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL10_C
                         PIXEL20_C
                         PIXEL21_C
@@ -1085,7 +1080,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 75: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_C
                         PIXEL01_C
                         PIXEL10_C
@@ -1247,13 +1242,13 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 58: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_1M
                     } else {
                         PIXEL00_2
                     }
                     PIXEL01_C
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_1M
                     } else {
                         PIXEL02_2
@@ -1269,7 +1264,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                 case 83: {
                     PIXEL00_1L
                     PIXEL01_C
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_1M
                     } else {
                         PIXEL02_2
@@ -1279,7 +1274,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL12_C
                     PIXEL20_1M
                     PIXEL21_C
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL22_1M
                     } else {
                         PIXEL22_2
@@ -1293,13 +1288,13 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL10_C
                     PIXEL11
                     PIXEL12_C
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_1M
                     } else {
                         PIXEL20_2
                     }
                     PIXEL21_C
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL22_1M
                     } else {
                         PIXEL22_2
@@ -1307,7 +1302,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 202: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_1M
                     } else {
                         PIXEL00_2
@@ -1317,7 +1312,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL10_C
                     PIXEL11
                     PIXEL12_1
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_1M
                     } else {
                         PIXEL20_2
@@ -1327,7 +1322,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 78: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_1M
                     } else {
                         PIXEL00_2
@@ -1337,7 +1332,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL10_C
                     PIXEL11
                     PIXEL12_1
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_1M
                     } else {
                         PIXEL20_2
@@ -1347,13 +1342,13 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 154: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_1M
                     } else {
                         PIXEL00_2
                     }
                     PIXEL01_C
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_1M
                     } else {
                         PIXEL02_2
@@ -1369,7 +1364,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                 case 114: {
                     PIXEL00_1M
                     PIXEL01_C
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_1M
                     } else {
                         PIXEL02_2
@@ -1379,7 +1374,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL12_C
                     PIXEL20_1L
                     PIXEL21_C
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL22_1M
                     } else {
                         PIXEL22_2
@@ -1393,13 +1388,13 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL10_C
                     PIXEL11
                     PIXEL12_C
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_1M
                     } else {
                         PIXEL20_2
                     }
                     PIXEL21_C
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL22_1M
                     } else {
                         PIXEL22_2
@@ -1407,13 +1402,13 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 90: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_1M
                     } else {
                         PIXEL00_2
                     }
                     PIXEL01_C
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_1M
                     } else {
                         PIXEL02_2
@@ -1421,13 +1416,13 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL10_C
                     PIXEL11
                     PIXEL12_C
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_1M
                     } else {
                         PIXEL20_2
                     }
                     PIXEL21_C
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL22_1M
                     } else {
                         PIXEL22_2
@@ -1436,7 +1431,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                 }
                 case 55:
                 case 23: {
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL00_1L
                         PIXEL01_C
                         PIXEL02_C
@@ -1456,7 +1451,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                 }
                 case 182:
                 case 150: {
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL01_C
                         PIXEL02_C
                         PIXEL12_C
@@ -1476,7 +1471,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                 }
                 case 213:
                 case 212: {
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL02_1U
                         PIXEL12_C
                         PIXEL21_C
@@ -1496,7 +1491,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                 }
                 case 241:
                 case 240: {
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL12_C
                         PIXEL20_1L
                         PIXEL21_C
@@ -1516,7 +1511,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                 }
                 case 236:
                 case 232: {
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL10_C
                         PIXEL20_C
                         PIXEL21_C
@@ -1536,7 +1531,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                 }
                 case 109:
                 case 105: {
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL00_1U
                         PIXEL10_C
                         PIXEL20_C
@@ -1556,7 +1551,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                 }
                 case 171:
                 case 43: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_C
                         PIXEL01_C
                         PIXEL10_C
@@ -1576,7 +1571,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                 }
                 case 143:
                 case 15: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_C
                         PIXEL01_C
                         PIXEL02_1R
@@ -1600,7 +1595,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL02_1U
                     PIXEL11
                     PIXEL12_C
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL10_C
                         PIXEL20_C
                         PIXEL21_C
@@ -1613,7 +1608,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 203: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_C
                         PIXEL01_C
                         PIXEL10_C
@@ -1632,7 +1627,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                 }
                 case 62: {
                     PIXEL00_1M
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL01_C
                         PIXEL02_C
                         PIXEL12_C
@@ -1655,7 +1650,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL10_1
                     PIXEL11
                     PIXEL20_1M
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL12_C
                         PIXEL21_C
                         PIXEL22_C
@@ -1668,7 +1663,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                 }
                 case 118: {
                     PIXEL00_1M
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL01_C
                         PIXEL02_C
                         PIXEL12_C
@@ -1691,7 +1686,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL10_C
                     PIXEL11
                     PIXEL20_1M
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL12_C
                         PIXEL21_C
                         PIXEL22_C
@@ -1708,7 +1703,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL02_1R
                     PIXEL11
                     PIXEL12_1
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL10_C
                         PIXEL20_C
                         PIXEL21_C
@@ -1721,7 +1716,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 155: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_C
                         PIXEL01_C
                         PIXEL10_C
@@ -1840,12 +1835,12 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL02_1U
                     PIXEL10_C
                     PIXEL11
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_1M
                     } else {
                         PIXEL20_2
                     }
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL12_C
                         PIXEL21_C
                         PIXEL22_C
@@ -1857,12 +1852,12 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 158: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_1M
                     } else {
                         PIXEL00_2
                     }
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL01_C
                         PIXEL02_C
                         PIXEL12_C
@@ -1879,7 +1874,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 234: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_1M
                     } else {
                         PIXEL00_2
@@ -1888,7 +1883,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL02_1M
                     PIXEL11
                     PIXEL12_1
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL10_C
                         PIXEL20_C
                         PIXEL21_C
@@ -1903,7 +1898,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                 case 242: {
                     PIXEL00_1M
                     PIXEL01_C
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_1M
                     } else {
                         PIXEL02_2
@@ -1911,7 +1906,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL10_1
                     PIXEL11
                     PIXEL20_1L
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL12_C
                         PIXEL21_C
                         PIXEL22_C
@@ -1923,7 +1918,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 59: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_C
                         PIXEL01_C
                         PIXEL10_C
@@ -1932,7 +1927,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                         PIXEL01_3
                         PIXEL10_3
                     }
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_1M
                     } else {
                         PIXEL02_2
@@ -1950,7 +1945,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL02_1M
                     PIXEL11
                     PIXEL12_C
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL10_C
                         PIXEL20_C
                         PIXEL21_C
@@ -1959,7 +1954,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                         PIXEL20_4
                         PIXEL21_3
                     }
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL22_1M
                     } else {
                         PIXEL22_2
@@ -1968,7 +1963,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                 }
                 case 87: {
                     PIXEL00_1L
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL01_C
                         PIXEL02_C
                         PIXEL12_C
@@ -1981,7 +1976,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL11
                     PIXEL20_1M
                     PIXEL21_C
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL22_1M
                     } else {
                         PIXEL22_2
@@ -1989,7 +1984,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 79: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_C
                         PIXEL01_C
                         PIXEL10_C
@@ -2001,7 +1996,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL02_1R
                     PIXEL11
                     PIXEL12_1
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_1M
                     } else {
                         PIXEL20_2
@@ -2011,20 +2006,20 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 122: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_1M
                     } else {
                         PIXEL00_2
                     }
                     PIXEL01_C
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_1M
                     } else {
                         PIXEL02_2
                     }
                     PIXEL11
                     PIXEL12_C
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL10_C
                         PIXEL20_C
                         PIXEL21_C
@@ -2033,7 +2028,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                         PIXEL20_4
                         PIXEL21_3
                     }
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL22_1M
                     } else {
                         PIXEL22_2
@@ -2041,12 +2036,12 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 94: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_1M
                     } else {
                         PIXEL00_2
                     }
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL01_C
                         PIXEL02_C
                         PIXEL12_C
@@ -2057,13 +2052,13 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     }
                     PIXEL10_C
                     PIXEL11
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_1M
                     } else {
                         PIXEL20_2
                     }
                     PIXEL21_C
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL22_1M
                     } else {
                         PIXEL22_2
@@ -2071,25 +2066,25 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 218: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_1M
                     } else {
                         PIXEL00_2
                     }
                     PIXEL01_C
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_1M
                     } else {
                         PIXEL02_2
                     }
                     PIXEL10_C
                     PIXEL11
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_1M
                     } else {
                         PIXEL20_2
                     }
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL12_C
                         PIXEL21_C
                         PIXEL22_C
@@ -2101,7 +2096,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 91: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_C
                         PIXEL01_C
                         PIXEL10_C
@@ -2110,20 +2105,20 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                         PIXEL01_3
                         PIXEL10_3
                     }
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_1M
                     } else {
                         PIXEL02_2
                     }
                     PIXEL11
                     PIXEL12_C
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_1M
                     } else {
                         PIXEL20_2
                     }
                     PIXEL21_C
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL22_1M
                     } else {
                         PIXEL22_2
@@ -2179,13 +2174,13 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 186: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_1M
                     } else {
                         PIXEL00_2
                     }
                     PIXEL01_C
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_1M
                     } else {
                         PIXEL02_2
@@ -2201,7 +2196,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                 case 115: {
                     PIXEL00_1L
                     PIXEL01_C
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_1M
                     } else {
                         PIXEL02_2
@@ -2211,7 +2206,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL12_C
                     PIXEL20_1L
                     PIXEL21_C
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL22_1M
                     } else {
                         PIXEL22_2
@@ -2225,13 +2220,13 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL10_C
                     PIXEL11
                     PIXEL12_C
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_1M
                     } else {
                         PIXEL20_2
                     }
                     PIXEL21_C
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL22_1M
                     } else {
                         PIXEL22_2
@@ -2239,7 +2234,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 206: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_1M
                     } else {
                         PIXEL00_2
@@ -2249,7 +2244,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL10_C
                     PIXEL11
                     PIXEL12_1
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_1M
                     } else {
                         PIXEL20_2
@@ -2266,7 +2261,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL10_C
                     PIXEL11
                     PIXEL12_1
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_1M
                     } else {
                         PIXEL20_2
@@ -2277,7 +2272,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                 }
                 case 174:
                 case 46: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_1M
                     } else {
                         PIXEL00_2
@@ -2296,7 +2291,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                 case 147: {
                     PIXEL00_1L
                     PIXEL01_C
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_1M
                     } else {
                         PIXEL02_2
@@ -2319,7 +2314,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL12_C
                     PIXEL20_1L
                     PIXEL21_C
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL22_1M
                     } else {
                         PIXEL22_2
@@ -2352,7 +2347,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                 }
                 case 126: {
                     PIXEL00_1M
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL01_C
                         PIXEL02_C
                         PIXEL12_C
@@ -2362,7 +2357,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                         PIXEL12_3
                     }
                     PIXEL11
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL10_C
                         PIXEL20_C
                         PIXEL21_C
@@ -2375,7 +2370,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 219: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_C
                         PIXEL01_C
                         PIXEL10_C
@@ -2387,7 +2382,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL02_1M
                     PIXEL11
                     PIXEL20_1M
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL12_C
                         PIXEL21_C
                         PIXEL22_C
@@ -2399,7 +2394,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 125: {
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL00_1U
                         PIXEL10_C
                         PIXEL20_C
@@ -2418,7 +2413,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 221: {
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL02_1U
                         PIXEL12_C
                         PIXEL21_C
@@ -2437,7 +2432,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 207: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_C
                         PIXEL01_C
                         PIXEL02_1R
@@ -2456,7 +2451,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 238: {
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL10_C
                         PIXEL20_C
                         PIXEL21_C
@@ -2475,7 +2470,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 190: {
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL01_C
                         PIXEL02_C
                         PIXEL12_C
@@ -2494,7 +2489,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 187: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_C
                         PIXEL01_C
                         PIXEL10_C
@@ -2513,7 +2508,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 243: {
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL12_C
                         PIXEL20_1L
                         PIXEL21_C
@@ -2532,7 +2527,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 119: {
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL00_1L
                         PIXEL01_C
                         PIXEL02_C
@@ -2558,7 +2553,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL10_C
                     PIXEL11
                     PIXEL12_1
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_C
                     } else {
                         PIXEL20_2
@@ -2569,7 +2564,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                 }
                 case 175:
                 case 47: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_C
                     } else {
                         PIXEL00_2
@@ -2588,7 +2583,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                 case 151: {
                     PIXEL00_1L
                     PIXEL01_C
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_C
                     } else {
                         PIXEL02_2
@@ -2611,7 +2606,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL12_C
                     PIXEL20_1L
                     PIXEL21_C
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL22_C
                     } else {
                         PIXEL22_2
@@ -2623,7 +2618,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL01_C
                     PIXEL02_1M
                     PIXEL11
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL10_C
                         PIXEL20_C
                     } else {
@@ -2631,7 +2626,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                         PIXEL20_4
                     }
                     PIXEL21_C
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL12_C
                         PIXEL22_C
                     } else {
@@ -2641,7 +2636,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 123: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_C
                         PIXEL01_C
                     } else {
@@ -2652,7 +2647,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL10_C
                     PIXEL11
                     PIXEL12_C
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_C
                         PIXEL21_C
                     } else {
@@ -2663,7 +2658,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 95: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_C
                         PIXEL10_C
                     } else {
@@ -2671,7 +2666,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                         PIXEL10_3
                     }
                     PIXEL01_C
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_C
                         PIXEL12_C
                     } else {
@@ -2686,7 +2681,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                 }
                 case 222: {
                     PIXEL00_1M
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL01_C
                         PIXEL02_C
                     } else {
@@ -2697,7 +2692,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL11
                     PIXEL12_C
                     PIXEL20_1M
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL21_C
                         PIXEL22_C
                     } else {
@@ -2712,7 +2707,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL02_1U
                     PIXEL11
                     PIXEL12_C
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL10_C
                         PIXEL20_C
                     } else {
@@ -2720,7 +2715,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                         PIXEL20_4
                     }
                     PIXEL21_C
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL22_C
                     } else {
                         PIXEL22_2
@@ -2733,13 +2728,13 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL02_1M
                     PIXEL10_C
                     PIXEL11
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_C
                     } else {
                         PIXEL20_2
                     }
                     PIXEL21_C
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL12_C
                         PIXEL22_C
                     } else {
@@ -2749,7 +2744,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 235: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_C
                         PIXEL01_C
                     } else {
@@ -2760,7 +2755,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL10_C
                     PIXEL11
                     PIXEL12_1
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_C
                     } else {
                         PIXEL20_2
@@ -2770,7 +2765,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 111: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_C
                     } else {
                         PIXEL00_2
@@ -2780,7 +2775,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL10_C
                     PIXEL11
                     PIXEL12_1
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_C
                         PIXEL21_C
                     } else {
@@ -2791,13 +2786,13 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 63: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_C
                     } else {
                         PIXEL00_2
                     }
                     PIXEL01_C
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_C
                         PIXEL12_C
                     } else {
@@ -2812,7 +2807,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 159: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_C
                         PIXEL10_C
                     } else {
@@ -2820,7 +2815,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                         PIXEL10_3
                     }
                     PIXEL01_C
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_C
                     } else {
                         PIXEL02_2
@@ -2835,7 +2830,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                 case 215: {
                     PIXEL00_1L
                     PIXEL01_C
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_C
                     } else {
                         PIXEL02_2
@@ -2844,7 +2839,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL11
                     PIXEL12_C
                     PIXEL20_1M
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL21_C
                         PIXEL22_C
                     } else {
@@ -2855,7 +2850,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                 }
                 case 246: {
                     PIXEL00_1M
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL01_C
                         PIXEL02_C
                     } else {
@@ -2867,7 +2862,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL12_C
                     PIXEL20_1L
                     PIXEL21_C
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL22_C
                     } else {
                         PIXEL22_2
@@ -2876,7 +2871,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                 }
                 case 254: {
                     PIXEL00_1M
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL01_C
                         PIXEL02_C
                     } else {
@@ -2884,14 +2879,14 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                         PIXEL02_4
                     }
                     PIXEL11
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL10_C
                         PIXEL20_C
                     } else {
                         PIXEL10_3
                         PIXEL20_4
                     }
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL12_C
                         PIXEL21_C
                         PIXEL22_C
@@ -2909,13 +2904,13 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL10_C
                     PIXEL11
                     PIXEL12_C
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_C
                     } else {
                         PIXEL20_2
                     }
                     PIXEL21_C
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL22_C
                     } else {
                         PIXEL22_2
@@ -2923,7 +2918,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 251: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_C
                         PIXEL01_C
                     } else {
@@ -2932,7 +2927,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     }
                     PIXEL02_1M
                     PIXEL11
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL10_C
                         PIXEL20_C
                         PIXEL21_C
@@ -2941,7 +2936,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                         PIXEL20_2
                         PIXEL21_3
                     }
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL12_C
                         PIXEL22_C
                     } else {
@@ -2951,7 +2946,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 239: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_C
                     } else {
                         PIXEL00_2
@@ -2961,7 +2956,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL10_C
                     PIXEL11
                     PIXEL12_1
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_C
                     } else {
                         PIXEL20_2
@@ -2971,7 +2966,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 127: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_C
                         PIXEL01_C
                         PIXEL10_C
@@ -2980,7 +2975,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                         PIXEL01_3
                         PIXEL10_3
                     }
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_C
                         PIXEL12_C
                     } else {
@@ -2988,7 +2983,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                         PIXEL12_3
                     }
                     PIXEL11
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_C
                         PIXEL21_C
                     } else {
@@ -2999,13 +2994,13 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 191: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_C
                     } else {
                         PIXEL00_2
                     }
                     PIXEL01_C
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_C
                     } else {
                         PIXEL02_2
@@ -3019,14 +3014,14 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 223: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_C
                         PIXEL10_C
                     } else {
                         PIXEL00_4
                         PIXEL10_3
                     }
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL01_C
                         PIXEL02_C
                         PIXEL12_C
@@ -3037,7 +3032,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     }
                     PIXEL11
                     PIXEL20_1M
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL21_C
                         PIXEL22_C
                     } else {
@@ -3049,7 +3044,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                 case 247: {
                     PIXEL00_1L
                     PIXEL01_C
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_C
                     } else {
                         PIXEL02_2
@@ -3059,7 +3054,7 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL12_C
                     PIXEL20_1L
                     PIXEL21_C
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL22_C
                     } else {
                         PIXEL22_2
@@ -3067,13 +3062,13 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 255: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_C
                     } else {
                         PIXEL00_2
                     }
                     PIXEL01_C
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_C
                     } else {
                         PIXEL02_2
@@ -3081,13 +3076,13 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL10_C
                     PIXEL11
                     PIXEL12_C
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_C
                     } else {
                         PIXEL20_2
                     }
                     PIXEL21_C
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL22_C
                     } else {
                         PIXEL22_2
@@ -3098,3 +3093,10 @@ void hq3x(Pixbuf const &src, Pixbuf &dst) {
         }
     }
 }
+
+
+void hq3x(Pixbuf const &src, Pixbuf &dst) {
+    pixbuf_process_row_bands(src.get_width(), src.get_height(), [&](int y1, int y2) {
+        hq3x_rows(src, dst, y1, y2);
+    });
+}
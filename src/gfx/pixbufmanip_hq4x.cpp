@@ -32,6 +32,8 @@
  *
  * The RGBtoYUV lookup table is removed, as scaling is only done once
  * in GDash for every cave loading, not continuously during the game.
+ * Instead, the YUV values and the neighbour patterns are calculated
+ * once per row by HqxRows, and bands of rows are scaled in parallel.
  *
  * The interpolation functions are changed so they do not produce
  * overflows for the most significant bytes. So when calculating, they
@@ -186,7 +188,7 @@
 #define PIXEL33_81    Interp8(dp+dpL+dpL+dpL+3, w[5], w[6]);
 #define PIXEL33_82    Interp8(dp+dpL+dpL+dpL+3, w[5], w[8]);
 
-void hq4x(Pixbuf const &src, Pixbuf &dst) {
+static void hq4x_rows(Pixbuf const &src, Pixbuf &dst, int y1, int y2) {
     guint32  w[10];
 
     //   +----+----+----+
@@ -204,8 +206,11 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
     int sh = src.get_height();
     int dpL = dst.get_pitch() / 4; /* 4 bytes/pixel */
 
-    for (int j = 0; j < sh; j++) {
+    HqxRows rows(src, y1);
+    for (int j = y1; j < y2; j++, rows.next()) {
         const guint32 *line = src.get_row(j);
+        const guint32 *prevyuv = rows.prev_yuv(), *lineyuv = rows.yuv(), *nextyuv = rows.next_yuv();
+        const int *patterns = rows.patterns();
         const guint32 *prevline, *nextline;
         if (j > 0)      prevline = src.get_row(j - 1);
         else prevline = src.get_row(sh - 1);
@@ -237,23 +242,13 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                 w[9] = nextline[0];
             }
 
-            int pattern = 0;
-            int flag = 1;
-
-            guint32 YUV1 = RGBtoYUV(w[5]);
-
-            for (int k = 1; k <= 9; k++) {
-                if (k == 5) continue;
-
-                if (w[k] != w[5]) {
-                    guint32 YUV2 = RGBtoYUV(w[k]);
-                    if ((abs(gint32(YUV1 & Ymask) - gint32(YUV2 & Ymask)) > trY) ||
-                            (abs(gint32(YUV1 & Umask) - gint32(YUV2 & Umask)) > trU) ||
-                            (abs(gint32(YUV1 & Vmask) - gint32(YUV2 & Vmask)) > trV))
-                        pattern |= flag;
-                }
-                flag <<= 1;
-            }
+            int pattern = patterns[i];
+            guint32 const yuv[10] = {
+                0,
+                prevyuv[i - 1], prevyuv[i], prevyuv[i + 1],
+                lineyuv[i - 1], lineyuv[i], lineyuv[i + 1],
+                nextyuv[i - 1], nextyuv[i], nextyuv[i + 1],
+            };
 
             guint32 *dp = dst.get_row(j * 4) + i * 4;
 
@@ -560,7 +555,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                 case 50: {
                     PIXEL00_80
                     PIXEL01_10
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_10
                         PIXEL03_80
                         PIXEL12_30
@@ -595,7 +590,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL13_10
                     PIXEL20_61
                     PIXEL21_30
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL22_30
                         PIXEL23_10
                         PIXEL32_10
@@ -620,7 +615,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL11_30
                     PIXEL12_70
                     PIXEL13_60
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_10
                         PIXEL21_30
                         PIXEL30_80
@@ -639,7 +634,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                 }
                 case 10:
                 case 138: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_80
                         PIXEL01_10
                         PIXEL10_10
@@ -790,7 +785,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                 case 54: {
                     PIXEL00_80
                     PIXEL01_10
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_0
                         PIXEL03_0
                         PIXEL13_0
@@ -825,7 +820,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL20_61
                     PIXEL21_30
                     PIXEL22_0
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL23_0
                         PIXEL32_0
                         PIXEL33_0
@@ -848,7 +843,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL11_30
                     PIXEL12_70
                     PIXEL13_60
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_0
                         PIXEL30_0
                         PIXEL31_0
@@ -866,7 +861,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                 }
                 case 11:
                 case 139: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_0
                         PIXEL01_0
                         PIXEL10_0
@@ -892,7 +887,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                 }
                 case 19:
                 case 51: {
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL00_81
                         PIXEL01_31
                         PIXEL02_10
@@ -923,7 +918,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                 case 178: {
                     PIXEL00_80
                     PIXEL01_10
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_10
                         PIXEL03_80
                         PIXEL12_30
@@ -953,7 +948,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL00_20
                     PIXEL01_60
                     PIXEL02_81
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL03_81
                         PIXEL13_31
                         PIXEL22_30
@@ -989,7 +984,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL13_10
                     PIXEL20_82
                     PIXEL21_32
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL22_30
                         PIXEL23_10
                         PIXEL30_82
@@ -1016,7 +1011,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL11_30
                     PIXEL12_70
                     PIXEL13_60
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_10
                         PIXEL21_30
                         PIXEL30_80
@@ -1037,7 +1032,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                 }
                 case 73:
                 case 77: {
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL00_82
                         PIXEL10_32
                         PIXEL20_10
@@ -1066,7 +1061,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                 }
                 case 42:
                 case 170: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_80
                         PIXEL01_10
                         PIXEL10_10
@@ -1095,7 +1090,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                 }
                 case 14:
                 case 142: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_80
                         PIXEL01_10
                         PIXEL02_32
@@ -1276,7 +1271,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                 }
                 case 26:
                 case 31: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_0
                         PIXEL01_0
                         PIXEL10_0
@@ -1285,7 +1280,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                         PIXEL01_50
                         PIXEL10_50
                     }
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_0
                         PIXEL03_0
                         PIXEL13_0
@@ -1310,7 +1305,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                 case 214: {
                     PIXEL00_80
                     PIXEL01_10
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_0
                         PIXEL03_0
                         PIXEL13_0
@@ -1325,7 +1320,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL20_61
                     PIXEL21_30
                     PIXEL22_0
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL23_0
                         PIXEL32_0
                         PIXEL33_0
@@ -1348,7 +1343,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL11_30
                     PIXEL12_30
                     PIXEL13_10
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_0
                         PIXEL30_0
                         PIXEL31_0
@@ -1359,7 +1354,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     }
                     PIXEL21_0
                     PIXEL22_0
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL23_0
                         PIXEL32_0
                         PIXEL33_0
@@ -1372,7 +1367,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                 }
                 case 74:
                 case 107: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_0
                         PIXEL01_0
                         PIXEL10_0
@@ -1386,7 +1381,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL11_0
                     PIXEL12_30
                     PIXEL13_61
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_0
                         PIXEL30_0
                         PIXEL31_0
@@ -1403,7 +1398,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 27: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_0
                         PIXEL01_0
                         PIXEL10_0
@@ -1430,7 +1425,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                 case 86: {
                     PIXEL00_80
                     PIXEL01_10
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_0
                         PIXEL03_0
                         PIXEL13_0
@@ -1464,7 +1459,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL20_10
                     PIXEL21_30
                     PIXEL22_0
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL23_0
                         PIXEL32_0
                         PIXEL33_0
@@ -1486,7 +1481,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL11_30
                     PIXEL12_30
                     PIXEL13_61
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_0
                         PIXEL30_0
                         PIXEL31_0
@@ -1505,7 +1500,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                 case 30: {
                     PIXEL00_80
                     PIXEL01_10
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_0
                         PIXEL03_0
                         PIXEL13_0
@@ -1539,7 +1534,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL20_61
                     PIXEL21_30
                     PIXEL22_0
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL23_0
                         PIXEL32_0
                         PIXEL33_0
@@ -1561,7 +1556,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL11_30
                     PIXEL12_30
                     PIXEL13_10
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_0
                         PIXEL30_0
                         PIXEL31_0
@@ -1578,7 +1573,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 75: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_0
                         PIXEL01_0
                         PIXEL10_0
@@ -1831,7 +1826,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 58: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_80
                         PIXEL01_10
                         PIXEL10_10
@@ -1842,7 +1837,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                         PIXEL10_11
                         PIXEL11_0
                     }
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_10
                         PIXEL03_80
                         PIXEL12_30
@@ -1866,7 +1861,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                 case 83: {
                     PIXEL00_81
                     PIXEL01_31
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_10
                         PIXEL03_80
                         PIXEL12_30
@@ -1881,7 +1876,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL11_31
                     PIXEL20_61
                     PIXEL21_30
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL22_30
                         PIXEL23_10
                         PIXEL32_10
@@ -1905,7 +1900,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL11_30
                     PIXEL12_31
                     PIXEL13_31
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_10
                         PIXEL21_30
                         PIXEL30_80
@@ -1916,7 +1911,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                         PIXEL30_20
                         PIXEL31_11
                     }
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL22_30
                         PIXEL23_10
                         PIXEL32_10
@@ -1930,7 +1925,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 202: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_80
                         PIXEL01_10
                         PIXEL10_10
@@ -1945,7 +1940,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL03_80
                     PIXEL12_30
                     PIXEL13_61
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_10
                         PIXEL21_30
                         PIXEL30_80
@@ -1963,7 +1958,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 78: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_80
                         PIXEL01_10
                         PIXEL10_10
@@ -1978,7 +1973,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL03_82
                     PIXEL12_32
                     PIXEL13_82
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_10
                         PIXEL21_30
                         PIXEL30_80
@@ -1996,7 +1991,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 154: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_80
                         PIXEL01_10
                         PIXEL10_10
@@ -2007,7 +2002,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                         PIXEL10_11
                         PIXEL11_0
                     }
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_10
                         PIXEL03_80
                         PIXEL12_30
@@ -2031,7 +2026,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                 case 114: {
                     PIXEL00_80
                     PIXEL01_10
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_10
                         PIXEL03_80
                         PIXEL12_30
@@ -2046,7 +2041,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL11_30
                     PIXEL20_82
                     PIXEL21_32
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL22_30
                         PIXEL23_10
                         PIXEL32_10
@@ -2070,7 +2065,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL11_32
                     PIXEL12_30
                     PIXEL13_10
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_10
                         PIXEL21_30
                         PIXEL30_80
@@ -2081,7 +2076,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                         PIXEL30_20
                         PIXEL31_11
                     }
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL22_30
                         PIXEL23_10
                         PIXEL32_10
@@ -2095,7 +2090,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 90: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_80
                         PIXEL01_10
                         PIXEL10_10
@@ -2106,7 +2101,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                         PIXEL10_11
                         PIXEL11_0
                     }
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_10
                         PIXEL03_80
                         PIXEL12_30
@@ -2117,7 +2112,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                         PIXEL12_0
                         PIXEL13_12
                     }
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_10
                         PIXEL21_30
                         PIXEL30_80
@@ -2128,7 +2123,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                         PIXEL30_20
                         PIXEL31_11
                     }
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL22_30
                         PIXEL23_10
                         PIXEL32_10
@@ -2143,7 +2138,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                 }
                 case 55:
                 case 23: {
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL00_81
                         PIXEL01_31
                         PIXEL02_0
@@ -2174,7 +2169,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                 case 150: {
                     PIXEL00_80
                     PIXEL01_10
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_0
                         PIXEL03_0
                         PIXEL12_0
@@ -2204,7 +2199,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL00_20
                     PIXEL01_60
                     PIXEL02_81
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL03_81
                         PIXEL13_31
                         PIXEL22_0
@@ -2240,7 +2235,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL13_10
                     PIXEL20_82
                     PIXEL21_32
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL22_0
                         PIXEL23_0
                         PIXEL30_82
@@ -2267,7 +2262,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL11_30
                     PIXEL12_70
                     PIXEL13_60
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_0
                         PIXEL21_0
                         PIXEL30_0
@@ -2288,7 +2283,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                 }
                 case 109:
                 case 105: {
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL00_82
                         PIXEL10_32
                         PIXEL20_0
@@ -2317,7 +2312,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                 }
                 case 171:
                 case 43: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_0
                         PIXEL01_0
                         PIXEL10_0
@@ -2346,7 +2341,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                 }
                 case 143:
                 case 15: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_0
                         PIXEL01_0
                         PIXEL02_32
@@ -2382,7 +2377,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL11_30
                     PIXEL12_31
                     PIXEL13_31
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_0
                         PIXEL30_0
                         PIXEL31_0
@@ -2399,7 +2394,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 203: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_0
                         PIXEL01_0
                         PIXEL10_0
@@ -2426,7 +2421,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                 case 62: {
                     PIXEL00_80
                     PIXEL01_10
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_0
                         PIXEL03_0
                         PIXEL13_0
@@ -2460,7 +2455,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL20_61
                     PIXEL21_30
                     PIXEL22_0
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL23_0
                         PIXEL32_0
                         PIXEL33_0
@@ -2476,7 +2471,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                 case 118: {
                     PIXEL00_80
                     PIXEL01_10
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_0
                         PIXEL03_0
                         PIXEL13_0
@@ -2510,7 +2505,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL20_10
                     PIXEL21_30
                     PIXEL22_0
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL23_0
                         PIXEL32_0
                         PIXEL33_0
@@ -2532,7 +2527,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL11_30
                     PIXEL12_32
                     PIXEL13_82
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_0
                         PIXEL30_0
                         PIXEL31_0
@@ -2549,7 +2544,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 155: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_0
                         PIXEL01_0
                         PIXEL10_0
@@ -2734,7 +2729,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL11_30
                     PIXEL12_31
                     PIXEL13_31
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_10
                         PIXEL21_30
                         PIXEL30_80
@@ -2746,7 +2741,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                         PIXEL31_11
                     }
                     PIXEL22_0
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL23_0
                         PIXEL32_0
                         PIXEL33_0
@@ -2758,7 +2753,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 158: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_80
                         PIXEL01_10
                         PIXEL10_10
@@ -2769,7 +2764,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                         PIXEL10_11
                         PIXEL11_0
                     }
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_0
                         PIXEL03_0
                         PIXEL13_0
@@ -2790,7 +2785,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 234: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_80
                         PIXEL01_10
                         PIXEL10_10
@@ -2805,7 +2800,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL03_80
                     PIXEL12_30
                     PIXEL13_61
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_0
                         PIXEL30_0
                         PIXEL31_0
@@ -2824,7 +2819,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                 case 242: {
                     PIXEL00_80
                     PIXEL01_10
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_10
                         PIXEL03_80
                         PIXEL12_30
@@ -2840,7 +2835,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL20_82
                     PIXEL21_32
                     PIXEL22_0
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL23_0
                         PIXEL32_0
                         PIXEL33_0
@@ -2854,7 +2849,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 59: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_0
                         PIXEL01_0
                         PIXEL10_0
@@ -2863,7 +2858,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                         PIXEL01_50
                         PIXEL10_50
                     }
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_10
                         PIXEL03_80
                         PIXEL12_30
@@ -2894,7 +2889,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL11_32
                     PIXEL12_30
                     PIXEL13_10
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_0
                         PIXEL30_0
                         PIXEL31_0
@@ -2904,7 +2899,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                         PIXEL31_50
                     }
                     PIXEL21_0
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL22_30
                         PIXEL23_10
                         PIXEL32_10
@@ -2920,7 +2915,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                 case 87: {
                     PIXEL00_81
                     PIXEL01_31
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_0
                         PIXEL03_0
                         PIXEL13_0
@@ -2934,7 +2929,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL12_0
                     PIXEL20_61
                     PIXEL21_30
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL22_30
                         PIXEL23_10
                         PIXEL32_10
@@ -2950,7 +2945,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 79: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_0
                         PIXEL01_0
                         PIXEL10_0
@@ -2964,7 +2959,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL11_0
                     PIXEL12_32
                     PIXEL13_82
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_10
                         PIXEL21_30
                         PIXEL30_80
@@ -2982,7 +2977,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 122: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_80
                         PIXEL01_10
                         PIXEL10_10
@@ -2993,7 +2988,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                         PIXEL10_11
                         PIXEL11_0
                     }
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_10
                         PIXEL03_80
                         PIXEL12_30
@@ -3004,7 +2999,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                         PIXEL12_0
                         PIXEL13_12
                     }
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_0
                         PIXEL30_0
                         PIXEL31_0
@@ -3014,7 +3009,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                         PIXEL31_50
                     }
                     PIXEL21_0
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL22_30
                         PIXEL23_10
                         PIXEL32_10
@@ -3028,7 +3023,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 94: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_80
                         PIXEL01_10
                         PIXEL10_10
@@ -3039,7 +3034,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                         PIXEL10_11
                         PIXEL11_0
                     }
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_0
                         PIXEL03_0
                         PIXEL13_0
@@ -3049,7 +3044,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                         PIXEL13_50
                     }
                     PIXEL12_0
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_10
                         PIXEL21_30
                         PIXEL30_80
@@ -3060,7 +3055,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                         PIXEL30_20
                         PIXEL31_11
                     }
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL22_30
                         PIXEL23_10
                         PIXEL32_10
@@ -3074,7 +3069,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 218: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_80
                         PIXEL01_10
                         PIXEL10_10
@@ -3085,7 +3080,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                         PIXEL10_11
                         PIXEL11_0
                     }
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_10
                         PIXEL03_80
                         PIXEL12_30
@@ -3096,7 +3091,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                         PIXEL12_0
                         PIXEL13_12
                     }
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_10
                         PIXEL21_30
                         PIXEL30_80
@@ -3108,7 +3103,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                         PIXEL31_11
                     }
                     PIXEL22_0
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL23_0
                         PIXEL32_0
                         PIXEL33_0
@@ -3120,7 +3115,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 91: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_0
                         PIXEL01_0
                         PIXEL10_0
@@ -3129,7 +3124,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                         PIXEL01_50
                         PIXEL10_50
                     }
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_10
                         PIXEL03_80
                         PIXEL12_30
@@ -3141,7 +3136,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                         PIXEL13_12
                     }
                     PIXEL11_0
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_10
                         PIXEL21_30
                         PIXEL30_80
@@ -3152,7 +3147,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                         PIXEL30_20
                         PIXEL31_11
                     }
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL22_30
                         PIXEL23_10
                         PIXEL32_10
@@ -3242,7 +3237,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 186: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_80
                         PIXEL01_10
                         PIXEL10_10
@@ -3253,7 +3248,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                         PIXEL10_11
                         PIXEL11_0
                     }
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_10
                         PIXEL03_80
                         PIXEL12_30
@@ -3277,7 +3272,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                 case 115: {
                     PIXEL00_81
                     PIXEL01_31
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_10
                         PIXEL03_80
                         PIXEL12_30
@@ -3292,7 +3287,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL11_31
                     PIXEL20_82
                     PIXEL21_32
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL22_30
                         PIXEL23_10
                         PIXEL32_10
@@ -3316,7 +3311,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL11_32
                     PIXEL12_31
                     PIXEL13_31
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_10
                         PIXEL21_30
                         PIXEL30_80
@@ -3327,7 +3322,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                         PIXEL30_20
                         PIXEL31_11
                     }
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL22_30
                         PIXEL23_10
                         PIXEL32_10
@@ -3341,7 +3336,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 206: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_80
                         PIXEL01_10
                         PIXEL10_10
@@ -3356,7 +3351,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL03_82
                     PIXEL12_32
                     PIXEL13_82
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_10
                         PIXEL21_30
                         PIXEL30_80
@@ -3383,7 +3378,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL11_32
                     PIXEL12_70
                     PIXEL13_60
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_10
                         PIXEL21_30
                         PIXEL30_80
@@ -3402,7 +3397,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                 }
                 case 174:
                 case 46: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_80
                         PIXEL01_10
                         PIXEL10_10
@@ -3431,7 +3426,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                 case 147: {
                     PIXEL00_81
                     PIXEL01_31
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_10
                         PIXEL03_80
                         PIXEL12_30
@@ -3466,7 +3461,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL13_31
                     PIXEL20_82
                     PIXEL21_32
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL22_30
                         PIXEL23_10
                         PIXEL32_10
@@ -3522,7 +3517,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                 case 126: {
                     PIXEL00_80
                     PIXEL01_10
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_0
                         PIXEL03_0
                         PIXEL13_0
@@ -3534,7 +3529,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL10_10
                     PIXEL11_30
                     PIXEL12_0
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_0
                         PIXEL30_0
                         PIXEL31_0
@@ -3551,7 +3546,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 219: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_0
                         PIXEL01_0
                         PIXEL10_0
@@ -3568,7 +3563,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL20_10
                     PIXEL21_30
                     PIXEL22_0
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL23_0
                         PIXEL32_0
                         PIXEL33_0
@@ -3582,7 +3577,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 125: {
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL00_82
                         PIXEL10_32
                         PIXEL20_0
@@ -3613,7 +3608,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL00_82
                     PIXEL01_82
                     PIXEL02_81
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL03_81
                         PIXEL13_31
                         PIXEL22_0
@@ -3638,7 +3633,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 207: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_0
                         PIXEL01_0
                         PIXEL02_32
@@ -3674,7 +3669,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL11_30
                     PIXEL12_32
                     PIXEL13_82
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_0
                         PIXEL21_0
                         PIXEL30_0
@@ -3696,7 +3691,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                 case 190: {
                     PIXEL00_80
                     PIXEL01_10
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_0
                         PIXEL03_0
                         PIXEL12_0
@@ -3722,7 +3717,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 187: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_0
                         PIXEL01_0
                         PIXEL10_0
@@ -3760,7 +3755,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL13_10
                     PIXEL20_82
                     PIXEL21_32
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL22_0
                         PIXEL23_0
                         PIXEL30_82
@@ -3778,7 +3773,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 119: {
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL00_81
                         PIXEL01_31
                         PIXEL02_0
@@ -3819,7 +3814,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL21_0
                     PIXEL22_31
                     PIXEL23_81
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL30_0
                     } else {
                         PIXEL30_20
@@ -3831,7 +3826,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                 }
                 case 175:
                 case 47: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_0
                     } else {
                         PIXEL00_20
@@ -3858,7 +3853,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL00_81
                     PIXEL01_31
                     PIXEL02_0
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL03_0
                     } else {
                         PIXEL03_20
@@ -3894,7 +3889,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL30_82
                     PIXEL31_32
                     PIXEL32_0
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL33_0
                     } else {
                         PIXEL33_20
@@ -3910,7 +3905,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL11_30
                     PIXEL12_30
                     PIXEL13_10
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_0
                         PIXEL30_0
                         PIXEL31_0
@@ -3921,7 +3916,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     }
                     PIXEL21_0
                     PIXEL22_0
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL23_0
                         PIXEL32_0
                         PIXEL33_0
@@ -3933,7 +3928,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 123: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_0
                         PIXEL01_0
                         PIXEL10_0
@@ -3947,7 +3942,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL11_0
                     PIXEL12_30
                     PIXEL13_10
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_0
                         PIXEL30_0
                         PIXEL31_0
@@ -3964,7 +3959,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 95: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_0
                         PIXEL01_0
                         PIXEL10_0
@@ -3973,7 +3968,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                         PIXEL01_50
                         PIXEL10_50
                     }
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_0
                         PIXEL03_0
                         PIXEL13_0
@@ -3997,7 +3992,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                 case 222: {
                     PIXEL00_80
                     PIXEL01_10
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_0
                         PIXEL03_0
                         PIXEL13_0
@@ -4012,7 +4007,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL20_10
                     PIXEL21_30
                     PIXEL22_0
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL23_0
                         PIXEL32_0
                         PIXEL33_0
@@ -4034,7 +4029,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL11_30
                     PIXEL12_31
                     PIXEL13_31
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_0
                         PIXEL30_0
                         PIXEL31_0
@@ -4047,7 +4042,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL22_0
                     PIXEL23_0
                     PIXEL32_0
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL33_0
                     } else {
                         PIXEL33_20
@@ -4066,7 +4061,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL20_0
                     PIXEL21_0
                     PIXEL22_0
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL23_0
                         PIXEL32_0
                         PIXEL33_0
@@ -4075,7 +4070,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                         PIXEL32_50
                         PIXEL33_50
                     }
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL30_0
                     } else {
                         PIXEL30_20
@@ -4084,7 +4079,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 235: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_0
                         PIXEL01_0
                         PIXEL10_0
@@ -4102,7 +4097,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL21_0
                     PIXEL22_31
                     PIXEL23_81
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL30_0
                     } else {
                         PIXEL30_20
@@ -4113,7 +4108,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 111: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_0
                     } else {
                         PIXEL00_20
@@ -4125,7 +4120,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL11_0
                     PIXEL12_32
                     PIXEL13_82
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_0
                         PIXEL30_0
                         PIXEL31_0
@@ -4142,13 +4137,13 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 63: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_0
                     } else {
                         PIXEL00_20
                     }
                     PIXEL01_0
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_0
                         PIXEL03_0
                         PIXEL13_0
@@ -4171,7 +4166,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 159: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_0
                         PIXEL01_0
                         PIXEL10_0
@@ -4181,7 +4176,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                         PIXEL10_50
                     }
                     PIXEL02_0
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL03_0
                     } else {
                         PIXEL03_20
@@ -4203,7 +4198,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL00_81
                     PIXEL01_31
                     PIXEL02_0
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL03_0
                     } else {
                         PIXEL03_20
@@ -4215,7 +4210,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL20_61
                     PIXEL21_30
                     PIXEL22_0
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL23_0
                         PIXEL32_0
                         PIXEL33_0
@@ -4231,7 +4226,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                 case 246: {
                     PIXEL00_80
                     PIXEL01_10
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_0
                         PIXEL03_0
                         PIXEL13_0
@@ -4250,7 +4245,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL30_82
                     PIXEL31_32
                     PIXEL32_0
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL33_0
                     } else {
                         PIXEL33_20
@@ -4260,7 +4255,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                 case 254: {
                     PIXEL00_80
                     PIXEL01_10
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_0
                         PIXEL03_0
                         PIXEL13_0
@@ -4272,7 +4267,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL10_10
                     PIXEL11_30
                     PIXEL12_0
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_0
                         PIXEL30_0
                         PIXEL31_0
@@ -4285,7 +4280,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL22_0
                     PIXEL23_0
                     PIXEL32_0
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL33_0
                     } else {
                         PIXEL33_20
@@ -4305,14 +4300,14 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL21_0
                     PIXEL22_0
                     PIXEL23_0
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL30_0
                     } else {
                         PIXEL30_20
                     }
                     PIXEL31_0
                     PIXEL32_0
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL33_0
                     } else {
                         PIXEL33_20
@@ -4320,7 +4315,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 251: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_0
                         PIXEL01_0
                         PIXEL10_0
@@ -4337,7 +4332,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL20_0
                     PIXEL21_0
                     PIXEL22_0
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL23_0
                         PIXEL32_0
                         PIXEL33_0
@@ -4346,7 +4341,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                         PIXEL32_50
                         PIXEL33_50
                     }
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL30_0
                     } else {
                         PIXEL30_20
@@ -4355,7 +4350,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 239: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_0
                     } else {
                         PIXEL00_20
@@ -4371,7 +4366,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL21_0
                     PIXEL22_31
                     PIXEL23_81
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL30_0
                     } else {
                         PIXEL30_20
@@ -4382,13 +4377,13 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 127: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_0
                     } else {
                         PIXEL00_20
                     }
                     PIXEL01_0
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL02_0
                         PIXEL03_0
                         PIXEL13_0
@@ -4400,7 +4395,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL10_0
                     PIXEL11_0
                     PIXEL12_0
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL20_0
                         PIXEL30_0
                         PIXEL31_0
@@ -4417,14 +4412,14 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 191: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_0
                     } else {
                         PIXEL00_20
                     }
                     PIXEL01_0
                     PIXEL02_0
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL03_0
                     } else {
                         PIXEL03_20
@@ -4444,7 +4439,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 223: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_0
                         PIXEL01_0
                         PIXEL10_0
@@ -4454,7 +4449,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                         PIXEL10_50
                     }
                     PIXEL02_0
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL03_0
                     } else {
                         PIXEL03_20
@@ -4465,7 +4460,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL20_10
                     PIXEL21_30
                     PIXEL22_0
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL23_0
                         PIXEL32_0
                         PIXEL33_0
@@ -4482,7 +4477,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL00_81
                     PIXEL01_31
                     PIXEL02_0
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL03_0
                     } else {
                         PIXEL03_20
@@ -4498,7 +4493,7 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL30_82
                     PIXEL31_32
                     PIXEL32_0
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL33_0
                     } else {
                         PIXEL33_20
@@ -4506,14 +4501,14 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     break;
                 }
                 case 255: {
-                    if (Diff(w[4], w[2])) {
+                    if (DiffYUV(yuv[4], yuv[2])) {
                         PIXEL00_0
                     } else {
                         PIXEL00_20
                     }
                     PIXEL01_0
                     PIXEL02_0
-                    if (Diff(w[2], w[6])) {
+                    if (DiffYUV(yuv[2], yuv[6])) {
                         PIXEL03_0
                     } else {
                         PIXEL03_20
@@ -4526,14 +4521,14 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
                     PIXEL21_0
                     PIXEL22_0
                     PIXEL23_0
-                    if (Diff(w[8], w[4])) {
+                    if (DiffYUV(yuv[8], yuv[4])) {
                         PIXEL30_0
                     } else {
                         PIXEL30_20
                     }
                     PIXEL31_0
                     PIXEL32_0
-                    if (Diff(w[6], w[8])) {
+                    if (DiffYUV(yuv[6], yuv[8])) {
                         PIXEL33_0
                     } else {
                         PIXEL33_20
@@ -4544,3 +4539,10 @@ void hq4x(Pixbuf const &src, Pixbuf &dst) {
         }
     }
 }
+
+
+void hq4x(Pixbuf const &src, Pixbuf &dst) {
+    pixbuf_process_row_bands(src.get_width(), src.get_height(), [&](int y1, int y2) {
+        hq4x_rows(src, dst, y1, y2);
+    });
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2007-2018, GDash Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "config.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "gfx/pixbufmanip_hqx.hpp"
+
+HqxRows::HqxRows(Pixbuf const &src, int y)
+    : src(src), y(y), pattern(src.get_width()) {
+    int sw = src.get_width();
+    int sh = src.get_height();
+    for (auto &buffer : buffers)
+        buffer.resize(sw + 2);
+    prev = buffers[0].data();
+    line = buffers[1].data();
+    nextl = buffers[2].data();
+    convert_row(y > 0 ? y - 1 : sh - 1, prev);
+    convert_row(y, line);
+    convert_row(y < sh - 1 ? y + 1 : 0, nextl);
+    calculate_patterns();
+}
+
+
+void HqxRows::next() {
+    int sh = src.get_height();
+    y++;
+    /* the buffer of the previous row is reused */
+    guint32 *oldprev = prev;
+    prev = line;
+    line = nextl;
+    nextl = oldprev;
+    convert_row(y < sh - 1 ? y + 1 : 0, nextl);
+    calculate_patterns();
+}
+
+
+void HqxRows::convert_row(int row, guint32 *dest) const {
+    int sw = src.get_width();
+    guint32 const *p = src.get_row(row);
+    for (int i = 0; i < sw; i++)
+        dest[i + 1] = RGBtoYUV(p[i]);
+    dest[0] = dest[sw];
+    dest[sw + 1] = dest[1];
+}
+
+
+void HqxRows::calculate_patterns() {
+    int sw = src.get_width();
+    int i = 0;
+#ifdef __SSE2__
+    /* |a-b| is calculated bytewise, and compared to the thresholds: v, u, y and
+     * the unused highest byte. the subtraction saturates to zero if the difference
+     * is not greater than the threshold. */
+    __m128i const thresholds = _mm_set1_epi32(0xff000000 | trY | trU | trV);
+    __m128i const zero = _mm_setzero_si128();
+    for (; i + 4 <= sw; i += 4) {
+        __m128i w5 = _mm_loadu_si128(reinterpret_cast<__m128i const *>(line + i + 1));
+        __m128i const neighbours[8] = {
+            _mm_loadu_si128(reinterpret_cast<__m128i const *>(prev + i)),
+            _mm_loadu_si128(reinterpret_cast<__m128i const *>(prev + i + 1)),
+            _mm_loadu_si128(reinterpret_cast<__m128i const *>(prev + i + 2)),
+            _mm_loadu_si128(reinterpret_cast<__m128i const *>(line + i)),
+            _mm_loadu_si128(reinterpret_cast<__m128i const *>(line + i + 2)),
+            _mm_loadu_si128(reinterpret_cast<__m128i const *>(nextl + i)),
+            _mm_loadu_si128(reinterpret_cast<__m128i const *>(nextl + i + 1)),
+            _mm_loadu_si128(reinterpret_cast<__m128i const *>(nextl + i + 2)),
+        };
+        int p[4] = {0, 0, 0, 0};
+        for (int k = 0; k < 8; k++) {
+            __m128i diff = _mm_or_si128(_mm_subs_epu8(w5, neighbours[k]), _mm_subs_epu8(neighbours[k], w5));
+            __m128i over = _mm_subs_epu8(diff, thresholds);
+            int same = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(over, zero)));
+            p[0] |= (~same & 1) << k;
+            p[1] |= (~same >> 1 & 1) << k;
+            p[2] |= (~same >> 2 & 1) << k;
+            p[3] |= (~same >> 3 & 1) << k;
+        }
+        pattern[i] = p[0];
+        pattern[i + 1] = p[1];
+        pattern[i + 2] = p[2];
+        pattern[i + 3] = p[3];
+    }
+#endif
+    for (; i < sw; i++) {
+        guint32 YUV1 = line[i + 1];
+        guint32 const w[8] = { prev[i], prev[i + 1], prev[i + 2], line[i], line[i + 2], nextl[i], nextl[i + 1], nextl[i + 2] };
+        int p = 0;
+        for (int k = 0; k < 8; k++)
+            if (DiffYUV(YUV1, w[k]))
+                p |= 1 << k;
+        pattern[i] = p;
+    }
+}
@@ -28,6 +28,7 @@
 
 #include <glib.h>
 #include <cstdlib>
+#include <vector>
 #include "gfx/pixbuf.hpp"
 
 #define Ymask 0x00FF0000
@@ -57,15 +58,47 @@ inline guint32 RGBtoYUV(guint32 c) {
     return (y << 16) + (u << 8) + v;
 }
 
-/* Test if there is difference in color */
-inline int Diff(guint32 w1, guint32 w2) {
-    guint32 YUV1 = RGBtoYUV(w1);
-    guint32 YUV2 = RGBtoYUV(w2);
+/* Test if there is difference in color, given the yuv values */
+inline int DiffYUV(guint32 YUV1, guint32 YUV2) {
     return (abs(gint32(YUV1 & Ymask) - gint32(YUV2 & Ymask)) > trY)
            || (abs(gint32(YUV1 & Umask) - gint32(YUV2 & Umask)) > trU)
            || (abs(gint32(YUV1 & Vmask) - gint32(YUV2 & Vmask)) > trV);
 }
 
+/* Test if there is difference in color */
+inline int Diff(guint32 w1, guint32 w2) {
+    return DiffYUV(RGBtoYUV(w1), RGBtoYUV(w2));
+}
+
+
+/// The YUV values and the neighbour patterns of three consecutive rows of an
+/// image, used by the hqNx scalers. The YUV rows are padded with the
+/// wrapped-around pixel on both ends, so they can be indexed from -1 to width.
+/// Pattern bits are set for neighbours w1, w2, w3, w4, w6, w7, w8, w9 (bit 0-7)
+/// which differ from the center pixel.
+class HqxRows {
+public:
+    /// Prepare the rows around row y of the image.
+    HqxRows(Pixbuf const &src, int y);
+    /// Step to the next row.
+    void next();
+
+    guint32 const *prev_yuv() const { return prev + 1; }
+    guint32 const *yuv() const { return line + 1; }
+    guint32 const *next_yuv() const { return nextl + 1; }
+    int const *patterns() const { return pattern.data(); }
+
+private:
+    Pixbuf const &src;
+    int y;
+    std::vector<guint32> buffers[3];
+    std::vector<int> pattern;
+    guint32 *prev, *line, *nextl;
+
+    void convert_row(int row, guint32 *dest) const;
+    void calculate_patterns();
+};
+
 /* Interpolate functions */
 inline void Interp1(guint32 *pc, guint32 c1, guint32 c2) {
     //*pc = (c1*3+c2)/4;
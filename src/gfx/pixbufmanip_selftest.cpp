@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2007-2018, GDash Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "config.h"
+
+#include <glib.h>
+#include <memory>
+#include <string>
+#include <stdexcept>
+
+#include "gfx/pixbufmanip_selftest.hpp"
+#include "gfx/pixbufmanip.hpp"
+#include "gfx/pixbuf.hpp"
+#include "gfx/pixbuffactory.hpp"
+#include "misc/util.hpp"
+#include "settings.hpp"
+
+/* the images of the built-in theme */
+#include "c64_gfx.cpp"
+#include "c64_font.cpp"
+
+/*
+ * The scalers are optimized versions of simple reference implementations,
+ * and they must give exactly the same output. The checksums below were
+ * calculated from the output of the reference implementations (the plain
+ * per-pixel scalers of GDash export-1.9.15) for the built-in images and
+ * the themes installed with the game. The checksum is the SHA-1 of the RGBA
+ * pixels of the scaled image, row by row, without padding.
+ */
+
+struct SelftestImage {
+    char const *name;
+    unsigned char const *data;      /* built-in image; if NULL, the theme file is loaded */
+    int length;
+};
+
+static SelftestImage const selftest_images[] = {
+    { "c64_gfx.png", c64_gfx, sizeof(c64_gfx) },
+    { "c64_font.png", c64_font, sizeof(c64_font) },
+    { "c64_gfx_bd2.png", NULL, 0 },
+    { "c64_gfx_bd3.png", NULL, 0 },
+    { "boulder_rush.png", NULL, 0 },        /* truecolor */
+    { "boulder_rush_cws.png", NULL, 0 },    /* truecolor */
+};
+
+enum { SELFTEST_NUM_IMAGES = sizeof(selftest_images) / sizeof(selftest_images[0]) };
+
+struct SelftestScaler {
+    char const *name;
+    int factor;
+    void (*scaler)(Pixbuf const &src, Pixbuf &dest);
+    char const *checksums[SELFTEST_NUM_IMAGES];     /* in the order of the images */
+};
+
+static SelftestScaler const selftest_scalers[] = {
+    { "scale2x", 2, scale2x, {
+            "713d28fe308d643cfd9935248ff0944064ef9609",
+            "453ef12c98c96f21eb069ef4823807a23bfb25f7",
+            "fd843575e38c0f7d21b9c0fc9878e8f50f6f21a7",
+            "5ef15bbe305417f738040271aa2232f69ab14f8d",
+            "cd63b3f1f00381bc4ba494d8d8b6c1cc430f0d04",
+            "587eea389d0cca5b0fecb76e3c5f4eb8f32d69e9" }
+    },
+    { "scale3x", 3, scale3x, {
+            "94951aa0cf4bc3477fabc5a8dd44e98ca9d74c2b",
+            "89d12cd2da6b606fa25bf88a8c15826a5e8c9a2a",
+            "cf5933491fbee3c9c9581e85946b84cdf95305e8",
+            "95dd567785027db0fac95c84c91ca56928ea0f15",
+            "df48d4ecde9abe1853ae130b52503e54351bb051",
+            "b5752322df846b99c49365c054c0c02a753f29ef" }
+    },
+    { "hq2x", 2, hq2x, {
+            "fce046ef425687108dca07022e99aecb0bbbcc2b",
+            "c4ca06fc52a7a70c89deaffcbf790c90f1f6143f",
+            "935c4d634f9fca9b745b45bc8d834906760f3e55",
+            "f8e0dd26a77cedbc0e323e0db49fad227b50f2c1",
+            "b5e1ed93edffffe87fdcef9153a9caf479c67227",
+            "cc7453b42a0134ac08270ad6fc72b782eb4e2697" }
+    },
+    { "hq3x", 3, hq3x, {
+            "0a116d2a6bcf4406585649221c890254e636b979",
+            "65ce49abc3596f383bbe9a088a0428c4d992c0bc",
+            "1a706278555264624d155ddc7aa05920cc1df7fe",
+            "432ac82f24198a84c32434f6e9988ec0e67bc8c3",
+            "29d81ff4a7060525d4566f04754658c1dda19543",
+            "1bb2c80ce381cebeb2d91370a4db49293fcd710c" }
+    },
+    { "hq4x", 4, hq4x, {
+            "6d739e112942e78728defc1a0f20e65f6376e9c8",
+            "755e8b82b7f3a308430be7628de106684d78fa5b",
+            "e204de755780456aaa20ee8cf7acf3817b35cd83",
+            "d65b01e7489c548413e3a6ad5f11c70ce62b70c8",
+            "8b45458c29f077f2bb4b1446e7222b7763cff43f",
+            "7dd4439b1542fcb6c03753eeddb2f0b7f5c6fecd" }
+    },
+};
+
+
+static std::string pixbuf_checksum(Pixbuf const &pb) {
+    GChecksum *checksum = g_checksum_new(G_CHECKSUM_SHA1);
+    for (int y = 0; y < pb.get_height(); ++y)
+        g_checksum_update(checksum, reinterpret_cast<guchar const *>(pb.get_row(y)), pb.get_width() * 4);
+    std::string result = g_checksum_get_string(checksum);
+    g_checksum_free(checksum);
+    return result;
+}
+
+
+bool pixbuf_scalers_selftest(PixbufFactory &factory) {
+    bool all_ok = true;
+
+    for (auto const &image : selftest_images) {
+        std::unique_ptr<Pixbuf> src;
+        try {
+            if (image.data != NULL)
+                src = factory.create_from_inline(image.length, image.data);
+            else {
+                std::string filename = gd_find_data_file(image.name, gd_themes_dirs);
+                if (filename == "")
+                    throw std::runtime_error("not found");
+                src = factory.create_from_file(filename.c_str());
+            }
+        } catch (std::exception &e) {
+            /* the themes are installed with the game, so a missing one is a failure, too */
+            g_print("%-10s %-20s FAIL cannot load: %s\n", "all", image.name, e.what());
+            all_ok = false;
+            continue;
+        }
+        int index = &image - selftest_images;
+
+        for (auto const &test : selftest_scalers) {
+            std::unique_ptr<Pixbuf> dest = factory.create(src->get_width() * test.factor, src->get_height() * test.factor);
+            test.scaler(*src, *dest);
+            bool ok = pixbuf_checksum(*dest) == test.checksums[index];
+            if (!ok)
+                all_ok = false;
+
+            /* run it for at least 200ms to get the average time */
+            int runs = 0;
+            gint64 start = g_get_monotonic_time(), elapsed;
+            do {
+                test.scaler(*src, *dest);
+                ++runs;
+                elapsed = g_get_monotonic_time() - start;
+            } while (elapsed < 200000);
+
+            g_print("%-10s %-20s %-4s %8.3f ms\n", test.name, image.name, ok ? "ok" : "FAIL", elapsed / 1000.0 / runs);
+        }
+    }
+
+    return all_ok;
+}
@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2007-2018, GDash Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "config.h"
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <cstring>
+#include <cerrno>
+#ifdef HAVE_LIBPNG
+#include <png.h>
+#elif defined(HAVE_GTK)
+#include <gdk-pixbuf/gdk-pixbuf.h>
+#endif
+
+#include "gfx/pngwriter.hpp"
+#include "misc/logger.hpp"
+#include "misc/printf.hpp"
+
+
+struct PngWriter::Job {
+    PngWriter *writer;
+    std::string filename;
+    int width, height, channels;
+    std::vector<unsigned char> pixels;  ///< rows without padding
+};
+
+
+#ifdef HAVE_LIBPNG
+static bool write_png(char const *filename, int width, int height, int channels, unsigned char const *pixels, int compression, std::string &error) {
+    FILE *fp = g_fopen(filename, "wb");
+    if (fp == NULL) {
+        error = Printf("%s: %s", filename, g_strerror(errno));
+        return false;
+    }
+    png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+    png_infop info = png ? png_create_info_struct(png) : NULL;
+    if (info == NULL || setjmp(png_jmpbuf(png))) {
+        png_destroy_write_struct(&png, &info);
+        fclose(fp);
+        error = Printf("%s: cannot write png file", filename);
+        return false;
+    }
+    png_init_io(png, fp);
+    png_set_compression_level(png, compression);
+    png_set_IHDR(png, info, width, height, 8, channels == 4 ? PNG_COLOR_TYPE_RGB_ALPHA : PNG_COLOR_TYPE_RGB,
+                 PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+    png_write_info(png, info);
+    for (int y = 0; y < height; ++y)
+        png_write_row(png, const_cast<png_bytep>(pixels + y * width * channels));
+    png_write_end(png, info);
+    png_destroy_write_struct(&png, &info);
+    if (fclose(fp) != 0) {
+        error = Printf("%s: %s", filename, g_strerror(errno));
+        return false;
+    }
+    return true;
+}
+#elif defined(HAVE_GTK)
+static bool write_png(char const *filename, int width, int height, int channels, unsigned char const *pixels, int compression, std::string &error) {
+    GdkPixbuf *pixbuf = gdk_pixbuf_new_from_data(pixels, GDK_COLORSPACE_RGB, channels == 4, 8, width, height, width * channels, NULL, NULL);
+    GError *gerror = NULL;
+    std::string level = Printf("%d", compression);
+    gboolean ok = gdk_pixbuf_save(pixbuf, filename, "png", &gerror, "compression", level.c_str(), NULL);
+    g_object_unref(pixbuf);
+    if (!ok) {
+        error = Printf("%s: %s", filename, gerror->message);
+        g_error_free(gerror);
+    }
+    return ok;
+}
+#else
+static bool write_png(char const *filename, int, int, int, unsigned char const *, int, std::string &error) {
+    error = Printf("%s: compiled without png support", filename);
+    return false;
+}
+#endif
+
+
+PngWriter::PngWriter(int compression, unsigned max_queued)
+    : compression(compression), max_queued(max_queued), pending(0) {
+    g_mutex_init(&mutex);
+    g_cond_init(&cond);
+    int threads = g_get_num_processors();
+    if (this->max_queued == 0)
+        this->max_queued = threads * 2;
+    pool = g_thread_pool_new(worker_func, this, threads, FALSE, NULL);
+}
+
+
+PngWriter::~PngWriter() {
+    wait();
+    g_thread_pool_free(pool, FALSE, TRUE);
+    g_cond_clear(&cond);
+    g_mutex_clear(&mutex);
+}
+
+
+void PngWriter::save(std::string const &filename, int width, int height, int channels, unsigned char const *pixels, int rowstride) {
+    /* wait for a free place first, so there are never more than max_queued copies */
+    g_mutex_lock(&mutex);
+    while (pending >= max_queued)
+        g_cond_wait(&cond, &mutex);
+    pending++;
+    g_mutex_unlock(&mutex);
+
+    Job *job = new Job;
+    job->writer = this;
+    job->filename = filename;
+    job->width = width;
+    job->height = height;
+    job->channels = channels;
+    job->pixels.resize(width * height * channels);
+    for (int y = 0; y < height; ++y)
+        memcpy(&job->pixels[y * width * channels], pixels + y * rowstride, width * channels);
+    g_thread_pool_push(pool, job, NULL);
+}
+
+
+void PngWriter::worker_func(gpointer data, gpointer) {
+    Job *job = static_cast<Job *>(data);
+    PngWriter *writer = job->writer;
+    std::string error;
+    bool ok = write_png(job->filename.c_str(), job->width, job->height, job->channels, job->pixels.data(), writer->compression, error);
+    delete job;
+
+    g_mutex_lock(&writer->mutex);
+    if (!ok)
+        writer->errors.push_back(error);
+    writer->pending--;
+    g_cond_broadcast(&writer->cond);
+    g_mutex_unlock(&writer->mutex);
+}
+
+
+bool PngWriter::wait(std::string *errors) {
+    g_mutex_lock(&mutex);
+    while (pending > 0)
+        g_cond_wait(&cond, &mutex);
+    std::vector<std::string> failed;
+    failed.swap(this->errors);
+    g_mutex_unlock(&mutex);
+
+    /* the messages are reported here, as the logger is not to be used from the threads */
+    for (auto const &error : failed) {
+        if (errors != NULL) {
+            if (!errors->empty())
+                *errors += "\n";
+            *errors += error;
+        } else
+            gd_warning(error.c_str());
+    }
+    return failed.empty();
+}
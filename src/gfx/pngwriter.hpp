@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2007-2018, GDash Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PNGWRITER_HPP_INCLUDED
+#define PNGWRITER_HPP_INCLUDED
+
+#include "config.h"
+
+#include <glib.h>
+#include <string>
+#include <vector>
+
+/// @ingroup Graphics
+/// Saves images to PNG files with a pool of threads.
+/// The caller hands over the pixels and continues; the images are compressed
+/// and written in the background. If too many images are waiting, save() waits
+/// for the threads, so the memory used stays bounded.
+class PngWriter {
+public:
+    /// @param compression The zlib compression level, 0 (fastest) to 9 (smallest files).
+    /// @param max_queued The number of images which can wait to be written; 0 means twice the number of threads.
+    explicit PngWriter(int compression, unsigned max_queued = 0);
+    /// Waits for all images to be written.
+    ~PngWriter();
+
+    /// Save an image. The pixels are copied, so they can be reused after the call.
+    /// @param filename The name of the PNG file.
+    /// @param width Width of the image in pixels.
+    /// @param height Height of the image in pixels.
+    /// @param channels 3 for RGB, 4 for RGBA bytes in memory, like the Pixbuf class.
+    /// @param pixels The first row of the image.
+    /// @param rowstride Bytes per row.
+    void save(std::string const &filename, int width, int height, int channels, unsigned char const *pixels, int rowstride);
+
+    /// Wait for all images saved so far to be written.
+    /// @param errors If given, the error messages are stored here, otherwise they are logged.
+    /// @return True, if all images could be written.
+    bool wait(std::string *errors = NULL);
+
+private:
+    PngWriter(PngWriter const &) = delete;
+    PngWriter &operator=(PngWriter const &) = delete;
+
+    struct Job;
+    static void worker_func(gpointer data, gpointer user_data);
+
+    int compression;
+    unsigned max_queued;
+    GThreadPool *pool;
+    GMutex mutex;
+    GCond cond;
+    /// The number of images handed over, but not yet written.
+    unsigned pending;
+    std::vector<std::string> errors;
+};
+
+#endif
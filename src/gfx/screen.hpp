@@ -32,7 +32,7 @@
 #include "gfx/pixbuffactory.hpp"
 
 class GdColor;
-class ParticleSet;
+class ParticlePool;
 class Pixbuf;
 class PixmapStorage;
 
@@ -100,6 +100,11 @@ public:
         return scaling_factor;
     }
 
+    /// @brief Return the scaling algorithm used for pixbuf->pixmap conversion.
+    GdScalingType get_scaling_type() const {
+        return scaling_type;
+    }
+
     /// @brief Returns true, if the screen uses software pal emulation.
     bool get_pal_emulation() const {
         return pal_emulation;
@@ -128,10 +133,22 @@ public:
     virtual void blit(Pixmap const &src, int dx, int dy) const = 0;
     void blit_pixbuf(Pixbuf const &src, int dx, int dy, bool keep_alpha);
 
+    /// @brief Create an off-screen pixmap, which can be drawn on with blit_to_layer().
+    /// The layer can be blitted to the screen like any other pixmap.
+    /// @return The new layer, or nullptr if the screen does not support layers.
+    virtual std::unique_ptr<Pixmap> create_layer(int w, int h) const {
+        return nullptr;
+    }
+    /// @brief Draw a pixmap onto a layer created by create_layer().
+    virtual void blit_to_layer(Pixmap const &src, Pixmap &layer, int dx, int dy) const {}
+
     virtual void set_clip_rect(int x1, int y1, int w, int h) = 0;
     virtual void remove_clip_rect() = 0;
 
-    virtual void draw_particle_set(int dx, int dy, ParticleSet const &ps) {}
+    /// Draw the particles of a frame.
+    /// @param dx, dy The pixel coordinates of the top left corner of the cave.
+    /// @param factor Pixels per cave cell, to convert the coordinates of the particles.
+    virtual void draw_particles(int dx, int dy, double factor, ParticlePool const &particles) {}
 
     /** 
      * Tell the graphics system to accept text input;
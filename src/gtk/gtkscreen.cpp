@@ -36,12 +36,12 @@
 #include "misc/logger.hpp"
 
 int GTKPixmap::get_width() const {
-    return gdk_pixbuf_get_width(pixbuf.get());
+    return pixbuf != nullptr ? gdk_pixbuf_get_width(pixbuf.get()) : w;
 }
 
 
 int GTKPixmap::get_height() const {
-    return gdk_pixbuf_get_height(pixbuf.get());
+    return pixbuf != nullptr ? gdk_pixbuf_get_height(pixbuf.get()) : h;
 }
 
 
@@ -185,6 +185,23 @@ void GTKScreen::blit(Pixmap const &src, int dx, int dy) const {
 }
 
 
+std::unique_ptr<Pixmap> GTKScreen::create_layer(int w, int h) const {
+    /* similar to the back buffer, like the pixmaps of the cells. */
+    cairo_surface_t *surface = cairo_surface_create_similar(back.get(), CAIRO_CONTENT_COLOR, w, h);
+    return std::make_unique<GTKPixmap>(surface, w, h);
+}
+
+
+void GTKScreen::blit_to_layer(Pixmap const &src, Pixmap &layer, int dx, int dy) const {
+    GTKPixmap &srcgtk = const_cast<GTKPixmap &>(static_cast<GTKPixmap const &>(src));
+    cairo_t *crs = cairo_create(static_cast<GTKPixmap &>(layer).get_cairo_surface());
+    cairo_set_source_surface(crs, srcgtk.get_cairo_surface(), dx, dy);
+    cairo_rectangle(crs, dx, dy, src.get_width(), src.get_height());
+    cairo_fill(crs);
+    cairo_destroy(crs);
+}
+
+
 std::unique_ptr<Pixmap> GTKScreen::create_pixmap_from_pixbuf(const Pixbuf &pb, bool keep_alpha) const {
     GdkPixbuf *pixbuf = (GdkPixbuf *) static_cast<GTKPixbuf const &>(pb).get_gdk_pixbuf();
     /* we keep the pixmap in a surface that is similar to the back buffer.
@@ -203,21 +220,34 @@ std::unique_ptr<Pixmap> GTKScreen::create_pixmap_from_pixbuf(const Pixbuf &pb, b
 }
 
 
-void GTKScreen::draw_particle_set(int dx, int dy, ParticleSet const &ps) {
-    unsigned char r, g, b;
-    ps.color.get_rgb(r, g, b);
-    cairo_set_source_rgba(cr.get(), r / 255.0, g / 255.0, b / 255.0, ps.life / 1000.0 * ps.opacity);
-    int size = ceil(ps.size);
-    /* cairo gets the center of the pixel, like opengl. because it works with
-     * float coordinates, not integers.
-     * dx0, dy0 are the center, and the sides "outgrow". */
-    double dxm = dx - size, dx0 = dx + 0.5, dxp = dx + size + 1;
-    double dym = dy - size, dy0 = dy + 0.5, dyp = dy + size + 1;
-    for (ParticleSet::const_iterator it = ps.begin(); it != ps.end(); ++it) {
-        cairo_move_to(cr.get(), (int)it->px + dx0, (int)it->py + dym);
-        cairo_line_to(cr.get(), (int)it->px + dxp, (int)it->py + dy0);
-        cairo_line_to(cr.get(), (int)it->px + dx0, (int)it->py + dyp);
-        cairo_line_to(cr.get(), (int)it->px + dxm, (int)it->py + dy0);
+void GTKScreen::draw_particles(int dx, int dy, double factor, ParticlePool const &particles) {
+    GdColor last_color;
+    int last_life = -1;
+    float last_opacity = -1, last_size = -1;
+    int size = 0;
+    for (size_t i = 0; i < particles.num_particles(); ++i) {
+        /* only change the source if needed; particles added together are next to each other. */
+        if (particles.life[i] != last_life || particles.opacity[i] != last_opacity
+                || particles.size[i] != last_size || particles.color[i] != last_color) {
+            last_life = particles.life[i];
+            last_opacity = particles.opacity[i];
+            last_size = particles.size[i];
+            last_color = particles.color[i];
+            unsigned char r, g, b;
+            last_color.get_rgb(r, g, b);
+            cairo_set_source_rgba(cr.get(), r / 255.0, g / 255.0, b / 255.0, last_life / 1000.0 * last_opacity);
+            size = ceil(last_size * factor);
+        }
+        /* cairo gets the center of the pixel, like opengl. because it works with
+         * float coordinates, not integers.
+         * x0, y0 are the center, and the sides "outgrow". */
+        int px = particles.px[i] * factor, py = particles.py[i] * factor;
+        double xm = dx + px - size, x0 = dx + px + 0.5, xp = dx + px + size + 1;
+        double ym = dy + py - size, y0 = dy + py + 0.5, yp = dy + py + size + 1;
+        cairo_move_to(cr.get(), x0, ym);
+        cairo_line_to(cr.get(), xp, y0);
+        cairo_line_to(cr.get(), x0, yp);
+        cairo_line_to(cr.get(), xm, y0);
         cairo_fill(cr.get());
     }
 }
@@ -32,18 +32,21 @@
 #include "misc/deleter.hpp"
 
 class PixbufFactory;
-class ParticleSet;
+class ParticlePool;
 
 /** Implementation of the Pixmap interface, using GTK+ cairo functions. */
 class GTKPixmap: public Pixmap {
 private:
     std::unique_ptr<GdkPixbuf, Deleter<void, g_object_unref>> pixbuf;
     std::unique_ptr<cairo_surface_t, Deleter<cairo_surface_t, cairo_surface_destroy>> surface;
+    int w, h;               ///< size, if there is no pixbuf
 
 public:
-    GTKPixmap(GdkPixbuf *pixbuf, cairo_surface_t *surface): pixbuf(pixbuf), surface(surface) {
+    GTKPixmap(GdkPixbuf *pixbuf, cairo_surface_t *surface): pixbuf(pixbuf), surface(surface), w(0), h(0) {
         g_object_ref(pixbuf);
     }
+    /// Create a pixmap without a pixbuf; used for layers.
+    GTKPixmap(cairo_surface_t *surface, int w, int h): surface(surface), w(w), h(h) {}
 
     virtual int get_width() const;
     virtual int get_height() const;
@@ -90,7 +93,9 @@ public:
 
     virtual void fill_rect(int x, int y, int w, int h, const GdColor &c);
     virtual void blit(Pixmap const &src, int dx, int dy) const;
-    virtual void draw_particle_set(int dx, int dy, ParticleSet const &ps);
+    virtual std::unique_ptr<Pixmap> create_layer(int w, int h) const;
+    virtual void blit_to_layer(Pixmap const &src, Pixmap &layer, int dx, int dy) const;
+    virtual void draw_particles(int dx, int dy, double factor, ParticlePool const &particles);
 
     virtual void set_clip_rect(int x1, int y1, int w, int h);
     virtual void remove_clip_rect();
@@ -26,6 +26,8 @@
 #include <glib.h>
 #include <glib/gi18n.h>
 #include <fstream>
+#include <algorithm>
+#include <memory>
 
 #ifdef HAVE_GTK
 #include <gtk/gtk.h>
@@ -51,6 +53,7 @@
 #include "fileops/binaryimport.hpp"
 #include "fileops/exportcrli.hpp"
 #include "input/joystick.hpp"
+#include "gfx/pixbufmanip_selftest.hpp"
 
 #ifdef HAVE_GTK
 #include "editor/editor.hpp"
@@ -61,6 +64,12 @@
 #include "gtk/gtkscreen.hpp"
 #include "gtk/gtkui.hpp"
 #include "misc/helphtml.hpp"
+#include "gfx/pngwriter.hpp"
+#endif
+
+#ifdef HAVE_SDL
+#include "framework/replaysaveractivity.hpp"
+#include "sdl/sdlpixbuffactory.hpp"
 #endif
 
 #include "mainwindow.hpp"
@@ -69,6 +78,56 @@
 #include "levels.cpp"
 
 
+#ifdef HAVE_GTK
+/* parses the --png-size parameter. the default size is 128x96, 0x0 is for unscaled. */
+static void parse_png_size(char const *png_size, unsigned &size_x, unsigned &size_y) {
+    size_x = 128;
+    size_y = 96;
+    if (png_size && (sscanf(png_size, "%ux%u", &size_x, &size_y) != 2))
+        gd_warning(_("Invalid image size: %s"), png_size);
+    if (size_x < 1 || size_y < 1) {
+        size_x = 0;
+        size_y = 0;
+    }
+}
+
+
+/* saves the images of all caves of the caveset, on the given number of levels and seeds.
+ * the caves are rendered by all processors, drawn in this thread, and compressed by the writer threads. */
+static void save_caveset_pngs(CaveSet &caveset, std::string const &prefix, EditorCellRenderer &cr, PngWriter &png_writer,
+                              unsigned size_x, unsigned size_y, int levels, int seeds) {
+    struct Image {
+        int cave, level, seed;
+        std::unique_ptr<CaveRendered> rendered;
+    };
+    std::vector<Image> images;
+    for (int cave = 0; cave < int(caveset.caves.size()); ++cave)
+        for (int level = 0; level < levels; ++level)
+            for (int seed = 0; seed < seeds; ++seed)
+                images.push_back(Image { cave, level, seed, nullptr });
+
+    /* in batches, so only some of the rendered caves are in the memory at once */
+    size_t const batch_size = 64;
+    for (size_t first = 0; first < images.size(); first += batch_size) {
+        size_t last = std::min(images.size(), first + batch_size);
+        gd_parallel_for(last - first, [&](int i) {
+            Image &image = images[first + i];
+            image.rendered = std::make_unique<CaveRendered>(caveset.caves[image.cave], image.level, image.seed);
+        });
+        for (size_t i = first; i < last; ++i) {
+            Image &image = images[i];
+            GdkPixbuf *pixbuf = gd_drawcave_to_pixbuf(*image.rendered, cr, size_x, size_y, true, false);
+            std::string filename = gd_tostring_free(g_strdup_printf("%s_%03d_L%d_S%d.png", prefix.c_str(), image.cave + 1, image.level + 1, image.seed));
+            png_writer.save(filename, gdk_pixbuf_get_width(pixbuf), gdk_pixbuf_get_height(pixbuf),
+                            gdk_pixbuf_get_n_channels(pixbuf), gdk_pixbuf_get_pixels(pixbuf), gdk_pixbuf_get_rowstride(pixbuf));
+            g_object_unref(pixbuf);
+            image.rendered.reset();
+        }
+    }
+}
+#endif
+
+
 
 int main(int argc, char *argv[]) {
     CaveSet caveset;
@@ -79,12 +138,19 @@ int main(int argc, char *argv[]) {
     char *gallery_filename = NULL;
     char *text_dump_filename = NULL;
     char *png_filename = NULL, *png_size = NULL;
+    char *png_folder = NULL;
+    gboolean png_all_levels = FALSE;
+    int png_seeds = 1;
+    gboolean selftest_scalers = FALSE;
     char *save_cave_name = NULL, *save_gds_name = NULL;
     int exportcrli = 0;
     char *save_cave_name_flat = NULL;
 #ifdef HAVE_GTK
     int save_doc_lang = -1;
 #endif
+#ifdef HAVE_SDL
+    char *replay_folder = NULL;
+#endif
 
     GError *error = NULL;
     GOptionEntry entries[] = {
@@ -96,13 +162,20 @@ int main(int argc, char *argv[]) {
         {"favicon", 0, 0, G_OPTION_ARG_STRING /* not filename! */, &gd_html_favicon_filename, N_("Link shortcut icon to a HTML gallery, eg. \"../favicon.ico\"")},
         {"save-png", 'p', 0, G_OPTION_ARG_FILENAME, &png_filename, N_("Save image of first cave to PNG")},
         {"png-size", 0, 0, G_OPTION_ARG_STRING, &png_size, N_("Set PNG image size. Default is 128x96, set to 0x0 for unscaled")},
+        {"save-png-all", 0, 0, G_OPTION_ARG_FILENAME, &png_folder, N_("Save images of all caves of all given files to PNG files in a folder")},
+        {"png-all-levels", 0, 0, G_OPTION_ARG_NONE, &png_all_levels, N_("Save images of all five levels with --save-png-all, not only the first one")},
+        {"png-seeds", 0, 0, G_OPTION_ARG_INT, &png_seeds, N_("Save images rendered with this many random seeds (0, 1, ...) with --save-png-all")},
 #endif
         {"save-bdcff", 's', 0, G_OPTION_ARG_FILENAME, &save_cave_name, N_("Save caveset in a BDCFF file")},
         {"save-gds", 'd', 0, G_OPTION_ARG_FILENAME, &save_gds_name, N_("Save imported binary data to a GDS file. An input file name is required.")},
         {"save-crli", 'x', 0, G_OPTION_ARG_NONE, &exportcrli, N_("Save caveset in CrLi files")},
         {"save-flat", 'f', 0, G_OPTION_ARG_FILENAME, &save_cave_name_flat, N_("Save caveset in flattened format")},
+        {"selftest-scalers", 0, 0, G_OPTION_ARG_NONE, &selftest_scalers, N_("Check the output of the image scalers against their reference implementations, and print their speed")},
 #ifdef HAVE_GTK
         {"save-docs", 0, 0, G_OPTION_ARG_INT, &save_doc_lang, N_("Save documentation in HTML, in the given language identified by an integer.")},
+#endif
+#ifdef HAVE_SDL
+        {"save-replays", 0, 0, G_OPTION_ARG_FILENAME, &replay_folder, N_("Save the replays of all caves to YUV4MPEG2 video and WAV files in a folder")},
 #endif
         {"quit", 'q', 0, G_OPTION_ARG_NONE, &quit, N_("Batch mode: quit after specified tasks")},
         {NULL}
@@ -146,6 +219,17 @@ int main(int argc, char *argv[]) {
     }
     g_option_context_free(context);
 
+    /* check the scalers and quit; the exit status is the result. the scalers do not
+     * depend on the user interface, so this is done before initializing gtk. */
+    if (selftest_scalers) {
+#ifdef HAVE_SDL
+        SDLPixbufFactory pf;
+#else
+        GTKPixbufFactory pf;
+#endif
+        return pixbuf_scalers_selftest(pf) ? 0 : 1;
+    }
+
 #ifdef HAVE_GTK
     /* init gtk and set gtk default icon */
     gboolean force_quit_no_gtk = FALSE;
@@ -169,9 +253,8 @@ int main(int argc, char *argv[]) {
             g_print("An input filename must be given for GDS conversion.\n");
             return 1;
         }
-        std::vector<unsigned char> file = load_file_to_vector(gd_param_cavenames[0]);
-        /* -1 because the file loader adds a terminating zero */
-        std::vector<unsigned char> memory = load_memory_dump(&file[0], file.size() - 1);
+        MappedFile file(gd_param_cavenames[0]);
+        unsigned char const *memory = load_memory_dump(file.data(), file.size());
         std::vector<unsigned char> gds = gdash_binary_import(memory);
         std::fstream os(save_gds_name, std::ios::out | std::ios::binary);
         os.write((char *) &gds[0], gds.size());
@@ -216,14 +299,8 @@ int main(int argc, char *argv[]) {
 
     /* save cave png */
     if (png_filename) {
-        unsigned int size_x = 128, size_y = 96; /* default size */
-
-        if (png_size && (sscanf(png_size, "%ux%u", &size_x, &size_y) != 2))
-            gd_warning(_("Invalid image size: %s"), png_size);
-        if (size_x < 1 || size_y < 1) {
-            size_x = 0;
-            size_y = 0;
-        }
+        unsigned int size_x, size_y;
+        parse_png_size(png_size, size_x, size_y);
 
         /* rendering cave for png: seed=0 */
         CaveRendered renderedcave(caveset.caves[0], 0, 0);
@@ -232,12 +309,70 @@ int main(int argc, char *argv[]) {
         EditorCellRenderer cr(scr, gd_theme);
 
         GdkPixbuf *pixbuf = gd_drawcave_to_pixbuf(renderedcave, cr, size_x, size_y, true, false);
-        GError *error = NULL;
-        if (!gdk_pixbuf_save(pixbuf, png_filename, "png", &error, "compression", "9", NULL)) {
-            gd_critical("Error saving PNG image %s: %s", png_filename, error->message);
-            g_error_free(error);
-        }
+        PngWriter png_writer(gd_png_compression);
+        png_writer.save(png_filename, gdk_pixbuf_get_width(pixbuf), gdk_pixbuf_get_height(pixbuf),
+                        gdk_pixbuf_get_n_channels(pixbuf), gdk_pixbuf_get_pixels(pixbuf), gdk_pixbuf_get_rowstride(pixbuf));
         g_object_unref(pixbuf);
+        std::string error;
+        if (!png_writer.wait(&error))
+            gd_critical("Error saving PNG image %s: %s", png_filename, error);
+    }
+
+    /* save images of all caves of all files given */
+    if (png_folder) {
+        unsigned int size_x, size_y;
+        parse_png_size(png_size, size_x, size_y);
+        GTKPixbufFactory pf;
+        GTKScreen scr(pf, NULL);
+        EditorCellRenderer cr(scr, gd_theme);
+        PngWriter png_writer(gd_png_compression);
+        int levels = png_all_levels ? 5 : 1;
+        int seeds = std::max(png_seeds, 1);
+
+        g_mkdir_with_parents(png_folder, 0755);
+        if (gd_param_cavenames && gd_param_cavenames[0]) {
+            for (int i = 0; gd_param_cavenames[i] != NULL; ++i) {
+                /* the first one is already loaded */
+                CaveSet loaded, *cs = &caveset;
+                if (i > 0) {
+                    try {
+                        loaded = load_caveset_from_file(gd_param_cavenames[i]);
+                    } catch (std::exception &e) {
+                        gd_critical(e.what());
+                        continue;
+                    }
+                    cs = &loaded;
+                }
+                /* the images are named after the file, without its extension */
+                std::string name = gd_tostring_free(g_path_get_basename(gd_param_cavenames[i]));
+                if (name.rfind('.') != std::string::npos && name.rfind('.') > 0)
+                    name.erase(name.rfind('.'));
+                std::string prefix = gd_tostring_free(g_build_filename(png_folder, name.c_str(), NULL));
+                save_caveset_pngs(*cs, prefix, cr, png_writer, size_x, size_y, levels, seeds);
+            }
+        } else {
+            std::string prefix = gd_tostring_free(g_build_filename(png_folder, "caveset", NULL));
+            save_caveset_pngs(caveset, prefix, cr, png_writer, size_x, size_y, levels, seeds);
+        }
+        png_writer.wait();
+    }
+#endif
+
+#ifdef HAVE_SDL
+    /* save the replays of all caves, without opening a window */
+    if (replay_folder) {
+        /* one offline mixer for all replays; the sound of the user is not opened
+         * here, it is started below, if a game is started */
+        ReplaySaverSound sound(false);
+        g_mkdir_with_parents(replay_folder, 0755);
+        for (unsigned n = 0; n < caveset.caves.size(); n++) {
+            int r = 0;
+            for (CaveReplay &replay : caveset.caves[n].replays) {
+                std::string name = Printf("cave%02d_replay%02d.y4m", n + 1, ++r);
+                std::string prefix = gd_tostring_free(g_build_filename(replay_folder, name.c_str(), NULL));
+                gd_save_replay(&caveset, &caveset.caves[n], &replay, prefix, &sound);
+            }
+        }
     }
 #endif
 
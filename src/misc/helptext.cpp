@@ -338,8 +338,14 @@ helpdata const replayhelp[] = {
          "They will be overwritten; also they might be incorrectly recognized by Avidemux which will do the "
          "converting of the images to an AVI file. ") },
     { NULL, NULL, NULL, O_NONE,
-      N_("You can watch the replay during the saving process, it is shown in real time. "
-         "(Currently the saving cannot be speeded up.) Don't be surprised: there will be no sound. "
+      N_("If the filename you give ends with .y4m (for example out.y4m), the video frames are written to that single "
+         "YUV4MPEG2 file instead of images, and the audio to out.wav. Most video encoders, like ffmpeg, can read this "
+         "file directly. If the filename starts with a | character, the video stream is sent to the standard input of "
+         "the command after it, and the audio is saved to out.wav in the last used folder. "
+         "For example: |ffmpeg -i - -c:v libx264 out.mp4") },
+    { NULL, NULL, NULL, O_NONE,
+      N_("You can watch the replay during the saving process. It is saved as fast as your computer can do it, "
+         "so it usually runs faster than real time. Don't be surprised: there will be no sound. "
          "But it is of course saved to the disk. One minute of audio data takes around 5 megabytes of "
          "disk space, and the image data rate is usually around 6 megabytes per minute. "
          "When the files are saved, you will be shown the replays menu again.") },
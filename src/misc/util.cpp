@@ -24,8 +24,10 @@
 #include "config.h"
 
 #include <glib.h>
+#include <glib/gstdio.h>
 #include <cstdlib>
 #include <cstring>
+#include <algorithm>
 
 #include "cave/colors.hpp"
 #include "misc/logger.hpp"
@@ -233,3 +235,57 @@ std::vector<std::string> gd_wrap_text(const char *input, int width) {
 
     return retlines;
 }
+
+
+namespace {
+struct ParallelFor {
+    std::function<void(int)> const &func;
+    int count;
+    gint next;
+
+    static gpointer run(gpointer data) {
+        ParallelFor *pf = static_cast<ParallelFor *>(data);
+        /* every thread takes the next index not yet taken, until there is none left */
+        for (int i = g_atomic_int_add(&pf->next, 1); i < pf->count; i = g_atomic_int_add(&pf->next, 1))
+            pf->func(i);
+        return NULL;
+    }
+};
+}
+
+void gd_parallel_for(int count, std::function<void(int)> const &func) {
+    ParallelFor pf = { func, count, 0 };
+    std::vector<GThread *> threads;
+    for (int i = 1; i < int(g_get_num_processors()) && i < count; ++i)
+        threads.push_back(g_thread_new("parallelfor", ParallelFor::run, &pf));
+    ParallelFor::run(&pf);
+    for (GThread *thread : threads)
+        g_thread_join(thread);
+}
+
+void gd_prune_cache_dir(std::string const &dirname, unsigned max_files, unsigned max_days) {
+    GDir *dir = g_dir_open(dirname.c_str(), 0, NULL);
+    if (dir == NULL)
+        return;
+    /* the files with their modification times */
+    std::vector<std::pair<gint64, std::string>> files;
+    while (char const *name = g_dir_read_name(dir)) {
+        std::string filename = gd_tostring_free(g_build_path(G_DIR_SEPARATOR_S, dirname.c_str(), name, NULL));
+        GStatBuf st;
+        if (g_stat(filename.c_str(), &st) == 0 && S_ISREG(st.st_mode))
+            files.push_back(std::make_pair(gint64(st.st_mtime), filename));
+    }
+    g_dir_close(dir);
+
+    /* newest first; everything after max_files, or too old, is deleted */
+    std::sort(files.begin(), files.end(), std::greater<std::pair<gint64, std::string>>());
+    gint64 oldest = g_get_real_time() / G_USEC_PER_SEC - gint64(max_days) * 24 * 60 * 60;
+    unsigned deleted = 0;
+    for (unsigned i = 0; i < files.size(); ++i)
+        if (i >= max_files || files[i].first < oldest) {
+            if (g_unlink(files[i].second.c_str()) == 0)
+                deleted++;
+        }
+    if (deleted > 0)
+        gd_debug("%s: %d old files deleted", dirname, deleted);
+}
@@ -27,6 +27,7 @@
 
 #include <string>
 #include <vector>
+#include <functional>
 
 /// find file, looking in user directory and install directory
 /// @return full path of file if found, "" if not
@@ -66,4 +67,17 @@ bool gd_str_equal(const char *a, const char *b);
 
 bool gd_str_ascii_prefix(const std::string &str, const std::string &prefix);
 
+/// @brief Call func(i) for every i in [0, count), using a thread for every processor.
+/// The calling thread also takes part; the function returns when all calls have finished.
+/// The calls can run in any order, so func must be safe to call from different threads at the same time.
+void gd_parallel_for(int count, std::function<void(int)> const &func);
+
+/// @brief Delete the least recently used files of a cache directory.
+/// The files not modified for max_days are deleted, and then the oldest ones, until
+/// at most max_files remain. The users of the cache should touch the files they use.
+/// @param dirname The cache directory; may not exist yet.
+/// @param max_files The number of files to keep at most.
+/// @param max_days The age of the oldest file to keep, in days.
+void gd_prune_cache_dir(std::string const &dirname, unsigned max_files, unsigned max_days);
+
 #endif
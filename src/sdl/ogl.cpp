@@ -24,6 +24,9 @@
 #include <SDL_image.h>
 #include <cmath>
 #include <stdexcept>
+#include <cstring>
+#include <cstdio>
+#include <glib/gstdio.h>
 
 #include "cave/gamerender.hpp"
 #include "sdl/ogl.hpp"
@@ -50,7 +53,15 @@ typedef GLint (APIENTRYP MY_PFNGLGETUNIFORMLOCATIONPROC) (GLuint program, const
 typedef void (APIENTRYP MY_PFNGLUNIFORM1FPROC) (GLint location, GLfloat v0);
 typedef void (APIENTRYP MY_PFNGLUNIFORM2FPROC) (GLint location, GLfloat v0, GLfloat v1);
 typedef void (APIENTRYP MY_PFNGETSHADERINFOLOGPROC) (GLuint shader, GLsizei maxLength, GLsizei *length, GLchar *infoLog);
+typedef void (APIENTRYP MY_PFNGLGETPROGRAMIVPROC) (GLuint program, GLenum pname, GLint *params);
+typedef void (APIENTRYP MY_PFNGLPROGRAMPARAMETERIPROC) (GLuint program, GLenum pname, GLint value);
+typedef void (APIENTRYP MY_PFNGLGETPROGRAMBINARYPROC) (GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, void *binary);
+typedef void (APIENTRYP MY_PFNGLPROGRAMBINARYPROC) (GLuint program, GLenum binaryFormat, const void *binary, GLsizei length);
 #define MY_GL_SHADING_LANGUAGE_VERSION       0x8B8C
+#define MY_GL_LINK_STATUS                    0x8B82
+#define MY_GL_PROGRAM_BINARY_LENGTH          0x8741
+#define MY_GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#define MY_GL_NUM_PROGRAM_BINARY_FORMATS     0x87FE
 
 /* the function pointers as got from opengl. all are prefixed with my_,
  * to avoid collision with global function names (would cause problem on the mac). */
@@ -68,6 +79,12 @@ static MY_PFNGLGETUNIFORMLOCATIONPROC my_glGetUniformLocation = 0;
 static MY_PFNGLUNIFORM1FPROC my_glUniform1f = 0;
 static MY_PFNGLUNIFORM2FPROC my_glUniform2f = 0;
 static MY_PFNGETSHADERINFOLOGPROC my_glGetShaderInfoLog = 0;
+static MY_PFNGLGETPROGRAMIVPROC my_glGetProgramiv = 0;
+static MY_PFNGLPROGRAMPARAMETERIPROC my_glProgramParameteri = 0;
+static MY_PFNGLGETPROGRAMBINARYPROC my_glGetProgramBinary = 0;
+static MY_PFNGLPROGRAMBINARYPROC my_glProgramBinary = 0;
+/* true, if the functions above for the program binaries can really be used */
+static bool my_program_binary_support = false;
 
 
 void SDLOGLScreen::glDeleteProgram_wrapper(GLuint program) {
@@ -172,29 +189,29 @@ static void log_shader_log(GLuint shd) {
 void SDLOGLScreen::end_element(GMarkupParseContext *context, const gchar *element_name, gpointer user_data, GError **error) {
     SDLOGLScreen *dis = static_cast<SDLOGLScreen *>(user_data);
 
-    if (g_str_equal(element_name, "vertex")) {
-        GLuint shd = my_glCreateShader(GL_VERTEX_SHADER);
-        char const *source = dis->shadertext.c_str();
-        my_glShaderSource(shd, 1, &source, 0);
-        my_glCompileShader(shd);
-        log_shader_log(shd);
-        if (glGetError() != 0)
-            throw std::runtime_error("vertex shader cannot be compiled");
-        my_glAttachShader(dis->glprogram.get(), shd);
-        dis->shaders.emplace_back(shd);
-    } else if (g_str_equal(element_name, "fragment")) {
-        GLuint shd = my_glCreateShader(GL_FRAGMENT_SHADER);
-        char const *source = dis->shadertext.c_str();
+    /* only collect the sources here; they are compiled only if there is no cached program binary. */
+    if (g_str_equal(element_name, "vertex"))
+        dis->shadersources.push_back(std::make_pair(GLenum(GL_VERTEX_SHADER), dis->shadertext));
+    else if (g_str_equal(element_name, "fragment"))
+        dis->shadersources.push_back(std::make_pair(GLenum(GL_FRAGMENT_SHADER), dis->shadertext));
+}
+
+
+/**
+ * Compile the shaders collected from the xml, and attach them to the program. */
+void SDLOGLScreen::compile_shaders() {
+    for (auto const &src : shadersources) {
+        GLuint shd = my_glCreateShader(src.first);
+        char const *source = src.second.c_str();
         my_glShaderSource(shd, 1, &source, 0);
         my_glCompileShader(shd);
         /* if we have the getinfo proc, try to retrieve info about compiling */
         log_shader_log(shd);
         if (glGetError() != 0)
-            throw std::runtime_error("fragment shader cannot be compiled");
-        my_glAttachShader(dis->glprogram.get(), shd);
-        dis->shaders.emplace_back(shd);
+            throw std::runtime_error(src.first == GL_VERTEX_SHADER ? "vertex shader cannot be compiled" : "fragment shader cannot be compiled");
+        my_glAttachShader(glprogram.get(), shd);
+        shaders.emplace_back(shd);
     }
-
 }
 
 
@@ -204,6 +221,111 @@ void SDLOGLScreen::text(GMarkupParseContext *context, const gchar *text, gsize t
 }
 
 
+/**
+ * Check if the driver can give and take program binaries. This needs opengl 4.1
+ * or the ARB_get_program_binary extension, and at least one binary format.
+ * The function pointers are not enough: glx returns a pointer for any name,
+ * even for functions which the driver does not have. */
+static bool check_program_binary_support() {
+    if (!my_glGetProgramiv || !my_glGetProgramBinary || !my_glProgramBinary)
+        return false;
+    int major = 0, minor = 0;
+    GLubyte const *version = glGetString(GL_VERSION);
+    if (version)
+        sscanf((char const *) version, "%d.%d", &major, &minor);
+    if (major < 4 || (major == 4 && minor < 1)) {
+        if (!SDL_GL_ExtensionSupported("GL_ARB_get_program_binary"))
+            return false;
+    }
+    GLint formats = 0;
+    glGetIntegerv(MY_GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    glGetError();
+    return formats > 0;
+}
+
+
+/**
+ * The file name of the cached program binary for a shader file.
+ * The name is the hash of the shader file and the strings identifying the opengl driver,
+ * so a new driver or an edited shader file never picks up a stale binary.
+ * @return The file name, or an empty string if the driver cannot give program binaries. */
+static std::string shader_cache_filename(gchar const *programtext, gsize length) {
+    if (!my_program_binary_support)
+        return "";
+    GChecksum *checksum = g_checksum_new(G_CHECKSUM_SHA1);
+    g_checksum_update(checksum, reinterpret_cast<guchar const *>(programtext), length);
+    GLenum const names[] = { GL_VENDOR, GL_RENDERER, GL_VERSION, MY_GL_SHADING_LANGUAGE_VERSION };
+    for (GLenum name : names) {
+        GLubyte const *str = glGetString(name);
+        g_checksum_update(checksum, reinterpret_cast<guchar const *>("\n"), 1);
+        if (str)
+            g_checksum_update(checksum, str, strlen((char const *) str));
+    }
+    std::string key = g_checksum_get_string(checksum);
+    g_checksum_free(checksum);
+    return gd_tostring_free(g_build_path(G_DIR_SEPARATOR_S, g_get_user_cache_dir(), PACKAGE, "shaders", (key + ".bin").c_str(), NULL));
+}
+
+
+/**
+ * Load a program binary saved by save_program_binary().
+ * If the driver refuses the binary, the cache file is deleted.
+ * @return True, if the program is linked and ready to be used. */
+static bool load_program_binary(GLuint program, std::string const &filename) {
+    if (filename == "")
+        return false;
+    gchar *contents = NULL;
+    gsize length;
+    if (!g_file_get_contents(filename.c_str(), &contents, &length, NULL))
+        return false;
+    GLint linked = GL_FALSE;
+    if (length > sizeof(GLenum)) {
+        /* the file starts with the binary format, then comes the binary itself */
+        GLenum format;
+        memcpy(&format, contents, sizeof(format));
+        my_glProgramBinary(program, format, contents + sizeof(format), length - sizeof(format));
+        my_glGetProgramiv(program, MY_GL_LINK_STATUS, &linked);
+    }
+    g_free(contents);
+    if (!linked) {
+        /* the program object is still usable for compiling, but the error flag must be cleared */
+        glGetError();
+        gd_debug("cached shader binary %s is stale", filename);
+        g_unlink(filename.c_str());
+        return false;
+    }
+    gd_debug("loaded cached shader binary %s", filename);
+    return true;
+}
+
+
+/**
+ * Save the binary of a linked program, to be loaded by load_program_binary() next time.
+ * Failing to save is not an error; the shaders will be compiled again. */
+static void save_program_binary(GLuint program, std::string const &filename) {
+    if (filename == "")
+        return;
+    GLint linked = GL_FALSE, length = 0;
+    my_glGetProgramiv(program, MY_GL_LINK_STATUS, &linked);
+    my_glGetProgramiv(program, MY_GL_PROGRAM_BINARY_LENGTH, &length);
+    if (!linked || length <= 0)
+        return;
+    std::vector<char> contents(sizeof(GLenum) + length);
+    GLenum format;
+    GLsizei got = 0;
+    my_glGetProgramBinary(program, length, &got, &format, contents.data() + sizeof(format));
+    if (glGetError() != 0 || got <= 0)
+        return;
+    memcpy(contents.data(), &format, sizeof(format));
+
+    char *dirname = g_path_get_dirname(filename.c_str());
+    g_mkdir_with_parents(dirname, 0700);
+    g_free(dirname);
+    if (!g_file_set_contents(filename.c_str(), contents.data(), sizeof(format) + got, NULL))
+        gd_debug("cannot save shader binary %s", filename);
+}
+
+
 static void log_OpenGL_flags(SDL_Window* window) {
     gd_debug("SDL Window enabled flags:");
     int flags = SDL_GetWindowFlags(window);
@@ -448,6 +570,12 @@ void SDLOGLScreen::configure_size() {
     my_glUniform2f = (MY_PFNGLUNIFORM2FPROC) my_glGetProcAddress("glUniform2f");
     /* this function is not really important, no problem if it is null, so do not test below */
     my_glGetShaderInfoLog = (MY_PFNGETSHADERINFOLOGPROC) my_glGetProcAddress("glGetShaderInfoLog");
+    /* these are needed only for caching the linked program (opengl 4.1 or ARB_get_program_binary) */
+    my_glGetProgramiv = (MY_PFNGLGETPROGRAMIVPROC) my_glGetProcAddress("glGetProgramiv");
+    my_glProgramParameteri = (MY_PFNGLPROGRAMPARAMETERIPROC) my_glGetProcAddress("glProgramParameteri");
+    my_glGetProgramBinary = (MY_PFNGLGETPROGRAMBINARYPROC) my_glGetProcAddress("glGetProgramBinary");
+    my_glProgramBinary = (MY_PFNGLPROGRAMBINARYPROC) my_glGetProcAddress("glProgramBinary");
+    my_program_binary_support = check_program_binary_support();
 
     shader_support = my_glCreateProgram && my_glUseProgram && my_glCreateShader
         && my_glDeleteShader && my_glShaderSource && my_glCompileShader && my_glAttachShader
@@ -474,7 +602,8 @@ void SDLOGLScreen::configure_size() {
                 gd_shader = "";
                 throw std::runtime_error("cannot load shader file");
             }
-            /* parse file */
+            /* parse file. this also sets the texture filter. */
+            shadersources.clear();
             GMarkupParser parser = {
                 start_element,
                 end_element,
@@ -485,14 +614,21 @@ void SDLOGLScreen::configure_size() {
             GMarkupParseContext * parsecontext = g_markup_parse_context_new(&parser, G_MARKUP_TREAT_CDATA_AS_TEXT, this, NULL);
             bool success = g_markup_parse_context_parse(parsecontext, programtext, length, NULL);
             g_markup_parse_context_free(parsecontext);
+            std::string cachefile = shader_cache_filename(programtext, length);
             g_free(programtext);
 
             if (!success)
                 throw std::runtime_error("cannot parse shader file markup");
 
-            my_glLinkProgram(glprogram.get());
-            if (glGetError() != 0) {
-                throw std::runtime_error("shader program cannot be linked");
+            if (!load_program_binary(glprogram.get(), cachefile)) {
+                compile_shaders();
+                if (my_glProgramParameteri && cachefile != "")
+                    my_glProgramParameteri(glprogram.get(), MY_GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+                my_glLinkProgram(glprogram.get());
+                if (glGetError() != 0) {
+                    throw std::runtime_error("shader program cannot be linked");
+                }
+                save_program_binary(glprogram.get(), cachefile);
             }
             my_glUseProgram(glprogram.get());
             if (glGetError() != 0)
@@ -29,6 +29,7 @@
 #include <glib.h>
 #include <string>
 #include <vector>
+#include <utility>
 #include <algorithm>
 #include "sdl/sdlabstractscreen.hpp"
 #include "misc/deleter.hpp"
@@ -88,6 +89,8 @@ private:
 
     /// used when loading the xml
     std::string shadertext;
+    /// shader type and source code of the shaders found in the xml
+    std::vector<std::pair<GLenum, std::string>> shadersources;
     static void start_element(GMarkupParseContext *context, const gchar *element_name, const gchar **attribute_names, const gchar **attribute_values, gpointer user_data, GError **error);
     static void end_element(GMarkupParseContext *context, const gchar *element_name, gpointer user_data, GError **error);
     static void text(GMarkupParseContext *context, const gchar *text, gsize text_len, gpointer user_data, GError **error);
@@ -95,6 +98,7 @@ private:
     void set_uniform_float(char const *name, GLfloat value);
     void set_uniform_2float(char const *name, GLfloat value1, GLfloat value2);
     void set_texture_bilinear(bool bilinear);
+    void compile_shaders();
 
 public:
     SDLOGLScreen(PixbufFactory &pixbuf_factory);
@@ -23,6 +23,10 @@
 
 #include <cmath>
 #include <memory>
+#include <algorithm>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include "sdl/sdlabstractscreen.hpp"
 
@@ -66,6 +70,26 @@ void SDLAbstractScreen::blit(Pixmap const &src, int dx, int dy) const {
 }
 
 
+std::unique_ptr<Pixmap> SDLAbstractScreen::create_layer(int w, int h) const {
+    /* same format as the screen, so blitting it is a plain copy. no alpha, as the layer is opaque. */
+    SDL_PixelFormat *format = surface->format;
+    SDL_Surface *layer = SDL_CreateRGBSurface(0, w, h, format->BitsPerPixel, format->Rmask, format->Gmask, format->Bmask, 0);
+    if (layer == NULL)
+        return nullptr;
+    return std::make_unique<SDLPixmap>(layer);
+}
+
+
+void SDLAbstractScreen::blit_to_layer(Pixmap const &src, Pixmap &layer, int dx, int dy) const {
+    SDL_Surface *from = static_cast<SDLPixmap const &>(src).surface.get();
+    SDL_Surface *to = static_cast<SDLPixmap &>(layer).surface.get();
+    SDL_Rect dstr;
+    dstr.x = dx;
+    dstr.y = dy;
+    SDL_BlitSurface(from, NULL, to, &dstr);
+}
+
+
 void SDLAbstractScreen::set_clip_rect(int x1, int y1, int w, int h) {
     /* on-screen clipping rectangle */
     SDL_Rect cliprect;
@@ -245,19 +269,113 @@ static void filledDiamondColor(SDL_Surface *dst, Sint16 xc, Sint16 yc, Sint16 r,
 }
 
 
-void SDLAbstractScreen::draw_particle_set(int dx, int dy, ParticleSet const &ps) {
-    unsigned char r, g, b;
-    ps.color.get_rgb(r, g, b);
-    Uint8 a = ps.life / 1000.0 * ps.opacity * 255;
-    Uint32 color = r << 24 | g << 16 | b << 8 | a << 0;
-    int size = ceil(ps.size);
+/** Draw a horizontal line on a 32-bit surface, which has 8-bit color channels.
+ * It does the same as hlineColor(), but the color and the alpha are already
+ * shifted in place: alpha has cA in the bytes of the r, g, b channels, and 0
+ * in the byte which must be retained. The line must be already clipped. */
+static void hline32(Uint32 *row, Sint16 x1, Sint16 x2, Uint32 color, Uint32 alpha) {
+    Sint32 x = x1;
+#ifdef __SSE2__
+    /* four pixels at a time. the blending is done with 16-bit lanes; as (c-p)*a
+     * does not fit in 16 bits, the product >> 8 is assembled from the high and
+     * the low half of the product. */
+    __m128i const zero = _mm_setzero_si128();
+    __m128i const c16 = _mm_unpacklo_epi8(_mm_set1_epi32(color), zero);
+    __m128i const a16 = _mm_unpacklo_epi8(_mm_set1_epi32(alpha), zero);
+    for (; x + 3 <= x2; x += 4) {
+        __m128i p = _mm_loadu_si128(reinterpret_cast<__m128i const *>(row + x));
+        __m128i lo = _mm_unpacklo_epi8(p, zero);
+        __m128i hi = _mm_unpackhi_epi8(p, zero);
+        __m128i dlo = _mm_sub_epi16(c16, lo);
+        __m128i dhi = _mm_sub_epi16(c16, hi);
+        lo = _mm_add_epi16(lo, _mm_or_si128(_mm_slli_epi16(_mm_mulhi_epi16(dlo, a16), 8), _mm_srli_epi16(_mm_mullo_epi16(dlo, a16), 8)));
+        hi = _mm_add_epi16(hi, _mm_or_si128(_mm_slli_epi16(_mm_mulhi_epi16(dhi, a16), 8), _mm_srli_epi16(_mm_mullo_epi16(dhi, a16), 8)));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(row + x), _mm_packus_epi16(lo, hi));
+    }
+#endif
+    for (; x <= x2; x++) {
+        Uint32 pixel = row[x];
+        Uint32 result = 0;
+        for (int shift = 0; shift < 32; shift += 8) {
+            Sint32 p = (pixel >> shift) & 0xFF;
+            Sint32 c = (color >> shift) & 0xFF;
+            Sint32 a = (alpha >> shift) & 0xFF;
+            result |= Uint32(p + ((c - p) * a >> 8)) << shift;
+        }
+        row[x] = result;
+    }
+}
+
+
+void SDLAbstractScreen::draw_particles(int dx, int dy, double factor, ParticlePool const &particles) {
+    if (particles.empty())
+        return;
     if (SDL_MUSTLOCK(surface.get()))
         if (SDL_LockSurface(surface.get()) < 0)
             return;
+
     bool software_pal_emulation = get_pal_emulation();
-    for (ParticleSet::const_iterator it = ps.begin(); it != ps.end(); ++it) {
-        filledDiamondColor(surface.get(), dx + it->px, dy + it->py, size, color, software_pal_emulation);
+    SDL_PixelFormat *format = surface->format;
+    bool fast = format->BytesPerPixel == 4
+                && format->Rloss == 0 && format->Gloss == 0 && format->Bloss == 0
+                && format->Rshift % 8 == 0 && format->Gshift % 8 == 0 && format->Bshift % 8 == 0;
+    SDL_Rect const &clip = surface->clip_rect;
+    Sint16 left = clip.x, right = clip.x + clip.w - 1;
+    Sint16 top = clip.y, bottom = clip.y + clip.h - 1;
+
+    /* the color, the alpha and the size are only recalculated if they differ
+     * from the previous particle's. particles added together are next to each other. */
+    GdColor last_color;
+    int last_life = -1;
+    float last_opacity = -1, last_size = -1;
+    Uint32 color = 0, pixel_color = 0, alpha[2] = {0, 0};
+    Sint16 r16 = 0;
+
+    for (size_t i = 0; i < particles.num_particles(); ++i) {
+        if (particles.life[i] != last_life || particles.opacity[i] != last_opacity
+                || particles.size[i] != last_size || particles.color[i] != last_color) {
+            last_life = particles.life[i];
+            last_opacity = particles.opacity[i];
+            last_size = particles.size[i];
+            last_color = particles.color[i];
+            unsigned char r, g, b;
+            last_color.get_rgb(r, g, b);
+            Uint8 a = last_life / 1000.0 * last_opacity * 255;
+            color = r << 24 | g << 16 | b << 8 | a << 0;
+            r16 = ceil(last_size * factor);
+            /* the color and the alpha for even and odd rows (pal emulation shades odd rows), in pixel format */
+            if (fast) {
+                pixel_color = Uint32(r) << format->Rshift | Uint32(g) << format->Gshift | Uint32(b) << format->Bshift;
+                Uint8 a_odd = software_pal_emulation ? a * gd_pal_emu_scanline_shade / 100 : a;
+                alpha[0] = Uint32(a) << format->Rshift | Uint32(a) << format->Gshift | Uint32(a) << format->Bshift;
+                alpha[1] = Uint32(a_odd) << format->Rshift | Uint32(a_odd) << format->Gshift | Uint32(a_odd) << format->Bshift;
+            }
+        }
+
+        Sint16 xc = dx + particles.px[i] * factor;
+        Sint16 yc = dy + particles.py[i] * factor;
+        if (!fast) {
+            filledDiamondColor(surface.get(), xc, yc, r16, color, software_pal_emulation);
+            continue;
+        }
+        if (clip.w == 0 || clip.h == 0 || r16 < 0)
+            continue;
+        if (xc + r16 < left || xc - r16 > right || yc + r16 < top || yc - r16 > bottom)
+            continue;
+        /* the rows of the diamond, each clipped */
+        for (Sint16 y = yc - r16; y <= yc + r16; ++y) {
+            if (y < top || y > bottom)
+                continue;
+            Sint16 w = r16 - (y < yc ? yc - y : y - yc);
+            Sint16 x1 = std::max<Sint16>(xc - w, left);
+            Sint16 x2 = std::min<Sint16>(xc + w, right);
+            if (x1 > x2)
+                continue;
+            Uint32 *row = reinterpret_cast<Uint32 *>(static_cast<Uint8 *>(surface->pixels) + y * surface->pitch);
+            hline32(row, x1, x2, pixel_color, alpha[y % 2 == 1]);
+        }
     }
+
     if (SDL_MUSTLOCK(surface.get()))
         SDL_UnlockSurface(surface.get());
 }
@@ -32,7 +32,7 @@
 #include "gfx/screen.hpp"
 #include "misc/deleter.hpp"
 
-class ParticleSet;
+class ParticlePool;
 class GdColor;
 class PixbufFactory;
 
@@ -59,9 +59,11 @@ public:
     SDLAbstractScreen(PixbufFactory &pixbuf_factory): Screen(pixbuf_factory) {}
     virtual void fill_rect(int x, int y, int w, int h, const GdColor &c) override;
     virtual void blit(Pixmap const &src, int dx, int dy) const override;
+    virtual std::unique_ptr<Pixmap> create_layer(int w, int h) const override;
+    virtual void blit_to_layer(Pixmap const &src, Pixmap &layer, int dx, int dy) const override;
     virtual void set_clip_rect(int x1, int y1, int w, int h) override;
     virtual void remove_clip_rect() override;
-    virtual void draw_particle_set(int dx, int dy, ParticleSet const &ps) override;
+    virtual void draw_particles(int dx, int dy, double factor, ParticlePool const &particles) override;
 };
 
 #endif
@@ -23,7 +23,7 @@
 
 #include "config.h"
 
-#include <numeric>
+#include <algorithm>
 
 #include "settings.hpp"
 #include "cave/gamecontrol.hpp"
@@ -78,6 +78,16 @@ static double calculate_scaling_factor_for_monitor() {
     return r;
 }
 
+// The refresh period of the display in milliseconds, or 0 if it is not known.
+// NOTE: needs to be called after SDL_Init()
+static double display_refresh_period_ms() {
+    SDL_DisplayMode dm;
+    if (SDL_GetCurrentDisplayMode(0, &dm) < 0 || dm.refresh_rate <= 0)
+        return 0;
+    gd_debug("SDL display refresh rate: %d Hz", dm.refresh_rate);
+    return 1000.0 / dm.refresh_rate;
+}
+
 SDLApp::SDLApp(Screen &screenref)
     : App(screenref) {
     if (gd_auto_scale)
@@ -98,6 +108,42 @@ static Uint32 timer_callback(Uint32 interval, void *param) {
 }
 
 
+/* Measures the time elapsed between frames with the high resolution counter.
+ * The milliseconds are given to the app as integers, but the fractions are
+ * carried over to the next frame, so the game follows the real time exactly,
+ * whatever the refresh rate of the display is. The game renderer accumulates
+ * these and runs the cave in fixed steps. If the machine is late (for
+ * example the window was dragged), the game catches up by doing more game
+ * steps for one drawing, but at most max_catch_up_ms at once. */
+class FrameClock {
+public:
+    FrameClock() : frequency(SDL_GetPerformanceFrequency()), last(SDL_GetPerformanceCounter()), remainder(0), frame_ms(0) {}
+
+    /* Milliseconds elapsed since the previous call. */
+    int elapsed_ms() {
+        Uint64 now = SDL_GetPerformanceCounter();
+        frame_ms = double(now - last) * 1000.0 / frequency;
+        last = now;
+        double ms = frame_ms + remainder;
+        if (ms > max_catch_up_ms)
+            ms = max_catch_up_ms;
+        int whole = int(ms);
+        remainder = ms - whole;
+        return whole;
+    }
+
+    /* The real length of the previous frame, in milliseconds. */
+    double last_frame_ms() const {
+        return frame_ms;
+    }
+
+private:
+    static constexpr double max_catch_up_ms = 200;
+    Uint64 frequency, last;
+    double remainder, frame_ms;
+};
+
+
 static Activity::KeyCode activity_keycode_from_sdl_key_event(SDL_KeyboardEvent const &ev) {
     switch (ev.keysym.sym) {
         case SDLK_UP:
@@ -162,27 +208,32 @@ private:
 
 
 static void run_the_app(SDLApp &the_app, NextAction &na, bool opengl) {
-    /* for the sdltimer based timing */
+    /* for the sdltimer based timing; the timer only wakes up the loop,
+     * the elapsed time is always measured by the clock. */
     int const timer_ms = gd_fine_scroll ? 20 : 40;
     SDL_TimerID timer_id = 0;
+    FrameClock clock;
     /* for the screen based timing */
-    Uint32 ticks_now = SDL_GetTicks(), ticks_last = SDL_GetTicks();
     enum { average_time_frame = 25 };
-    Uint32 moved[average_time_frame];
+    double moved[average_time_frame];
     unsigned move_index = 0;
 
     if (!SDL_WasInit(SDL_INIT_TIMER))
         SDL_Init(SDL_INIT_TIMER);
 
     calculate_scaling_factor_for_monitor();
+    /* flips returning in less than half of the refresh period do not wait for the
+     * vertical retrace. if the refresh rate is not known, allow displays up to 500 Hz. */
+    double const refresh_ms = display_refresh_period_ms();
+    double const min_flip_ms = (refresh_ms > 0 ? refresh_ms : 2.0) / 2;
 
     /* if screen reports we can use it for timing, measure the number of
      * milliseconds each refresh takes */
     bool use_screen_timing = the_app.screen->has_timed_flips();
     if (use_screen_timing)
         gd_debug("starting screen based timing");
-    /* by default, assume 20 ms / frame for frame rate measuring */
-    std::fill(moved, moved + average_time_frame, 20);
+    /* by default, assume the refresh period of the display (or 20 ms) for frame rate measuring */
+    std::fill(moved, moved + average_time_frame, refresh_ms > 0 ? refresh_ms : 20.0);
 
     if (!use_screen_timing) {
         timer_id = SDL_AddTimer(timer_ms, timer_callback, NULL);
@@ -230,21 +281,24 @@ static void run_the_app(SDLApp &the_app, NextAction &na, bool opengl) {
                 case SDL_USEREVENT:
                     had_timer_event1 = true;
                     break;
-                case SDL_USEREVENT+1:
-                    the_app.timer2_event();
-                    break;
             } // switch ev.type
         } // while pollevent
 
         if (use_screen_timing) {
-            int average_ms = std::accumulate(moved, moved + average_time_frame, 0) / average_time_frame;
-            if (average_ms < 7) {
+            /* if the flips return much faster than the display refreshes, they do not wait
+             * for the vertical retrace; switch to the timer, so we do not eat cpu.
+             * the median is used, so some missed or late frames do not count. */
+            double sorted[average_time_frame];
+            std::copy(moved, moved + average_time_frame, sorted);
+            std::nth_element(sorted, sorted + average_time_frame / 2, sorted + average_time_frame);
+            double median_ms = sorted[average_time_frame / 2];
+            if (median_ms < min_flip_ms) {
                 use_screen_timing = false;
-                gd_debug("screen timing too fast, switching to built-in timer");
+                gd_debug("screen timing too fast (%4.2f ms, expected at least %4.2f ms), switching to built-in timer", median_ms, min_flip_ms);
                 timer_id = SDL_AddTimer(timer_ms, timer_callback, NULL);
             }
-            /* feed the timer with the average value. */
-            the_app.timer_event(average_ms);
+            /* feed the timer with the measured time. */
+            the_app.timer_event(clock.elapsed_ms());
             if (the_app.redraw_queued()) {
                 the_app.redraw_event(the_app.screen->must_redraw_all_before_flip());
             }
@@ -258,19 +312,18 @@ static void run_the_app(SDLApp &the_app, NextAction &na, bool opengl) {
             the_app.blittext_n(0, the_app.screen->get_height()-20, s.c_str());
             */
 
-            /* calculate average milliseconds / refresh. if seems to be too fast, switch to timer based stuff */
-            ticks_now = SDL_GetTicks();
-            Uint32 ms = ticks_now - ticks_last;
+            /* remember the milliseconds / refresh. if seems to be too fast, switch to timer based stuff */
+            double ms = clock.last_frame_ms();
             if (ms <= 60) {
                 moved[move_index] = ms;
                 move_index = (move_index + 1) % average_time_frame;
             }
             /* always flip, because we need the time it waits! */
             the_app.screen->do_the_flip();
-            ticks_last = ticks_now;
         } else {
+            /* timer events might be late or merged, so do not count them, but measure the time. */
             if (had_timer_event1)
-                the_app.timer_event(timer_ms);
+                the_app.timer_event(clock.elapsed_ms());
             if (the_app.redraw_queued()) {
                 the_app.redraw_event(the_app.screen->must_redraw_all_before_flip());
             }
@@ -140,12 +140,16 @@ bool gd_pal_emulation_game = false;
 double gd_cell_scale_factor_editor = 1.0;
 int gd_cell_scale_type_editor = GD_SCALING_NEAREST;
 bool gd_pal_emulation_editor = false;
+int gd_cell_cache_megabytes = 32;
 
 /* html output option */
 /* CURRENTLY ONLY FROM THE COMMAND LINE */
 char *gd_html_stylesheet_filename = NULL;
 char *gd_html_favicon_filename = NULL;
 
+/* compression level of the exported png images */
+int gd_png_compression = 9;
+
 /* GTK keyboard settings */
 #ifdef HAVE_GTK    /* only if having gtk */
 int gd_gtk_key_left = GDK_KEY_Left;
@@ -236,6 +240,7 @@ Setting *gd_get_game_settings_array() {
         { TypeBoolean, N_("Show story"), &gd_show_story, false, NULL, N_("If the cave has a story, it will be shown when the cave is first started.") },
         { TypeBoolean, N_("Game name at uncover"), &gd_show_name_of_game, false, NULL, N_("Show the name of the game when uncovering a cave.") },
         { TypeBoolean, N_("No invisible outbox"), &gd_no_invisible_outbox, false, NULL, N_("Show invisible outboxes as visible (blinking) ones.") },
+        { TypeInteger, N_("PNG compression"), &gd_png_compression, false, NULL, N_("Compression level of the exported PNG images, from 0 (fastest) to 9 (smallest files)."), 0, 9 },
 
         { TypePage, N_("Theme and colors") },
         { TypeTheme,   N_("Theme"), NULL, false, NULL, N_("Graphics theme used inside the game."), 0, 0, NULL },
@@ -258,6 +263,7 @@ Setting *gd_get_game_settings_array() {
         { TypePercent, N_("  PAL scanline shade"), &gd_pal_emu_scanline_shade, true, NULL, N_("Darker rows for PAL emulation. Only effective for the GTK+ and the SDL engines.") },
         { TypeBoolean, N_("Fine scrolling"), &gd_fine_scroll, true, NULL, N_("If fine scrolling is turned off, scrolling and cave animation is limited to a lower frame rate, and consumes much less CPU. On some hardware, it might actually look better than fine scrolling. Not all graphics engines support fine scrolling.") },
         { TypeBoolean, N_("Particle effects"), &gd_particle_effects, true, NULL, N_("Particle effects during play. This requires a lot of CPU power.") },
+        { TypeInteger, N_("Cell cache size (MiB)"), &gd_cell_cache_megabytes, false, NULL, N_("Memory used to keep the graphics of the caves recently played, so returning to a cave with the same colors is faster. Zero disables the cache."), 0, 1024 },
         { TypeBoolean, N_("Overlay screen status info"), &gd_show_fps, false, NULL, N_("Displays the time between drawing two frames in milliseconds, frames per second and scroll rate. This can be helpful to check the performance of the game on the system in use.") },
 
 #ifdef HAVE_SDL
@@ -509,6 +515,8 @@ void gd_settings_init() {
     settings_integers["cell_scale_type_game"] = &gd_cell_scale_type_game;
     settings_doubles["cell_scale_factor_editor"] = &gd_cell_scale_factor_editor;
     settings_integers["cell_scale_type_editor"] = &gd_cell_scale_type_editor;
+    settings_integers["cell_cache_megabytes"] = &gd_cell_cache_megabytes;
+    settings_integers["png_compression"] = &gd_png_compression;
 
 #ifdef HAVE_GTK
     settings_integers["gtk_key_left"] = &gd_gtk_key_left;
@@ -83,6 +83,7 @@ extern bool gd_pal_emulation_game;
 extern double gd_cell_scale_factor_editor;
 extern int gd_cell_scale_type_editor;
 extern bool gd_pal_emulation_editor;
+extern int gd_cell_cache_megabytes;
 
 /* keyboard */
 #ifdef HAVE_GTK
@@ -102,6 +103,9 @@ extern int gd_gtk_key_restart_level;
 extern char *gd_html_stylesheet_filename;
 extern char *gd_html_favicon_filename;
 
+/* image export option */
+extern int gd_png_compression;
+
 
 
 /* SDL settings */
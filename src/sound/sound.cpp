@@ -29,6 +29,7 @@
 
 #include <glib.h>
 #include <cmath>
+#include <algorithm>
 #include "settings.hpp"
 #include "cave/helper/cavesound.hpp"
 #include "cave/caverendered.hpp"
@@ -71,6 +72,22 @@ static GdSound snd_playing[5];
 static Mix_Music *music = NULL;
 
 static int music_volume = MIX_MAX_VOLUME;
+
+/* the state of a channel of the offline mixer. the volume, the panning and
+ * the fading are applied the same way as sdl_mixer does. */
+struct OfflineChannel {
+    Mix_Chunk *chunk;       ///< NULL, if the channel is silent
+    unsigned pos;           ///< position in the chunk, in sample frames
+    bool looped;
+    int volume;             ///< 0..MIX_MAX_VOLUME
+    int left, right;        ///< panning, 0..255
+    int distance;           ///< 0..255
+    unsigned fade_length;   ///< length of the fade out in sample frames, 0 if not fading
+    unsigned fade_left;     ///< sample frames left from fading out
+};
+static bool offline = false;
+static int offline_frequency;
+static OfflineChannel offline_channels[G_N_ELEMENTS(snd_playing)];
 #endif
 
 #ifdef HAVE_SDL
@@ -144,6 +161,15 @@ static void channel_done(int channel) {
 
 #ifdef HAVE_SDL
 static void halt_channel(int channel) {
+    if (offline) {
+        OfflineChannel &ch = offline_channels[channel];
+        /* like sdl_mixer, do not restart a fade which is already in progress */
+        if (ch.chunk != NULL && ch.fade_length == 0) {
+            ch.fade_length = 40 * offline_frequency / 1000;
+            ch.fade_left = ch.fade_length;
+        }
+        return;
+    }
     Mix_FadeOutChannel(channel, 40);
 }
 #endif
@@ -153,6 +179,12 @@ static void set_channel_panning(int channel, int dx, int dy) {
     if (gd_sound_stereo) {
         int left = gd_clamp(128 - dx * 2, 0, 255);
         int distance = gd_clamp(sqrt(dx * dx + dy * dy) * 2, 0, 255);
+        if (offline) {
+            offline_channels[channel].left = left;
+            offline_channels[channel].right = 255 - left;
+            offline_channels[channel].distance = distance;
+            return;
+        }
         Mix_SetPanning(channel, left, 255 - left);
         Mix_SetDistance(channel, distance);
     }
@@ -190,8 +222,18 @@ static void play_sound(int channel, SoundWithPos sound) {
     g_assert(!gd_sound_is_fake(sound.sound));
 
     /* now play it. */
-    Mix_PlayChannel(channel, sounds[sound.sound], gd_sound_is_looped(sound.sound) ? -1 : 0);
-    Mix_Volume(channel, MIX_MAX_VOLUME * gd_sound_chunks_volume_percent / 100);
+    if (offline) {
+        OfflineChannel &ch = offline_channels[channel];
+        ch.chunk = sounds[sound.sound];
+        ch.pos = 0;
+        ch.looped = gd_sound_is_looped(sound.sound);
+        ch.volume = MIX_MAX_VOLUME * gd_sound_chunks_volume_percent / 100;
+        ch.fade_length = 0;
+        /* sdl_mixer keeps the panning effects of the channel, too */
+    } else {
+        Mix_PlayChannel(channel, sounds[sound.sound], gd_sound_is_looped(sound.sound) ? -1 : 0);
+        Mix_Volume(channel, MIX_MAX_VOLUME * gd_sound_chunks_volume_percent / 100);
+    }
     set_channel_panning(channel, sound.dx, sound.dy);
     snd_playing[channel] = sound.sound;
 }
@@ -239,6 +281,7 @@ void gd_sound_close() {
         return;
 
     gd_sound_off();
+    gd_sound_set_offline(false);
     Mix_CloseAudio();
     for (unsigned i = 0; i < GD_S_MAX; i++)
         if (sounds[i] != 0) {
@@ -261,6 +304,82 @@ void gd_sound_off() {
 #endif
 }
 
+gboolean gd_sound_set_offline(bool enable) {
+#ifdef HAVE_SDL
+    if (!enable) {
+        offline = false;
+        return TRUE;
+    }
+    if (!mixer_started)
+        return FALSE;
+
+    /* the offline mixer only knows the format of the loaded chunks, if it is 16-bit stereo */
+    int frequency, channels;
+    Uint16 format;
+    Mix_QuerySpec(&frequency, &format, &channels);
+    if (format != AUDIO_S16SYS || channels != 2)
+        return FALSE;
+
+    /* stop the sounds of sdl_mixer; from now on, every sound goes to the offline channels. */
+    Mix_HaltChannel(-1);
+    for (unsigned i = 0; i < G_N_ELEMENTS(offline_channels); i++) {
+        OfflineChannel &ch = offline_channels[i];
+        ch.chunk = NULL;
+        ch.left = ch.right = 255;
+        ch.distance = 0;
+        ch.fade_length = 0;
+        snd_playing[i] = GD_S_NONE;
+    }
+    offline_frequency = frequency;
+    offline = true;
+    return TRUE;
+#else
+    return FALSE;
+#endif
+}
+
+
+void gd_sound_mix_offline(gint16 *stream, unsigned frames) {
+    std::fill(stream, stream + frames * 2, 0);
+#ifdef HAVE_SDL
+    if (!offline)
+        return;
+
+    for (unsigned c = 0; c < G_N_ELEMENTS(offline_channels); c++) {
+        OfflineChannel &ch = offline_channels[c];
+        if (ch.chunk == NULL)
+            continue;
+
+        Sint16 const *data = reinterpret_cast<Sint16 const *>(ch.chunk->abuf);
+        unsigned const length = ch.chunk->alen / 4;
+        /* panning and distance as the effects of sdl_mixer, then the volume of the channel and of the chunk. */
+        double const attenuation = (255 - ch.distance) / 255.0;
+        double const left = ch.left / 255.0 * attenuation, right = ch.right / 255.0 * attenuation;
+        int const volume = ch.volume * ch.chunk->volume / MIX_MAX_VOLUME;
+        for (unsigned i = 0; i < frames; i++) {
+            if (ch.pos >= length && ch.looped && length > 0)
+                ch.pos = 0;
+            if (ch.pos >= length || (ch.fade_length != 0 && ch.fade_left == 0)) {
+                ch.chunk = NULL;
+                channel_done(c);
+                break;
+            }
+            int v = volume;
+            if (ch.fade_length != 0) {
+                v = v * int(ch.fade_left) / int(ch.fade_length);
+                ch.fade_left--;
+            }
+            int l = stream[i * 2] + int(Sint16(data[ch.pos * 2] * left)) * v / MIX_MAX_VOLUME;
+            int r = stream[i * 2 + 1] + int(Sint16(data[ch.pos * 2 + 1] * right)) * v / MIX_MAX_VOLUME;
+            stream[i * 2] = gd_clamp(l, -32768, 32767);
+            stream[i * 2 + 1] = gd_clamp(r, -32768, 32767);
+            ch.pos++;
+        }
+    }
+#endif
+}
+
+
 void gd_sound_play_bonus_life() {
 #ifdef HAVE_SDL
     if (!mixer_started || !gd_sound_enabled)
@@ -34,6 +34,16 @@ void gd_sound_off();
 void gd_sound_play_sounds(SoundWithPos const &sound1, SoundWithPos const &sound2, SoundWithPos const &sound3);
 void gd_sound_play_bonus_life();
 
+/// Switch to the offline mixer, or back to sdl_mixer. In offline mode, no sound
+/// is sent to the audio device; the sounds are mixed by gd_sound_mix_offline(),
+/// whenever the caller needs the next piece. The mixer must have been opened in
+/// 16-bit stereo. @return TRUE, if the offline mixer could be enabled.
+gboolean gd_sound_set_offline(bool enable);
+/// Mix the next frames of the sounds playing, in offline mode.
+/// @param stream The 16-bit stereo samples, which are overwritten.
+/// @param frames The number of sample frames (left-right pairs).
+void gd_sound_mix_offline(gint16 *stream, unsigned frames);
+
 void gd_music_play_random();
 void gd_music_stop();
 